@@ -0,0 +1,390 @@
+//*****************************************************************************
+/*!
+  \file changetracker.cpp
+  \brief This file contains the implementation of the ChangeTracker class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "changetracker.h"
+#include "locationlog.h"
+#include <qtimer.h>
+
+
+//*****************************************************************************
+/*!
+  Create a tracker with no changes, with \a pcParent as the parent object.
+*/
+//*****************************************************************************
+
+ChangeTracker::ChangeTracker(QObject* pcParent)
+  : QObject(pcParent),
+    m_isPendingOther(false),
+    m_isBatchOther(false),
+    m_nGeneration(0),
+    m_nEquipmentGeneration(0),
+    m_isUnsavedChange(false),
+    m_isHistoryClean(true),
+    m_isApplyingEdit(false),
+    m_isFlushPending(false),
+    m_isReportedModified(false)
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the tracker.
+*/
+//*****************************************************************************
+
+ChangeTracker::~ChangeTracker()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  The dive log \a pcLog has been changed, or added to the log book.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::logChanged(DiveLog* pcLog)
+{
+  m_cDirtyLogs.insert(pcLog);
+  m_cPendingLogs.insert(pcLog);
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  The dive log \a pcLog is about to be removed from the log book.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::logRemoved(DiveLog* pcLog)
+{
+  m_cDirtyLogs.remove(pcLog);
+  m_cPendingLogs.remove(pcLog);
+  m_cBatchLogs.remove(pcLog);
+  m_isPendingOther = true;
+  touch();
+  emit removingLog(pcLog);
+}
+
+
+//*****************************************************************************
+/*!
+  The dive logs are about to be reordered in the list. Must be followed by
+  a call to logsReordered().
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::logsAboutToBeReordered()
+{
+  emit reorderingLogs();
+}
+
+
+//*****************************************************************************
+/*!
+  The dive logs have been reordered in the list, so logs that didn't
+  change may have moved.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::logsReordered()
+{
+  m_isPendingOther = true;
+  touch();
+  emit reorderedLogs();
+}
+
+
+//*****************************************************************************
+/*!
+  The location \a pcLocation has been added to the log book.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::locationAdded(LocationLog* pcLocation)
+{
+  if ( false == pcLocation->getName().isEmpty() )
+    m_cPendingLocationNames.insert(pcLocation->getName());
+  locationChanged(pcLocation);
+}
+
+
+//*****************************************************************************
+/*!
+  The location \a pcLocation has been changed, other than by a new name.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::locationChanged(LocationLog* pcLocation)
+{
+  m_cDirtyLocations.insert(pcLocation);
+  m_isPendingOther = true;
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  The location \a pcLocation has been renamed from \a cOldName.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::locationRenamed(LocationLog* pcLocation,
+                               const QString& cOldName)
+{
+  if ( false == cOldName.isEmpty() )
+    m_cPendingLocationNames.insert(cOldName);
+  if ( false == pcLocation->getName().isEmpty() )
+    m_cPendingLocationNames.insert(pcLocation->getName());
+  locationChanged(pcLocation);
+}
+
+
+//*****************************************************************************
+/*!
+  The location \a pcLocation is about to be removed from the log book.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::locationRemoved(LocationLog* pcLocation)
+{
+  if ( false == pcLocation->getName().isEmpty() )
+    m_cPendingLocationNames.insert(pcLocation->getName());
+  m_cDirtyLocations.remove(pcLocation);
+  m_isPendingOther = true;
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  The equipment \a pcEquipment has been changed, or added to the log book.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::equipmentChanged(EquipmentLog* pcEquipment)
+{
+  m_cDirtyEquipment.insert(pcEquipment);
+  m_isPendingOther = true;
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  An entry of the history of the equipment \a pcEquipment has been added,
+  removed or given a new date.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::equipmentHistoryChanged(EquipmentLog* pcEquipment)
+{
+  ++m_nEquipmentGeneration;
+  equipmentChanged(pcEquipment);
+}
+
+
+//*****************************************************************************
+/*!
+  The equipment \a pcEquipment is about to be removed from the log book.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::equipmentRemoved(EquipmentLog* pcEquipment)
+{
+  m_cDirtyEquipment.remove(pcEquipment);
+  ++m_nEquipmentGeneration;
+  m_isPendingOther = true;
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  The personal information in the log book has been changed.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::personalInfoChanged()
+{
+  m_isPendingOther = true;
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  An edit from the edit history is about to be applied. The changes made
+  until editApplied() can be undone, so they don't by themselves make the
+  log book modified.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::editAboutToBeApplied()
+{
+  m_isApplyingEdit = true;
+}
+
+
+//*****************************************************************************
+/*!
+  The edit announced by editAboutToBeApplied() has been applied.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::editApplied()
+{
+  m_isApplyingEdit = false;
+}
+
+
+//*****************************************************************************
+/*!
+  The edit history has reached, if \a isClean is `true', or left the state
+  it had when the log book was last saved.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::historyCleanChanged(bool isClean)
+{
+  m_isHistoryClean = isClean;
+  reportModified();
+}
+
+
+//*****************************************************************************
+/*!
+  The log book has been saved. The dirty sets are cleared.
+  Changes not yet sent by changed() will still be sent.
+
+  The edit history must be marked clean too, or the log book will still
+  be modified.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::markSaved()
+{
+  m_cDirtyLogs.clear();
+  m_cDirtyLocations.clear();
+  m_cDirtyEquipment.clear();
+  m_isUnsavedChange = false;
+  reportModified();
+}
+
+
+//*****************************************************************************
+/*!
+  Forget all changes, including those not yet sent by changed().
+  This is used after a log book has been loaded.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::reset()
+{
+  m_cPendingLogs.clear();
+  m_isPendingOther = false;
+  m_cPendingLocationNames.clear();
+  markSaved();
+}
+
+
+//*****************************************************************************
+/*!
+  Start a new generation, and schedule flush() if it isn't already.
+  Unless an edit from the edit history is being applied, the log book
+  is now modified.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::touch()
+{
+  ++m_nGeneration;
+  if ( false == m_isApplyingEdit )
+    m_isUnsavedChange = true;
+  if ( false == m_isFlushPending ) {
+    m_isFlushPending = true;
+    QTimer::singleShot(0, this, SLOT(flush()));
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Send the changes made since the last batch with changed(), and report
+  if isModified() has changed.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::flush()
+{
+  m_isFlushPending = false;
+  reportModified();
+
+  if ( m_cPendingLogs.isEmpty() && false == m_isPendingOther )
+    return;
+
+  m_cBatchLogs.swap(m_cPendingLogs);
+  m_cBatchLocationNames.swap(m_cPendingLocationNames);
+  m_isBatchOther = m_isPendingOther;
+  m_isPendingOther = false;
+  emit changed();
+  m_cBatchLogs.clear();
+  m_cBatchLocationNames.clear();
+  m_isBatchOther = false;
+}
+
+
+//*****************************************************************************
+/*!
+  Emit modifiedChanged() if isModified() has changed since last reported.
+*/
+//*****************************************************************************
+
+void
+ChangeTracker::reportModified()
+{
+  if ( isModified() != m_isReportedModified ) {
+    m_isReportedModified = isModified();
+    emit modifiedChanged(m_isReportedModified);
+  }
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,189 @@
+//*****************************************************************************
+/*!
+  \file changetracker.h
+  \brief This file contains the definition of the ChangeTracker class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef CHANGETRACKER_H
+#define CHANGETRACKER_H
+
+#include <qobject.h>
+#include <qset.h>
+#include <qstring.h>
+
+class DiveLog;
+class LocationLog;
+class EquipmentLog;
+
+
+//*****************************************************************************
+/*!
+  \class ChangeTracker
+  \brief The ChangeTracker class records what has changed in a log book.
+
+  Each log book has one tracker. The dive logs report their own changes
+  through the dive list; the views report changes to locations, equipment
+  and the personal information, since those are only edited there.
+
+  Two things are kept. The dirty sets hold the records changed since the
+  log book was last saved. The generation is a counter that is increased
+  on every change, so a cache can remember the generation it was built at
+  and later see if it is stale without being told. The equipment
+  generation is only increased when the dates in the equipment history
+  change, for the caches that depend on nothing else.
+
+  isModified() doesn't use either, as undoing back to the saved state
+  should make the log book unmodified again. Edits applied from the edit
+  history are bracketed by editAboutToBeApplied() and editApplied(), and
+  for those the clean state of the history, given to historyCleanChanged(),
+  tells if the log book is modified. Any other change, which can't be
+  undone, makes it modified until the next save.
+
+  Notifications are batched: however many changes are made while handling
+  one event, changed() is emitted once, from the event loop. While it is
+  emitted, changedLogs() and the other batch functions tell what changed.
+  The names of the locations added, renamed or removed are kept apart
+  from the other changes, as the dive logs show them; changedLocationNames()
+  lets the views update just the logs at those names.
+
+  A few things can't wait for the batch: removingLog() is emitted before
+  a log is removed, and reorderingLogs() and reorderedLogs() around
+  a reorder of the list, so views that map rows to list positions can
+  keep their current and selected logs.
+
+  Removed records are dropped from the sets, as their memory may be
+  reused for new records.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class ChangeTracker : public QObject {
+  Q_OBJECT
+public:
+  ChangeTracker(QObject* pcParent = 0);
+  virtual ~ChangeTracker();
+
+  void logChanged(DiveLog* pcLog);
+  void logRemoved(DiveLog* pcLog);
+  void logsAboutToBeReordered();
+  void logsReordered();
+  void locationAdded(LocationLog* pcLocation);
+  void locationChanged(LocationLog* pcLocation);
+  void locationRenamed(LocationLog* pcLocation, const QString& cOldName);
+  void locationRemoved(LocationLog* pcLocation);
+  void equipmentChanged(EquipmentLog* pcEquipment);
+  void equipmentHistoryChanged(EquipmentLog* pcEquipment);
+  void equipmentRemoved(EquipmentLog* pcEquipment);
+  void personalInfoChanged();
+  void editAboutToBeApplied();
+  void editApplied();
+
+  //! Get the generation, which is increased on every change.
+  unsigned int generation() const { return m_nGeneration; }
+  //! Get the generation of the equipment history dates.
+  unsigned int equipmentGeneration() const { return m_nEquipmentGeneration; }
+  //! Returns `true' if there are changes since the log book was saved.
+  bool isModified() const {
+    return m_isUnsavedChange || false == m_isHistoryClean;
+  }
+  void markSaved();
+  void reset();
+
+  //! Get the dive logs changed since the log book was saved.
+  const QSet<DiveLog*>& dirtyLogs() const { return m_cDirtyLogs; }
+  //! Get the locations changed since the log book was saved.
+  const QSet<LocationLog*>& dirtyLocations() const {
+    return m_cDirtyLocations;
+  }
+  //! Get the equipment changed since the log book was saved.
+  const QSet<EquipmentLog*>& dirtyEquipment() const {
+    return m_cDirtyEquipment;
+  }
+
+  //! Get the dive logs changed in the batch changed() is emitted for.
+  const QSet<DiveLog*>& changedLogs() const { return m_cBatchLogs; }
+  //! Returns `true' if anything but dive log fields changed in the batch.
+  bool hasOtherChanges() const { return m_isBatchOther; }
+  //! Get the location names added or removed in the batch.
+  const QSet<QString>& changedLocationNames() const {
+    return m_cBatchLocationNames;
+  }
+
+signals:
+  //! Emitted from the event loop after one or more changes.
+  void changed();
+  //! Emitted when isModified() changes to \a isModified.
+  void modifiedChanged(bool isModified);
+  //! Emitted when the dive log \a pcLog is about to be removed.
+  void removingLog(DiveLog* pcLog);
+  //! Emitted when the dive logs are about to be reordered in the list.
+  void reorderingLogs();
+  //! Emitted when the dive logs have been reordered in the list.
+  void reorderedLogs();
+
+public slots:
+  void historyCleanChanged(bool isClean);
+
+private slots:
+  void flush();
+
+private:
+  //! Disabled copy constructor.
+  ChangeTracker(const ChangeTracker&);
+  //! Disabled assignment operator.
+  ChangeTracker& operator =(const ChangeTracker&);
+
+  void touch();
+  void reportModified();
+
+  //! The dive logs changed since the last save.
+  QSet<DiveLog*>      m_cDirtyLogs;
+  //! The locations changed since the last save.
+  QSet<LocationLog*>  m_cDirtyLocations;
+  //! The equipment changed since the last save.
+  QSet<EquipmentLog*> m_cDirtyEquipment;
+  //! The dive logs changed since the last batch was sent.
+  QSet<DiveLog*>      m_cPendingLogs;
+  //! Set if anything else changed since the last batch was sent.
+  bool                m_isPendingOther;
+  //! The dive logs in the batch being sent.
+  QSet<DiveLog*>      m_cBatchLogs;
+  //! Set if anything else changed in the batch being sent.
+  bool                m_isBatchOther;
+  //! The location names added or removed since the last batch was sent.
+  QSet<QString>       m_cPendingLocationNames;
+  //! The location names added or removed in the batch being sent.
+  QSet<QString>       m_cBatchLocationNames;
+  //! The current generation.
+  unsigned int        m_nGeneration;
+  //! The current generation of the equipment history dates.
+  unsigned int        m_nEquipmentGeneration;
+  //! Set if a change not in the edit history was made since the last save.
+  bool                m_isUnsavedChange;
+  //! Set if the edit history is at the state it was last saved in.
+  bool                m_isHistoryClean;
+  //! Set while an edit from the edit history is applied.
+  bool                m_isApplyingEdit;
+  //! Set when flush() has been scheduled.
+  bool                m_isFlushPending;
+  //! The value of isModified() last reported by modifiedChanged().
+  bool                m_isReportedModified;
+};
+
+#endif // CHANGETRACKER_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
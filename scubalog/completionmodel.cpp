@@ -0,0 +1,486 @@
+//*****************************************************************************
+/*!
+  \file completionmodel.cpp
+  \brief This file contains the implementation of the CompletionModel class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "completionmodel.h"
+#include "divelog.h"
+#include "divelist.h"
+#include "locationlog.h"
+#include "logbook.h"
+#include "changetracker.h"
+#include <qset.h>
+#include <algorithm>
+#include <assert.h>
+
+
+/**
+ * The largest number of completions shown.
+ */
+
+static const int s_nMaxRows = 10;
+
+
+//*****************************************************************************
+/*!
+  \brief Orders the values of the prefix index.
+
+  Values are ordered on their key, and then on the value itself. A value
+  can also be compared to a plain key, so the values with a prefix can be
+  found with std::lower_bound().
+*/
+//*****************************************************************************
+
+struct ValueLess {
+  //! Returns `true' if the value \a cValue1 is ordered before \a cValue2.
+  template<class Value>
+  bool operator ()(const Value& cValue1, const Value& cValue2) const {
+    const int nOrder = QString::compare(cValue1.cKey, cValue2.cKey);
+    if ( nOrder )
+      return nOrder < 0;
+    return QString::compare(cValue1.cText, cValue2.cText) < 0;
+  }
+
+  //! Returns `true' if the key of the value \a cValue is before \a cKey.
+  template<class Value>
+  bool operator ()(const Value& cValue, const QString& cKey) const {
+    return QString::compare(cValue.cKey, cKey) < 0;
+  }
+};
+
+
+//*****************************************************************************
+/*!
+  \brief Orders the values of the prefix index by rank, best first.
+
+  The values are given by their position in the index. Values used in more
+  logs are ordered first, then those used on a later dive, and then by key.
+*/
+//*****************************************************************************
+
+template<class Value>
+struct RankLess {
+  //! Create an ordering of the positions of \a acValues.
+  explicit RankLess(const QVector<Value>& acValues) : m_acValues(acValues) {}
+
+  //! Returns `true' if the value at \a nIndex1 ranks before \a nIndex2.
+  bool operator ()(int nIndex1, int nIndex2) const {
+    const Value& cValue1 = m_acValues.at(nIndex1);
+    const Value& cValue2 = m_acValues.at(nIndex2);
+    if ( cValue1.nCount != cValue2.nCount )
+      return cValue1.nCount > cValue2.nCount;
+    if ( cValue1.cLatest != cValue2.cLatest )
+      return cValue1.cLatest > cValue2.cLatest;
+    return nIndex1 < nIndex2;
+  }
+
+  //! The values ranked.
+  const QVector<Value>& m_acValues;
+};
+
+
+//*****************************************************************************
+/*!
+  Create an empty model of the completions of the field \a eField,
+  with \a pcParent as the parent object.
+*/
+//*****************************************************************************
+
+CompletionModel::CompletionModel(DiveLogEdit::Field_e eField,
+                                 QObject* pcParent)
+  : QAbstractListModel(pcParent),
+    m_eField(eField),
+    m_pcLogBook(0),
+    m_pcTracker(0),
+    m_isIndexValid(false)
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the model. The log book is not touched.
+*/
+//*****************************************************************************
+
+CompletionModel::~CompletionModel()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Complete the values in \a pcLogBook, or nothing if it is 0.
+  The model doesn't own the log book.
+
+  The index isn't built until a prefix is set, so this takes the same time
+  whatever the size of the log book.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::setLogBook(LogBook* pcLogBook)
+{
+  beginResetModel();
+  if ( m_pcTracker )
+    disconnect(m_pcTracker, 0, this, 0);
+  m_pcLogBook = pcLogBook;
+  m_pcTracker = pcLogBook ? &pcLogBook->changeTracker() : 0;
+  if ( m_pcTracker ) {
+    connect(m_pcTracker, SIGNAL(changed()), SLOT(logBookChanged()));
+    connect(m_pcTracker, SIGNAL(removingLog(DiveLog*)),
+            SLOT(removingLog(DiveLog*)));
+  }
+  m_acRows.clear();
+  invalidateIndex();
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number of rows; the number of completions shown.
+*/
+//*****************************************************************************
+
+int
+CompletionModel::rowCount(const QModelIndex& cParent) const
+{
+  return cParent.isValid() ? 0 : m_acRows.count();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the data of \a cIndex for the role \a nRole; the completion.
+*/
+//*****************************************************************************
+
+QVariant
+CompletionModel::data(const QModelIndex& cIndex, int nRole) const
+{
+  if ( false == cIndex.isValid() ||
+       (Qt::DisplayRole != nRole && Qt::EditRole != nRole) )
+    return QVariant();
+  return m_acRows.value(cIndex.row());
+}
+
+
+//*****************************************************************************
+/*!
+  Show the best values starting with \a cPrefix, ignoring case, or none
+  if it is empty. A value the same as \a cPrefix isn't shown, as there
+  is nothing to complete.
+
+  The prefix index is built the first time this is called. The model is
+  reset, as the rows shown change.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::setPrefix(const QString& cPrefix)
+{
+  beginResetModel();
+  m_acRows.clear();
+  const QString cKey = cPrefix.toLower();
+  if ( false == cKey.isEmpty() && m_pcLogBook ) {
+    if ( false == m_isIndexValid )
+      buildIndex();
+
+    QVector<int> anMatches;
+    QVector<Value>::const_iterator iValue =
+      std::lower_bound(m_acValues.constBegin(), m_acValues.constEnd(), cKey,
+                       ValueLess());
+    for ( ; iValue != m_acValues.constEnd() && iValue->cKey.startsWith(cKey);
+          ++iValue ) {
+      if ( iValue->cText != cPrefix )
+        anMatches.append(iValue - m_acValues.constBegin());
+    }
+    const int nNumRows = qMin(anMatches.count(), s_nMaxRows);
+    std::partial_sort(anMatches.begin(), anMatches.begin() + nNumRows,
+                      anMatches.end(), RankLess<Value>(m_acValues));
+    for ( int iRow = 0; iRow < nNumRows; ++iRow )
+      m_acRows.append(m_acValues.at(anMatches.at(iRow)).cText);
+  }
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  The log book has changed. Move the count of each log changed from the
+  value it was counted under to its current value.
+
+  For the location field, the names of the locations added, renamed or
+  removed are marked as location names or not, and the logs at them are
+  moved as if they were changed, as a renamed location renames its logs.
+  Other changes don't touch the index. If logs were added other than
+  through the list, the index is dropped.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::logBookChanged()
+{
+  if ( false == m_isIndexValid )
+    return;
+
+  QSet<DiveLog*> cLogs = m_pcTracker->changedLogs();
+  if ( DiveLogEdit::e_DiveLocation == m_eField ) {
+    const DiveList& cDiveList = m_pcLogBook->diveList();
+    const QSet<QString>& cNames = m_pcTracker->changedLocationNames();
+    QSet<QString>::const_iterator iName = cNames.constBegin();
+    for ( ; iName != cNames.constEnd(); ++iName ) {
+      updateLocationName(*iName);
+      const QVector<DiveLog*> apcAt = cDiveList.logsAtLocation(*iName);
+      for ( int iAt = 0; iAt < apcAt.count(); ++iAt )
+        cLogs.insert(apcAt.at(iAt));
+    }
+  }
+
+  QSet<DiveLog*>::const_iterator iLog = cLogs.constBegin();
+  for ( ; iLog != cLogs.constEnd(); ++iLog ) {
+    QHash<const DiveLog*, QString>::iterator iOld = m_cLogValues.find(*iLog);
+    if ( iOld != m_cLogValues.end() ) {
+      removeValue(iOld.value());
+      m_cLogValues.erase(iOld);
+    }
+    addLog(*iLog);
+  }
+  if ( m_cLogValues.count() != m_pcLogBook->diveList().count() )
+    invalidateIndex();
+}
+
+
+//*****************************************************************************
+/*!
+  The log \a pcLog is about to be deleted. Drop its count from the value
+  it was counted under.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::removingLog(DiveLog* pcLog)
+{
+  if ( false == m_isIndexValid )
+    return;
+  QHash<const DiveLog*, QString>::iterator iOld = m_cLogValues.find(pcLog);
+  if ( iOld != m_cLogValues.end() ) {
+    removeValue(iOld.value());
+    m_cLogValues.erase(iOld);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Get the position of the value \a cText in the index, or of where it
+  would be inserted if it isn't there.
+*/
+//*****************************************************************************
+
+int
+CompletionModel::findValue(const QString& cText) const
+{
+  Value cValue;
+  cValue.cKey = cText.toLower();
+  cValue.cText = cText;
+  return std::lower_bound(m_acValues.constBegin(), m_acValues.constEnd(),
+                          cValue, ValueLess()) - m_acValues.constBegin();
+}
+
+
+//*****************************************************************************
+/*!
+  Count one more log with the value \a cText, dived at \a cDate.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::addValue(const QString& cText, const QDate& cDate)
+{
+  if ( cText.isEmpty() )
+    return;
+  const int nIndex = findValue(cText);
+  if ( nIndex < m_acValues.count() && m_acValues.at(nIndex).cText == cText ) {
+    Value& cValue = m_acValues[nIndex];
+    ++cValue.nCount;
+    if ( cDate > cValue.cLatest )
+      cValue.cLatest = cDate;
+    return;
+  }
+
+  Value cValue;
+  cValue.cKey = cText.toLower();
+  cValue.cText = cText;
+  cValue.nCount = 1;
+  cValue.cLatest = cDate;
+  cValue.isLocation = false;
+  m_acValues.insert(nIndex, cValue);
+}
+
+
+//*****************************************************************************
+/*!
+  Count one log less with the value \a cText. When no log has the value,
+  it is removed, unless it is the name of a location log.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::removeValue(const QString& cText)
+{
+  if ( cText.isEmpty() )
+    return;
+  const int nIndex = findValue(cText);
+  if ( nIndex >= m_acValues.count() || m_acValues.at(nIndex).cText != cText )
+    return;
+  Value& cValue = m_acValues[nIndex];
+  if ( --cValue.nCount <= 0 && false == cValue.isLocation )
+    m_acValues.remove(nIndex);
+}
+
+
+//*****************************************************************************
+/*!
+  Mark the value \a cName as the name of a location log or not, as the
+  dive list tells. A location name is kept even when no log has it.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::updateLocationName(const QString& cName)
+{
+  const bool isLocation = 0 != m_pcLogBook->diveList().findLocation(cName);
+  const int nIndex = findValue(cName);
+  if ( nIndex < m_acValues.count() && m_acValues.at(nIndex).cText == cName ) {
+    Value& cValue = m_acValues[nIndex];
+    cValue.isLocation = isLocation;
+    if ( cValue.nCount <= 0 && false == isLocation )
+      m_acValues.remove(nIndex);
+    return;
+  }
+  if ( false == isLocation )
+    return;
+
+  Value cValue;
+  cValue.cKey = cName.toLower();
+  cValue.cText = cName;
+  cValue.nCount = 0;
+  cValue.isLocation = true;
+  m_acValues.insert(nIndex, cValue);
+}
+
+
+//*****************************************************************************
+/*!
+  Count the log \a pcLog under its current value, and remember that value.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::addLog(const DiveLog* pcLog)
+{
+  const QString cText = DiveLogEdit::fieldValue(*pcLog, m_eField).toString();
+  m_cLogValues.insert(pcLog, cText);
+  addValue(cText, pcLog->diveDate());
+}
+
+
+//*****************************************************************************
+/*!
+  Drop the index, to be built again when next needed.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::invalidateIndex()
+{
+  m_acValues.clear();
+  m_cLogValues.clear();
+  m_isIndexValid = false;
+}
+
+
+//*****************************************************************************
+/*!
+  Build the index from all the logs in the log book, and for the location
+  field, the location logs.
+
+  The distinct values are collected in a hash, and sorted once at the end.
+*/
+//*****************************************************************************
+
+void
+CompletionModel::buildIndex()
+{
+  invalidateIndex();
+  m_isIndexValid = true;
+  if ( 0 == m_pcLogBook )
+    return;
+
+  QHash<QString, int> cPositions;
+  const DiveList& cDiveList = m_pcLogBook->diveList();
+  m_cLogValues.reserve(cDiveList.count());
+  for ( int iLog = 0; iLog < cDiveList.count(); ++iLog ) {
+    const DiveLog* pcLog = cDiveList.at(iLog);
+    const QString cText = DiveLogEdit::fieldValue(*pcLog, m_eField).toString();
+    m_cLogValues.insert(pcLog, cText);
+    if ( cText.isEmpty() )
+      continue;
+    int nIndex = cPositions.value(cText, -1);
+    if ( nIndex < 0 ) {
+      Value cValue;
+      cValue.cKey = cText.toLower();
+      cValue.cText = cText;
+      cValue.nCount = 0;
+      cValue.isLocation = false;
+      nIndex = m_acValues.count();
+      m_acValues.append(cValue);
+      cPositions.insert(cText, nIndex);
+    }
+    Value& cValue = m_acValues[nIndex];
+    ++cValue.nCount;
+    if ( pcLog->diveDate() > cValue.cLatest )
+      cValue.cLatest = pcLog->diveDate();
+  }
+
+  if ( DiveLogEdit::e_DiveLocation == m_eField ) {
+    QListIterator<LocationLog*> iLocation(m_pcLogBook->locationList());
+    while ( iLocation.hasNext() ) {
+      const QString cName = iLocation.next()->getName();
+      if ( cName.isEmpty() )
+        continue;
+      int nIndex = cPositions.value(cName, -1);
+      if ( nIndex < 0 ) {
+        Value cValue;
+        cValue.cKey = cName.toLower();
+        cValue.cText = cName;
+        cValue.nCount = 0;
+        nIndex = m_acValues.count();
+        m_acValues.append(cValue);
+        cPositions.insert(cName, nIndex);
+      }
+      m_acValues[nIndex].isLocation = true;
+    }
+  }
+
+  std::sort(m_acValues.begin(), m_acValues.end(), ValueLess());
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
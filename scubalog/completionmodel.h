@@ -0,0 +1,140 @@
+//*****************************************************************************
+/*!
+  \file completionmodel.h
+  \brief This file contains the definition of the CompletionModel class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef COMPLETIONMODEL_H
+#define COMPLETIONMODEL_H
+
+#include <QAbstractListModel>
+#include <qdatetime.h>
+#include <qhash.h>
+#include <qstring.h>
+#include <qvector.h>
+#include "divelogedit.h"
+
+class DiveLog;
+class LogBook;
+class ChangeTracker;
+
+
+//*****************************************************************************
+/*!
+  \class CompletionModel
+  \brief The CompletionModel class is a list model of the completions of
+  one text field of the dive logs.
+
+  The rows are the values of the field already in the log book starting
+  with the prefix given to setPrefix(), ignoring case, best first. Values
+  used in more logs rank first, and of those, the ones last used on the
+  latest dive. It is meant for a QCompleter in unfiltered popup mode,
+  with setPrefix() connected to the `textEdited' signal of the editor.
+
+  The values are kept in a prefix index; an array of the distinct values,
+  sorted on their lower case text, with the number of logs using each and
+  the latest dive date of those. The values with a prefix are a range of
+  the array, found by binary search, so a key typed costs the logarithm
+  of the number of values, and the ranking of the range.
+
+  The index is built the first time a prefix is set, and is then kept up
+  to date from the change tracker of the log book. The value each log was
+  counted under is remembered, so an edited log moves its count from the
+  old value to the new one, and a deleted log drops its count, without
+  reading the other logs. The latest date of a value isn't lowered when
+  a log stops using it, as that would mean searching the logs; it is
+  corrected the next time the index is built.
+
+  For the location field, the names of the location logs are values too,
+  even without dives. A location rename changes the location of the logs
+  there without them being edited, so the change tracker's batch of
+  location names added, renamed or removed is applied: those names are
+  marked as location names or not, and the logs at them are moved to
+  their current value. Other changes to the locations, like a new
+  description, leave the index alone.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class CompletionModel : public QAbstractListModel {
+  Q_OBJECT
+public:
+  CompletionModel(DiveLogEdit::Field_e eField, QObject* pcParent = 0);
+  virtual ~CompletionModel();
+
+  void setLogBook(LogBook* pcLogBook);
+  //! Get the field completed.
+  DiveLogEdit::Field_e field() const { return m_eField; }
+
+  virtual int rowCount(const QModelIndex& cParent = QModelIndex()) const;
+  virtual QVariant data(const QModelIndex& cIndex,
+                        int nRole = Qt::DisplayRole) const;
+
+public slots:
+  void setPrefix(const QString& cPrefix);
+
+private slots:
+  void logBookChanged();
+  void removingLog(DiveLog* pcLog);
+
+private:
+  //! Disabled copy constructor.
+  CompletionModel(const CompletionModel&);
+  //! Disabled assignment operator.
+  CompletionModel& operator =(const CompletionModel&);
+
+  //! A distinct value of the field.
+  struct Value {
+    //! The value in lower case; the sort key.
+    QString cKey;
+    //! The value.
+    QString cText;
+    //! The number of logs with the value.
+    int     nCount;
+    //! The latest dive date of the logs with the value.
+    QDate   cLatest;
+    //! Set if the value is the name of a location log.
+    bool    isLocation;
+  };
+
+  int findValue(const QString& cText) const;
+  void addValue(const QString& cText, const QDate& cDate);
+  void removeValue(const QString& cText);
+  void addLog(const DiveLog* pcLog);
+  void updateLocationName(const QString& cName);
+  void invalidateIndex();
+  void buildIndex();
+
+  //! The field completed.
+  DiveLogEdit::Field_e           m_eField;
+  //! The log book, or 0.
+  LogBook*                       m_pcLogBook;
+  //! The change tracker of the log book, or 0.
+  ChangeTracker*                 m_pcTracker;
+  //! The completions shown, best first.
+  QVector<QString>               m_acRows;
+  //! The prefix index, sorted on the key, and then the value.
+  QVector<Value>                 m_acValues;
+  //! The value each log is counted under.
+  QHash<const DiveLog*, QString> m_cLogValues;
+  //! Set when the prefix index is built.
+  bool                           m_isIndexValid;
+};
+
+#endif // COMPLETIONMODEL_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,1012 @@
+//*****************************************************************************
+/*!
+  \file divelist.cpp
+  \brief This file contains the implementation of the DiveList class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "divelist.h"
+#include "locationlog.h"
+#include "changetracker.h"
+#include "debug.h"
+#include <qset.h>
+#include <new>
+#include <algorithm>
+#include <functional>
+#include <assert.h>
+
+
+//! Compare the two items \a pcItem1 and \a pcItem2 in the list.
+static bool compareDiveLogItems(const DiveLog* pcLog1, const DiveLog* pcLog2)
+{
+  return pcLog1->logNumber() < pcLog2->logNumber();
+}
+
+
+//*****************************************************************************
+/*!
+  \brief Orders logs on one of the sort keys of DiveList.
+
+  Logs with equal keys are ordered on the log number, and then on the
+  address, so no two logs compare equal. That lets a log be found in a
+  sorted view by binary search.
+*/
+//*****************************************************************************
+
+struct SortKeyLess {
+  //! Create an ordering on \a eKey.
+  explicit SortKeyLess(DiveList::SortKey_e eKey) : m_eKey(eKey) {}
+
+  //! Returns `true' if \a pcLog1 is ordered before \a pcLog2.
+  bool operator ()(const DiveLog* pcLog1, const DiveLog* pcLog2) const {
+    int nOrder = 0;
+    switch ( m_eKey ) {
+    case DiveList::e_ByDate:
+      if ( pcLog1->diveDate() != pcLog2->diveDate() )
+        return pcLog1->diveDate() < pcLog2->diveDate();
+      if ( pcLog1->diveStart() != pcLog2->diveStart() )
+        return pcLog1->diveStart() < pcLog2->diveStart();
+      break;
+    case DiveList::e_ByLocation:
+      nOrder = QString::compare(pcLog1->diveLocation(),
+                                pcLog2->diveLocation(), Qt::CaseInsensitive);
+      if ( nOrder )
+        return nOrder < 0;
+      break;
+    case DiveList::e_ByMaxDepth:
+      if ( pcLog1->maxDepth() != pcLog2->maxDepth() )
+        return pcLog1->maxDepth() < pcLog2->maxDepth();
+      break;
+    case DiveList::e_ByDiveTime:
+      if ( pcLog1->diveTime() != pcLog2->diveTime() )
+        return pcLog1->diveTime() < pcLog2->diveTime();
+      break;
+    default:
+      break;
+    }
+    if ( pcLog1->logNumber() != pcLog2->logNumber() )
+      return pcLog1->logNumber() < pcLog2->logNumber();
+    return std::less<const DiveLog*>()(pcLog1, pcLog2);
+  }
+
+  //! The key to order on.
+  DiveList::SortKey_e m_eKey;
+};
+
+
+//! Tells if a log is in a set of logs being deleted.
+struct IsInSet {
+  //! Create a test for membership of \a cLogs.
+  explicit IsInSet(const QSet<const DiveLog*>& cLogs) : m_cLogs(cLogs) {}
+
+  //! Returns `true' if \a pcLog is in the set.
+  bool operator ()(const DiveLog* pcLog) const {
+    return m_cLogs.contains(pcLog);
+  }
+
+  //! The logs.
+  const QSet<const DiveLog*>& m_cLogs;
+};
+
+
+//*****************************************************************************
+/*!
+  Initialise the list.
+*/
+//*****************************************************************************
+
+DiveList::DiveList()
+  : m_nHighestNumber(0),
+    m_isHighestNumberValid(true),
+    m_nSortedKeys(0),
+    m_nTotalDiveTime(0),
+    m_nTotalGasUsed(0),
+    m_pcTracker(0),
+    m_pcFreeSlots(0)
+{
+  DBG(("DiveList::DiveList()\n"));
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the list, with all its logs.
+*/
+//*****************************************************************************
+
+DiveList::~DiveList()
+{
+  clear();
+  for ( int iSlab = 0; iSlab < m_apvSlabs.count(); ++iSlab )
+    ::operator delete(m_apvSlabs.at(iSlab));
+}
+
+
+//*****************************************************************************
+/*!
+  Create a new, empty log. The log is not in the list until it is
+  passed to append().
+
+  std::bad_alloc is thrown if out of memory.
+*/
+//*****************************************************************************
+
+DiveLog*
+DiveList::newLog()
+{
+  if ( 0 == m_pcFreeSlots )
+    allocateSlab();
+
+  FreeSlot* pcSlot = m_pcFreeSlots;
+  m_pcFreeSlots = pcSlot->pcNext;
+  try {
+    return new (pcSlot) DiveLog();
+  }
+  catch ( ... ) {
+    pcSlot->pcNext = m_pcFreeSlots;
+    m_pcFreeSlots = pcSlot;
+    throw;
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Append the log \a pcLog, which must have been created with newLog(),
+  to the end of the list.
+
+  Returns `false' if another log in the list already has the same log
+  number. The log is appended anyway, so the caller can decide what to do.
+*/
+//*****************************************************************************
+
+bool
+DiveList::append(DiveLog* pcLog)
+{
+  assert(pcLog);
+  assert(0 == pcLog->m_pcOwner);
+  const bool isUnique = !m_cLogNumbers.contains(pcLog->logNumber());
+  pcLog->m_nListIndex = m_apcLogs.count();
+  m_apcLogs.append(pcLog);
+  m_cLogNumbers.insert(pcLog->logNumber(), pcLog);
+  numberAdded(pcLog->logNumber());
+  keysChanged(pcLog, e_AllKeys);
+  pcLog->m_pcOwner = this;
+  logChanged(pcLog);
+  if ( false == isUnique )
+    DBG(("DiveList: duplicate log number %d\n", pcLog->logNumber()));
+  return isUnique;
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the log \a pcLog from the list, if it is in it, and delete it.
+*/
+//*****************************************************************************
+
+void
+DiveList::deleteLog(DiveLog* pcLog)
+{
+  if ( 0 == pcLog )
+    return;
+
+  if ( pcLog->m_pcOwner ) {
+    assert(this == pcLog->m_pcOwner);
+    const int nIndex = pcLog->m_nListIndex;
+    assert(m_apcLogs.at(nIndex) == pcLog);
+    m_apcLogs.remove(nIndex);
+    m_cLogNumbers.remove(pcLog->logNumber(), pcLog);
+    numberRemoved(pcLog->logNumber());
+    keysAboutToChange(pcLog, e_AllKeys);
+    updateListIndices(nIndex);
+    if ( m_pcTracker )
+      m_pcTracker->logRemoved(pcLog);
+  }
+  destroyLog(pcLog);
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the logs \a apcLogs from the list and delete them. The logs must
+  be in the list; a log given more than once is deleted once.
+
+  This gives the same result as calling deleteLog() for each log, but the
+  list and the sorted views are compacted once, and the list positions
+  updated once, so deleting many logs takes time in proportion to the
+  size of the list, not to the size of the list times the number of logs.
+*/
+//*****************************************************************************
+
+void
+DiveList::deleteLogs(const QVector<DiveLog*>& apcLogs)
+{
+  QSet<const DiveLog*> cDeleted;
+  cDeleted.reserve(apcLogs.count());
+  int nFirstIndex = m_apcLogs.count();
+
+  // Take the logs out of the totals, the locations and the number index;
+  // the sorted views are compacted below
+  const int nSortedKeys = m_nSortedKeys;
+  m_nSortedKeys = 0;
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog ) {
+    DiveLog* pcLog = apcLogs.at(iLog);
+    if ( 0 == pcLog || cDeleted.contains(pcLog) )
+      continue;
+    assert(this == pcLog->m_pcOwner);
+    cDeleted.insert(pcLog);
+    nFirstIndex = qMin(nFirstIndex, pcLog->m_nListIndex);
+    m_cLogNumbers.remove(pcLog->logNumber(), pcLog);
+    numberRemoved(pcLog->logNumber());
+    keysAboutToChange(pcLog, e_AllKeys);
+  }
+  m_nSortedKeys = nSortedKeys;
+
+  if ( false == cDeleted.isEmpty() ) {
+    const IsInSet cIsDeleted(cDeleted);
+    m_apcLogs.erase(std::remove_if(m_apcLogs.begin(), m_apcLogs.end(),
+                                   cIsDeleted),
+                    m_apcLogs.end());
+    for ( int iKey = 0; iKey < e_NumSortKeys; ++iKey ) {
+      if ( 0 == (m_nSortedKeys & (1 << iKey)) )
+        continue;
+      QVector<DiveLog*>& apcSorted = m_aapcSorted[iKey];
+      apcSorted.erase(std::remove_if(apcSorted.begin(), apcSorted.end(),
+                                     cIsDeleted),
+                      apcSorted.end());
+    }
+    updateListIndices(nFirstIndex);
+  }
+
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog ) {
+    DiveLog* pcLog = apcLogs.at(iLog);
+    if ( 0 == pcLog || false == cDeleted.remove(pcLog) )
+      continue;
+    if ( m_pcTracker )
+      m_pcTracker->logRemoved(pcLog);
+    destroyLog(pcLog);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Delete all the logs in the list. The slabs are kept for reuse.
+*/
+//*****************************************************************************
+
+void
+DiveList::clear()
+{
+  QVector<DiveLog*> apcLogs;
+  apcLogs.swap(m_apcLogs);
+  m_cLogNumbers.clear();
+  m_nHighestNumber = 0;
+  m_isHighestNumberValid = true;
+  m_cUnlinked.clear();
+  for ( int iKey = 0; iKey < e_NumSortKeys; ++iKey )
+    m_aapcSorted[iKey].clear();
+  m_nSortedKeys = 0;
+  m_nTotalDiveTime = 0;
+  m_nTotalGasUsed = 0;
+  QHash<QString, LocationLog*>::const_iterator iLocation =
+    m_cLocations.constBegin();
+  for ( ; iLocation != m_cLocations.constEnd(); ++iLocation )
+    iLocation.value()->m_apcDives.clear();
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog )
+    destroyLog(apcLogs.at(iLog));
+}
+
+
+//*****************************************************************************
+/*!
+  Sort the list on the log numbers.
+
+  The reorder is reported to the change tracker before and after, as it
+  moves the logs to new list positions.
+*/
+//*****************************************************************************
+
+void
+DiveList::sort()
+{
+  if ( m_pcTracker )
+    m_pcTracker->logsAboutToBeReordered();
+  std::sort(m_apcLogs.begin(), m_apcLogs.end(), compareDiveLogItems);
+  updateListIndices(0);
+  if ( m_pcTracker )
+    m_pcTracker->logsReordered();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number for a new log; one more than the highest number in use,
+  or 1 if the list is empty.
+
+  The highest number is kept as logs are added and renumbered, so this is
+  constant time. Only after the log with the highest number is deleted or
+  renumbered is the list searched, once, for the new highest.
+*/
+//*****************************************************************************
+
+int
+DiveList::nextLogNumber() const
+{
+  if ( false == m_isHighestNumberValid ) {
+    m_nHighestNumber = 0;
+    for ( int iLog = 0; iLog < m_apcLogs.count(); ++iLog ) {
+      m_nHighestNumber =
+        qMax(m_nHighestNumber, m_apcLogs.at(iLog)->logNumber());
+    }
+    m_isHighestNumberValid = true;
+  }
+  return m_nHighestNumber + 1;
+}
+
+
+//*****************************************************************************
+/*!
+  Count the problems in the log numbers. \a nGaps is set to the number of
+  unused numbers between the lowest and the highest, and \a nDuplicates to
+  the number of logs that repeat a number used by an earlier log; all the
+  logs with a number but one, so three logs with the same number count as
+  two duplicates. That is the number of logs that need a new number.
+*/
+//*****************************************************************************
+
+void
+DiveList::checkNumbering(int& nGaps, int& nDuplicates) const
+{
+  nGaps = 0;
+  nDuplicates = 0;
+
+  QVector<int> anNumbers(m_apcLogs.count());
+  for ( int iLog = 0; iLog < m_apcLogs.count(); ++iLog )
+    anNumbers[iLog] = m_apcLogs.at(iLog)->logNumber();
+  std::sort(anNumbers.begin(), anNumbers.end());
+
+  for ( int iNumber = 1; iNumber < anNumbers.count(); ++iNumber ) {
+    const int nStep = anNumbers.at(iNumber) - anNumbers.at(iNumber - 1);
+    if ( 0 == nStep )
+      ++nDuplicates;
+    else
+      nGaps += nStep - 1;
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Give each log in \a apcLogs the number at the same position in
+  \a anNumbers. The logs must be in this list.
+
+  The numbers are set in one pass: the index is rebuilt and the list is
+  sorted once, and the sorted views, which use the numbers to order logs
+  with equal keys, are dropped to be sorted again when next asked for.
+  Each log is reported to the change tracker, and sort() reports the new
+  order.
+*/
+//*****************************************************************************
+
+void
+DiveList::setLogNumbers(const QVector<DiveLog*>& apcLogs,
+                        const QVector<int>& anNumbers)
+{
+  assert(apcLogs.count() == anNumbers.count());
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog ) {
+    DiveLog* pcLog = apcLogs.at(iLog);
+    assert(this == pcLog->m_pcOwner);
+    pcLog->m_nLogNumber = anNumbers.at(iLog);
+    logChanged(pcLog);
+  }
+
+  m_cLogNumbers.clear();
+  m_cLogNumbers.reserve(m_apcLogs.count());
+  m_nHighestNumber = 0;
+  m_isHighestNumberValid = true;
+  for ( int iLog = 0; iLog < m_apcLogs.count(); ++iLog ) {
+    DiveLog* pcLog = m_apcLogs.at(iLog);
+    m_cLogNumbers.insert(pcLog->logNumber(), pcLog);
+    numberAdded(pcLog->logNumber());
+  }
+
+  for ( int iKey = 0; iKey < e_NumSortKeys; ++iKey )
+    m_aapcSorted[iKey].clear();
+  m_nSortedKeys = 0;
+
+  sort();
+}
+
+
+//*****************************************************************************
+/*!
+  Use \a cLocations as the location logs, and link all the logs in the
+  list to them. Any earlier locations are forgotten.
+
+  This takes time in proportion to the number of logs and locations, and
+  is meant to be called once after a log book is loaded. If more than one
+  location has the same name, the first one is used.
+*/
+//*****************************************************************************
+
+void
+DiveList::setLocations(const QList<LocationLog*>& cLocations)
+{
+  for ( int iLog = 0; iLog < m_apcLogs.count(); ++iLog )
+    unlinkLocation(m_apcLogs.at(iLog));
+  m_cLocations.clear();
+  m_cUnlinked.clear();
+
+  QListIterator<LocationLog*> iLocation(cLocations);
+  while ( iLocation.hasNext() ) {
+    LocationLog* pcLocation = iLocation.next();
+    const QString cName = pcLocation->getName();
+    if ( false == cName.isEmpty() && false == m_cLocations.contains(cName) )
+      m_cLocations.insert(cName, pcLocation);
+  }
+
+  for ( int iLog = 0; iLog < m_apcLogs.count(); ++iLog )
+    linkLocation(m_apcLogs.at(iLog));
+}
+
+
+//*****************************************************************************
+/*!
+  Add the new location log \a pcLocation, and link the logs at that
+  location to it. If another location already has its name, or it has no
+  name, nothing is linked to it.
+
+  The logs are found in the index of unlinked logs by location name, so
+  this takes time in proportion to the number of logs linked.
+*/
+//*****************************************************************************
+
+void
+DiveList::addLocation(LocationLog* pcLocation)
+{
+  assert(pcLocation);
+  const QString cName = pcLocation->getName();
+  if ( cName.isEmpty() || m_cLocations.contains(cName) )
+    return;
+  indexLocation(pcLocation);
+}
+
+
+//*****************************************************************************
+/*!
+  The location log \a pcLocation is about to be deleted. The logs at it
+  are unlinked, but keep its name as their location.
+*/
+//*****************************************************************************
+
+void
+DiveList::removeLocation(LocationLog* pcLocation)
+{
+  assert(pcLocation);
+  const QString cName = pcLocation->getName();
+  if ( m_cLocations.value(cName, 0) == pcLocation )
+    m_cLocations.remove(cName);
+  releaseDives(pcLocation);
+}
+
+
+//*****************************************************************************
+/*!
+  Rename the location log \a pcLocation to \a cName. Returns `false',
+  without renaming, if another location already has the name, as two
+  locations with the same name can't be told apart by the dive logs.
+
+  The logs at the location read their location name from it, so they
+  follow the rename without being touched. Logs not linked to a location
+  that already have the new name as their location are linked to it, as
+  with addLocation().
+
+  A location without a name can't be linked to, so renaming to an empty
+  name unlinks the logs at it, and they keep the old name.
+
+  This takes time in proportion to the number of logs linked or unlinked,
+  not to the size of the list.
+*/
+//*****************************************************************************
+
+bool
+DiveList::renameLocation(LocationLog* pcLocation, const QString& cName)
+{
+  assert(pcLocation);
+  const QString cOldName = pcLocation->getName();
+  if ( cName == cOldName )
+    return true;
+  if ( false == cName.isEmpty() && m_cLocations.contains(cName) )
+    return false;
+
+  // The location view is sorted on the old name
+  if ( false == pcLocation->m_apcDives.isEmpty() ) {
+    m_aapcSorted[e_ByLocation].clear();
+    m_nSortedKeys &= ~(1 << e_ByLocation);
+  }
+
+  if ( m_cLocations.value(cOldName, 0) == pcLocation )
+    m_cLocations.remove(cOldName);
+  if ( cName.isEmpty() )
+    releaseDives(pcLocation);
+  pcLocation->setName(cName);
+  if ( false == cName.isEmpty() )
+    indexLocation(pcLocation);
+  return true;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the logs with \a cName as their location, whether they are linked to
+  a location log or not. This takes time in proportion to the number of
+  logs found.
+*/
+//*****************************************************************************
+
+QVector<DiveLog*>
+DiveList::logsAtLocation(const QString& cName) const
+{
+  QVector<DiveLog*> apcLogs;
+  LocationLog* pcLocation = m_cLocations.value(cName, 0);
+  if ( pcLocation )
+    apcLogs = pcLocation->m_apcDives;
+  const QSet<DiveLog*> cUnlinked = m_cUnlinked.value(cName);
+  QSet<DiveLog*>::const_iterator iLog = cUnlinked.constBegin();
+  for ( ; iLog != cUnlinked.constEnd(); ++iLog )
+    apcLogs.append(*iLog);
+  return apcLogs;
+}
+
+
+//*****************************************************************************
+/*!
+  Index the location log \a pcLocation, which must have a name no other
+  location has, under its name, and link the unlinked logs with that name
+  as their location to it.
+*/
+//*****************************************************************************
+
+void
+DiveList::indexLocation(LocationLog* pcLocation)
+{
+  const QString cName = pcLocation->getName();
+  assert(false == cName.isEmpty() && false == m_cLocations.contains(cName));
+  m_cLocations.insert(cName, pcLocation);
+  const QSet<DiveLog*> cLogs = m_cUnlinked.take(cName);
+  QSet<DiveLog*>::const_iterator iLog = cLogs.constBegin();
+  for ( ; iLog != cLogs.constEnd(); ++iLog )
+    attachLocation(*iLog, pcLocation);
+}
+
+
+//*****************************************************************************
+/*!
+  Unlink the logs at \a pcLocation, which must not be indexed under its
+  name, and put them in the index of unlinked logs under its name.
+*/
+//*****************************************************************************
+
+void
+DiveList::releaseDives(LocationLog* pcLocation)
+{
+  while ( false == pcLocation->m_apcDives.isEmpty() ) {
+    DiveLog* pcLog = pcLocation->m_apcDives.last();
+    detachLocation(pcLog);
+    linkLocation(pcLog);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Get the logs sorted on \a eKey. The list itself isn't changed.
+
+  The first call for a key sorts the logs. After that, the view is kept
+  sorted until the list is cleared, so later calls are cheap.
+*/
+//*****************************************************************************
+
+const QVector<DiveLog*>&
+DiveList::sortedLogs(SortKey_e eKey) const
+{
+  assert(eKey >= 0 && eKey < e_NumSortKeys);
+  QVector<DiveLog*>& apcSorted = m_aapcSorted[eKey];
+  if ( 0 == (m_nSortedKeys & (1 << eKey)) ) {
+    apcSorted = m_apcLogs;
+    std::sort(apcSorted.begin(), apcSorted.end(), SortKeyLess(eKey));
+    m_nSortedKeys |= 1 << eKey;
+  }
+  return apcSorted;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the logs at the indices \a anIndices, which must be distinct and in
+  the list, sorted on \a eKey, in the same order as in sortedLogs().
+
+  Only the logs asked for are sorted, so this takes time in proportion to
+  their number. If all the logs are asked for, the view is returned.
+*/
+//*****************************************************************************
+
+QVector<DiveLog*>
+DiveList::sortedLogs(SortKey_e eKey, const QVector<int>& anIndices) const
+{
+  if ( anIndices.count() == m_apcLogs.count() )
+    return sortedLogs(eKey);
+  QVector<DiveLog*> apcSorted;
+  apcSorted.reserve(anIndices.count());
+  for ( int iIndex = 0; iIndex < anIndices.count(); ++iIndex )
+    apcSorted.append(m_apcLogs.at(anIndices.at(iIndex)));
+  std::sort(apcSorted.begin(), apcSorted.end(), SortKeyLess(eKey));
+  return apcSorted;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the log with the greatest maximum depth, or 0 if the list is empty.
+  The first call sorts the depth view; after that it is kept sorted.
+*/
+//*****************************************************************************
+
+DiveLog*
+DiveList::deepestLog() const
+{
+  const QVector<DiveLog*>& apcByDepth = sortedLogs(e_ByMaxDepth);
+  return apcByDepth.isEmpty() ? 0 : apcByDepth.last();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the log before \a pcLog in the list. 0 is returned if \a pcLog is
+  the first log, or isn't in the list.
+*/
+//*****************************************************************************
+
+DiveLog*
+DiveList::previousLog(const DiveLog* pcLog) const
+{
+  const int nIndex = indexOf(pcLog);
+  return ( nIndex > 0 ) ? m_apcLogs.at(nIndex - 1) : 0;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the log after \a pcLog in the list. 0 is returned if \a pcLog is
+  the last log, or isn't in the list.
+*/
+//*****************************************************************************
+
+DiveLog*
+DiveList::nextLog(const DiveLog* pcLog) const
+{
+  const int nIndex = indexOf(pcLog);
+  return ( nIndex >= 0 && nIndex + 1 < m_apcLogs.count() ) ?
+    m_apcLogs.at(nIndex + 1) : 0;
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the log \a pcLog, and put its slot on the free list.
+  The log must already be removed from the list.
+*/
+//*****************************************************************************
+
+void
+DiveList::destroyLog(DiveLog* pcLog)
+{
+  pcLog->~DiveLog();
+  FreeSlot* pcSlot = reinterpret_cast<FreeSlot*>(pcLog);
+  pcSlot->pcNext = m_pcFreeSlots;
+  m_pcFreeSlots = pcSlot;
+}
+
+
+//*****************************************************************************
+/*!
+  Store the position in the list in each log from \a nFirstIndex to the end.
+*/
+//*****************************************************************************
+
+void
+DiveList::updateListIndices(int nFirstIndex)
+{
+  for ( int iLog = nFirstIndex; iLog < m_apcLogs.count(); ++iLog )
+    m_apcLogs.at(iLog)->m_nListIndex = iLog;
+}
+
+
+//*****************************************************************************
+/*!
+  The log \a pcLog in this list changed its number from \a nOldNumber.
+  Update the index.
+*/
+//*****************************************************************************
+
+void
+DiveList::logNumberChanged(DiveLog* pcLog, int nOldNumber)
+{
+  m_cLogNumbers.remove(nOldNumber, pcLog);
+  numberRemoved(nOldNumber);
+  if ( m_cLogNumbers.contains(pcLog->logNumber()) )
+    DBG(("DiveList: duplicate log number %d\n", pcLog->logNumber()));
+  m_cLogNumbers.insert(pcLog->logNumber(), pcLog);
+  numberAdded(pcLog->logNumber());
+}
+
+
+//*****************************************************************************
+/*!
+  The log number \a nLogNumber has been added to the number index.
+  Raise the highest number in use if it is higher.
+*/
+//*****************************************************************************
+
+void
+DiveList::numberAdded(int nLogNumber)
+{
+  if ( m_isHighestNumberValid && nLogNumber > m_nHighestNumber )
+    m_nHighestNumber = nLogNumber;
+}
+
+
+//*****************************************************************************
+/*!
+  A log with the number \a nLogNumber has been removed from the number
+  index. If no log has the highest number any more, it is found again
+  when next needed.
+*/
+//*****************************************************************************
+
+void
+DiveList::numberRemoved(int nLogNumber)
+{
+  if ( nLogNumber == m_nHighestNumber &&
+       false == m_cLogNumbers.contains(nLogNumber) )
+    m_isHighestNumberValid = false;
+}
+
+
+//*****************************************************************************
+/*!
+  One or more of the keys in \a nKeyMask of \a pcLog is about to change.
+  Remove the log from the sorted views of those keys, while it can still
+  be found by its old keys. If the totals are summed from any of them,
+  take the log out of the totals.
+
+  If the log isn't found in a view, a key was changed without telling the
+  list first, and the view is dropped rather than trusted.
+*/
+//*****************************************************************************
+
+void
+DiveList::keysAboutToChange(DiveLog* pcLog, int nKeyMask)
+{
+  if ( nKeyMask & (1 << e_ByLocation) )
+    unlinkLocation(pcLog);
+  if ( nKeyMask & e_TotalsKeys )
+    addTotals(pcLog, -1);
+
+  nKeyMask &= m_nSortedKeys;
+  for ( int iKey = 0; nKeyMask; ++iKey, nKeyMask >>= 1 ) {
+    if ( 0 == (nKeyMask & 1) )
+      continue;
+    QVector<DiveLog*>& apcSorted = m_aapcSorted[iKey];
+    QVector<DiveLog*>::iterator i =
+      std::lower_bound(apcSorted.begin(), apcSorted.end(), pcLog,
+                       SortKeyLess(SortKey_e(iKey)));
+    if ( i != apcSorted.end() && *i == pcLog ) {
+      apcSorted.erase(i);
+    }
+    else {
+      // A key changed without being reported, so the view is out of
+      // order; drop it, to be sorted again when next asked for
+      apcSorted.clear();
+      m_nSortedKeys &= ~(1 << iKey);
+    }
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  One or more of the keys in \a nKeyMask of \a pcLog has changed, or the
+  log is new. Insert it in the sorted views of those keys. If the totals
+  are summed from any of them, add the log to the totals.
+*/
+//*****************************************************************************
+
+void
+DiveList::keysChanged(DiveLog* pcLog, int nKeyMask)
+{
+  if ( nKeyMask & (1 << e_ByLocation) )
+    linkLocation(pcLog);
+  if ( nKeyMask & e_TotalsKeys )
+    addTotals(pcLog, 1);
+
+  nKeyMask &= m_nSortedKeys;
+  for ( int iKey = 0; nKeyMask; ++iKey, nKeyMask >>= 1 ) {
+    if ( 0 == (nKeyMask & 1) )
+      continue;
+    QVector<DiveLog*>& apcSorted = m_aapcSorted[iKey];
+    apcSorted.insert(std::upper_bound(apcSorted.begin(), apcSorted.end(),
+                                      pcLog, SortKeyLess(SortKey_e(iKey))),
+                     pcLog);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  The log \a pcLog has changed, or has been appended. Tell the change
+  tracker, if there is one.
+*/
+//*****************************************************************************
+
+void
+DiveList::logChanged(DiveLog* pcLog)
+{
+  if ( m_pcTracker )
+    m_pcTracker->logChanged(pcLog);
+}
+
+
+//*****************************************************************************
+/*!
+  Add the dive time and gas used of \a pcLog to the totals, or subtract
+  them if \a nSign is -1.
+*/
+//*****************************************************************************
+
+void
+DiveList::addTotals(const DiveLog* pcLog, int nSign)
+{
+  m_nTotalDiveTime += nSign * (pcLog->diveTime().msecsSinceStartOfDay() / 1000);
+  m_nTotalGasUsed += nSign * qint64(pcLog->surfaceAirConsuption());
+}
+
+
+//*****************************************************************************
+/*!
+  Link \a pcLog to the location log named as its location, if there is one,
+  or else put it in the index of unlinked logs, so it is linked when
+  a location with that name is added. The log must not be linked already.
+*/
+//*****************************************************************************
+
+void
+DiveList::linkLocation(DiveLog* pcLog)
+{
+  assert(0 == pcLog->m_pcLocationLog);
+  if ( pcLog->m_cLocation.isEmpty() )
+    return;
+
+  LocationLog* pcLocation = m_cLocations.value(pcLog->m_cLocation, 0);
+  if ( pcLocation )
+    attachLocation(pcLog, pcLocation);
+  else
+    m_cUnlinked[pcLog->m_cLocation].insert(pcLog);
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the link from \a pcLog to its location log, if it has one, or
+  else remove it from the index of unlinked logs. The log keeps the
+  current name of the location.
+*/
+//*****************************************************************************
+
+void
+DiveList::unlinkLocation(DiveLog* pcLog)
+{
+  if ( pcLog->m_pcLocationLog ) {
+    detachLocation(pcLog);
+    return;
+  }
+  QHash<QString, QSet<DiveLog*> >::iterator i =
+    m_cUnlinked.find(pcLog->m_cLocation);
+  if ( i != m_cUnlinked.end() ) {
+    i->remove(pcLog);
+    if ( i->isEmpty() )
+      m_cUnlinked.erase(i);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Link \a pcLog, which isn't linked or indexed, to \a pcLocation.
+*/
+//*****************************************************************************
+
+void
+DiveList::attachLocation(DiveLog* pcLog, LocationLog* pcLocation)
+{
+  pcLog->m_nLocationSlot = pcLocation->m_apcDives.count();
+  pcLocation->m_apcDives.append(pcLog);
+  pcLog->m_pcLocationLog = pcLocation;
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the link from \a pcLog to its location log. The log keeps the
+  current name of the location.
+
+  The last log at the location is moved to the slot of \a pcLog, so this
+  is constant time however many logs are at the location.
+*/
+//*****************************************************************************
+
+void
+DiveList::detachLocation(DiveLog* pcLog)
+{
+  LocationLog* pcLocation = pcLog->m_pcLocationLog;
+  assert(pcLocation);
+  pcLog->m_cLocation = pcLocation->getName();
+  QVector<DiveLog*>& apcDives = pcLocation->m_apcDives;
+  const int nSlot = pcLog->m_nLocationSlot;
+  assert(apcDives.at(nSlot) == pcLog);
+  DiveLog* pcLast = apcDives.last();
+  apcDives[nSlot] = pcLast;
+  pcLast->m_nLocationSlot = nSlot;
+  apcDives.removeLast();
+  pcLog->m_pcLocationLog = 0;
+  pcLog->m_nLocationSlot = -1;
+}
+
+
+//*****************************************************************************
+/*!
+  Allocate a new slab, and put all its slots on the free list.
+
+  std::bad_alloc is thrown if out of memory.
+*/
+//*****************************************************************************
+
+void
+DiveList::allocateSlab()
+{
+  const size_t nSlotSize =
+    sizeof(DiveLog) > sizeof(FreeSlot) ? sizeof(DiveLog) : sizeof(FreeSlot);
+  char* pzSlab = static_cast<char*>(::operator new(nSlotSize * e_LogsPerSlab));
+  try {
+    m_apvSlabs.append(pzSlab);
+  }
+  catch ( ... ) {
+    ::operator delete(pzSlab);
+    throw;
+  }
+  DBG(("DiveList: allocated slab %d\n", m_apvSlabs.count()));
+
+  // Link the slots so the first one is used first
+  for ( int iSlot = e_LogsPerSlab - 1; iSlot >= 0; --iSlot ) {
+    FreeSlot* pcSlot = reinterpret_cast<FreeSlot*>(pzSlab + iSlot * nSlotSize);
+    pcSlot->pcNext = m_pcFreeSlots;
+    m_pcFreeSlots = pcSlot;
+  }
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
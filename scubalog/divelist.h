@@ -14,20 +14,14 @@
 #ifndef DIVELIST_H
 #define DIVELIST_H
 
-#include "debug.h"
 #include "divelog.h"
+#include <qhash.h>
 #include <qlist.h>
-#include <QtAlgorithms>
+#include <qset.h>
+#include <qvector.h>
 
-
-//! Compare the two items \a pcItem1 and \a pcItem2 in the list.
-static bool compareDiveLogItems(const DiveLog* pcLog1, const DiveLog* pcLog2)
-{
-  DBG(("compareDiveLogItems(): %d and %d => %s\n",
-       pcLog1->logNumber(), pcLog2->logNumber(),
-       pcLog1->logNumber() < pcLog2->logNumber() ? "less" : "!less"));
-  return pcLog1->logNumber() < pcLog2->logNumber();
-}
+class LocationLog;
+class ChangeTracker;
 
 
 //*****************************************************************************
@@ -35,29 +29,225 @@ static bool compareDiveLogItems(const DiveLog* pcLog1, const DiveLog* pcLog2)
   \class DiveList
   \brief The DiveList class is the list used to hold the dive logs.
 
-  This class is basically a wrapper around a QList.
+  The list owns its dive logs. They are allocated from slabs holding
+  many logs each, so a big log book needs one allocation for every
+  #e_LogsPerSlab logs rather than one for every log. The slabs never move,
+  so a DiveLog pointer stays valid until the log is deleted with
+  deleteLog(), or the list is destroyed. Deleted logs are put on a free
+  list, and their memory is reused by later calls to newLog().
+
+  A log is created with newLog() and then added with append(); a log that
+  isn't appended must be passed to deleteLog().
+
+  The list keeps an index from log numbers to logs, which is updated when
+  logs are appended or deleted, and when a log in the list changes its
+  number. findLog() uses it to find a log in constant time.
+
+  Each log in the list also knows its own position, which is kept up to
+  date when logs are deleted and when the list is sorted. This makes
+  indexOf(), previousLog() and nextLog() constant time, so stepping
+  through a big log book doesn't search the list for every step.
+
+  Besides the list order, the logs can be viewed sorted on a few other
+  keys with sortedLogs(). A view is sorted the first time it is asked
+  for, and after that it is kept sorted as logs are added, deleted and
+  edited, without touching the list itself. Views nobody asked for cost
+  nothing, so loading a log book doesn't pay for them.
+
+  The list keeps running totals of the dive time and gas used, updated as
+  logs are appended, deleted and edited, so totalDiveTime() and
+  totalGasUsed() take the same time whatever the size of the list.
+  deepestLog() uses the sorted view of the maximum depth.
+
+  A whole log book can be renumbered with setLogNumbers(), which updates
+  the index and sorts the list once for all the logs, rather than once for
+  every log as setting the numbers one by one would. checkNumbering() finds
+  gaps and duplicates in the numbers.
+  Likewise, deleteLogs() deletes many logs with one pass over the list.
+
+  The list also links each log to the location log with the same name as
+  its location, and keeps the list of logs at each location; see
+  LocationLog::dives(). The locations are given with setLocations() and
+  addLocation(). A linked log gets its location name from the location
+  log, so renameLocation() doesn't have to touch the logs. Logs whose
+  location has no location log are indexed by name, so adding or renaming
+  a location only touches the logs it links.
+
+  If a change tracker is set, logs that are appended, deleted or changed
+  are reported to it.
+
+  When the list is destroyed, the logs are destroyed and the slabs are
+  freed in one go.
 
   \author André Hübert Johansen
 */
 //*****************************************************************************
 
-class DiveList : public QList<DiveLog*> {
+class DiveList {
 public:
-  //! Initialise the list.
-  DiveList() : QList<DiveLog*>() {
-    DBG(("DiveList::DiveList()\n"));
+  //! Iterator over the logs in the list.
+  typedef QVector<DiveLog*>::const_iterator const_iterator;
+
+  //! The keys the logs can be sorted on by sortedLogs().
+  enum SortKey_e {
+    //! The dive date and start time.
+    e_ByDate,
+    //! The location, ignoring case.
+    e_ByLocation,
+    //! The maximum depth.
+    e_ByMaxDepth,
+    //! The dive time (duration).
+    e_ByDiveTime,
+    //! The number of keys.
+    e_NumSortKeys
+  };
+
+  DiveList();
+  ~DiveList();
+
+  //! Get the number of logs in the list.
+  int count() const { return m_apcLogs.count(); }
+  //! Get the number of logs in the list.
+  int size() const { return m_apcLogs.count(); }
+  //! Returns `true' if the list is empty.
+  bool isEmpty() const { return m_apcLogs.isEmpty(); }
+  //! Get the log at the position \a nIndex.
+  DiveLog* at(int nIndex) const { return m_apcLogs.at(nIndex); }
+  //! Get the first log, or 0 if the list is empty.
+  DiveLog* first() const { return isEmpty() ? 0 : m_apcLogs.first(); }
+  //! Get the last log, or 0 if the list is empty.
+  DiveLog* last() const { return isEmpty() ? 0 : m_apcLogs.last(); }
+  //! Get the position of \a pcLog in the list, or -1 if it isn't found.
+  int indexOf(const DiveLog* pcLog) const {
+    return ( pcLog && this == pcLog->m_pcOwner ) ? pcLog->m_nListIndex : -1;
   }
+  DiveLog* previousLog(const DiveLog* pcLog) const;
+  DiveLog* nextLog(const DiveLog* pcLog) const;
+  //! Get an iterator to the first log.
+  const_iterator begin() const { return m_apcLogs.constBegin(); }
+  //! Get an iterator past the last log.
+  const_iterator end() const { return m_apcLogs.constEnd(); }
+  //! Get the logs, in list order.
+  const QVector<DiveLog*>& logs() const { return m_apcLogs; }
+  const QVector<DiveLog*>& sortedLogs(SortKey_e eKey) const;
+  QVector<DiveLog*> sortedLogs(SortKey_e eKey,
+                               const QVector<int>& anIndices) const;
 
-  void sort()
-  {
-    std::sort(this->begin(), this->end(), compareDiveLogItems);
+  //! Returns `true' if a log in the list has the log number \a nLogNumber.
+  bool hasLogNumber(int nLogNumber) const {
+    return m_cLogNumbers.contains(nLogNumber);
   }
+  //! Get the log with the number \a nLogNumber, or 0 if there is none.
+  DiveLog* findLog(int nLogNumber) const {
+    return m_cLogNumbers.value(nLogNumber, 0);
+  }
+  //! Get the logs with the number \a nLogNumber.
+  QList<DiveLog*> logsNumbered(int nLogNumber) const {
+    return m_cLogNumbers.values(nLogNumber);
+  }
+  int nextLogNumber() const;
+  void checkNumbering(int& nGaps, int& nDuplicates) const;
+  void setLogNumbers(const QVector<DiveLog*>& apcLogs,
+                     const QVector<int>& anNumbers);
+
+  //! Get the total dive time of the logs, in seconds.
+  qint64 totalDiveTime() const { return m_nTotalDiveTime; }
+  //! Get the total gas used on the dives, in litres.
+  qint64 totalGasUsed() const { return m_nTotalGasUsed; }
+  DiveLog* deepestLog() const;
+
+  //! Get the location log named \a cName, or 0 if there is none.
+  LocationLog* findLocation(const QString& cName) const {
+    return m_cLocations.value(cName, 0);
+  }
+  void setLocations(const QList<LocationLog*>& cLocations);
+  void addLocation(LocationLog* pcLocation);
+  void removeLocation(LocationLog* pcLocation);
+  bool renameLocation(LocationLog* pcLocation, const QString& cName);
+  QVector<DiveLog*> logsAtLocation(const QString& cName) const;
+
+  DiveLog* newLog();
+  bool append(DiveLog* pcLog);
+  void deleteLog(DiveLog* pcLog);
+  void deleteLogs(const QVector<DiveLog*>& apcLogs);
+  void clear();
+  void sort();
+
+  //! Get the change tracker, or 0 if there is none.
+  ChangeTracker* changeTracker() const { return m_pcTracker; }
+  //! Report changes to \a pcTracker, or to nobody if it is 0.
+  void setChangeTracker(ChangeTracker* pcTracker) { m_pcTracker = pcTracker; }
+
+  //! Get the number of slabs allocated.
+  int numSlabs() const { return m_apvSlabs.count(); }
 
 private:
+  friend class DiveLog;
+
   //! Disabled copy constructor.
   DiveList(const DiveList&);
   //! Disabled assignment operator.
   DiveList& operator =(const DiveList&);
+
+  //! The number of logs in each slab.
+  enum { e_LogsPerSlab = 256 };
+  //! A key mask bit for the values summed in the totals, other than
+  //! the dive time; it has no sorted view.
+  enum { e_TotalsKey = 1 << e_NumSortKeys };
+  //! A key mask with all the sort keys and the totals.
+  enum { e_AllKeys = (e_TotalsKey << 1) - 1 };
+  //! The keys the totals are summed from.
+  enum { e_TotalsKeys = (1 << e_ByDiveTime) | e_TotalsKey };
+
+  //! A free log slot; the memory of a deleted log is reused for this.
+  struct FreeSlot {
+    //! The next free slot, or 0.
+    FreeSlot* pcNext;
+  };
+
+  void allocateSlab();
+  void destroyLog(DiveLog* pcLog);
+  void updateListIndices(int nFirstIndex);
+  void logNumberChanged(DiveLog* pcLog, int nOldNumber);
+  void numberAdded(int nLogNumber);
+  void numberRemoved(int nLogNumber);
+  void keysAboutToChange(DiveLog* pcLog, int nKeyMask);
+  void keysChanged(DiveLog* pcLog, int nKeyMask);
+  void logChanged(DiveLog* pcLog);
+  void addTotals(const DiveLog* pcLog, int nSign);
+  void linkLocation(DiveLog* pcLog);
+  void unlinkLocation(DiveLog* pcLog);
+  void attachLocation(DiveLog* pcLog, LocationLog* pcLocation);
+  void detachLocation(DiveLog* pcLog);
+  void indexLocation(LocationLog* pcLocation);
+  void releaseDives(LocationLog* pcLocation);
+
+  //! The logs, in list order.
+  QVector<DiveLog*> m_apcLogs;
+  //! The logs, indexed by log number. Duplicate numbers have several entries.
+  QMultiHash<int, DiveLog*> m_cLogNumbers;
+  //! The highest log number in use, or 0; valid if #m_isHighestNumberValid.
+  mutable int       m_nHighestNumber;
+  //! Set when #m_nHighestNumber is known.
+  mutable bool      m_isHighestNumberValid;
+  //! The sorted views, valid for the keys set in #m_nSortedKeys.
+  mutable QVector<DiveLog*> m_aapcSorted[e_NumSortKeys];
+  //! The keys with a valid view, as a mask of (1 << key).
+  mutable int       m_nSortedKeys;
+  //! The location logs, indexed by name.
+  QHash<QString, LocationLog*> m_cLocations;
+  //! The logs not linked to a location log, indexed by location name.
+  QHash<QString, QSet<DiveLog*> > m_cUnlinked;
+  //! The sum of the dive times of the logs, in seconds.
+  qint64            m_nTotalDiveTime;
+  //! The sum of the gas used on the dives, in litres.
+  qint64            m_nTotalGasUsed;
+  //! The change tracker, or 0.
+  ChangeTracker*    m_pcTracker;
+  //! The slabs the logs are allocated from.
+  QVector<void*>    m_apvSlabs;
+  //! The first free slot, or 0.
+  FreeSlot*         m_pcFreeSlots;
 };
 
 #endif // DIVELIST_H
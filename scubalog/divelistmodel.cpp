@@ -0,0 +1,1055 @@
+//*****************************************************************************
+/*!
+  \file divelistmodel.cpp
+  \brief This file contains the implementation of the DiveListModel class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "divelistmodel.h"
+#include "divelist.h"
+#include "changetracker.h"
+#include <KLocalizedString>
+#include <qlocale.h>
+#include <qset.h>
+#include <algorithm>
+#include <assert.h>
+
+
+/**
+ * The number of changed logs above which the whole table is refreshed
+ * with one signal rather than a signal per row.
+ */
+
+static const int s_nMaxRowUpdates = 64;
+
+
+/**
+ * Remove the logs in \a cLogs from \a apcLogs, keeping the order of the rest.
+ */
+
+static void
+removeLogs(QVector<DiveLog*>& apcLogs, const QSet<DiveLog*>& cLogs)
+{
+  int nKept = 0;
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog ) {
+    DiveLog* pcLog = apcLogs.at(iLog);
+    if ( false == cLogs.contains(pcLog) )
+      apcLogs[nKept++] = pcLog;
+  }
+  apcLogs.resize(nKept);
+}
+
+
+//*****************************************************************************
+/*!
+  \brief Orders logs on the precomputed sort keys of one column.
+
+  The keys are indexed by the list position of the logs. Logs with equal
+  keys are kept in list order, whichever the sort order.
+*/
+//*****************************************************************************
+
+struct RowKeyLess {
+  //! Create an ordering of the logs in \a cList on \a avNumbers, or on
+  //! \a acTexts if \a isText is `true', descending if \a isDescending.
+  RowKeyLess(const DiveList& cList, const QVector<double>& avNumbers,
+             const QVector<QString>& acTexts, bool isText, bool isDescending)
+    : m_cList(cList), m_avNumbers(avNumbers), m_acTexts(acTexts),
+      m_isText(isText), m_isDescending(isDescending) {}
+
+  //! Returns `true' if \a pcLog1 is ordered before \a pcLog2.
+  bool operator ()(const DiveLog* pcLog1, const DiveLog* pcLog2) const {
+    const int nIndex1 = m_cList.indexOf(pcLog1);
+    const int nIndex2 = m_cList.indexOf(pcLog2);
+    int nOrder = 0;
+    if ( m_isText )
+      nOrder = QString::compare(m_acTexts.at(nIndex1), m_acTexts.at(nIndex2));
+    else if ( m_avNumbers.at(nIndex1) != m_avNumbers.at(nIndex2) )
+      nOrder = m_avNumbers.at(nIndex1) < m_avNumbers.at(nIndex2) ? -1 : 1;
+    if ( nOrder )
+      return m_isDescending ? nOrder > 0 : nOrder < 0;
+    return nIndex1 < nIndex2;
+  }
+
+  //! The list of the logs.
+  const DiveList&         m_cList;
+  //! The keys of a number column.
+  const QVector<double>&  m_avNumbers;
+  //! The keys of a text column.
+  const QVector<QString>& m_acTexts;
+  //! Set if the text keys are used.
+  bool                    m_isText;
+  //! Set to sort in descending order.
+  bool                    m_isDescending;
+};
+
+
+//*****************************************************************************
+/*!
+  Create an empty model, with \a pcParent as the parent object.
+*/
+//*****************************************************************************
+
+DiveListModel::DiveListModel(QObject* pcParent)
+  : QAbstractTableModel(pcParent),
+    m_pcDiveList(0),
+    m_pcTracker(0),
+    m_nRowCount(0),
+    m_nSortColumn(-1),
+    m_eSortOrder(Qt::AscendingOrder),
+    m_isSearchTextValid(false),
+    m_nHandledGeneration(0)
+{
+  invalidateKeys();
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the model. The dive list is not touched.
+*/
+//*****************************************************************************
+
+DiveListModel::~DiveListModel()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Show the logs in \a pcDiveList, or nothing if it is 0.
+  The model doesn't own the list.
+
+  The sort column and filter are kept. Unless there are any, this takes
+  the same time whatever the size of the list.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::setDiveList(DiveList* pcDiveList)
+{
+  beginResetModel();
+  if ( m_pcTracker )
+    disconnect(m_pcTracker, 0, this, 0);
+  m_pcDiveList = pcDiveList;
+  m_pcTracker = pcDiveList ? pcDiveList->changeTracker() : 0;
+  if ( m_pcTracker ) {
+    connect(m_pcTracker, SIGNAL(changed()), SLOT(logBookChanged()));
+    connect(m_pcTracker, SIGNAL(reorderingLogs()), SLOT(reorderingLogs()));
+    connect(m_pcTracker, SIGNAL(reorderedLogs()), SLOT(reorderedLogs()));
+  }
+  m_nRowCount = pcDiveList ? pcDiveList->count() : 0;
+  invalidateKeys();
+  rebuildRows();
+  markHandled();
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the log shown at \a cIndex, or 0 if there is none.
+*/
+//*****************************************************************************
+
+DiveLog*
+DiveListModel::log(const QModelIndex& cIndex) const
+{
+  if ( false == cIndex.isValid() )
+    return 0;
+  return rowLog(cIndex.row());
+}
+
+
+//*****************************************************************************
+/*!
+  Get the index of the cell showing column \a nColumn of \a pcLog, or an
+  invalid index if the log isn't shown.
+*/
+//*****************************************************************************
+
+QModelIndex
+DiveListModel::indexOf(const DiveLog* pcLog, int nColumn) const
+{
+  const int nRow = rowOf(pcLog);
+  if ( nRow < 0 )
+    return QModelIndex();
+  return index(nRow, nColumn);
+}
+
+
+//*****************************************************************************
+/*!
+  Append the new log \a pcLog to the list, adding a row for it.
+
+  When sorted or filtered, the row is added last, whatever its keys, so
+  the new log is shown until it is edited or the rows are rebuilt.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::appendLog(DiveLog* pcLog)
+{
+  assert(m_pcDiveList);
+  const int nRow = rowCount();
+  beginInsertRows(QModelIndex(), nRow, nRow);
+  m_pcDiveList->append(pcLog);
+  m_nRowCount = m_pcDiveList->count();
+  // The other logs keep their positions, so the keys are just extended
+  const int nIndex = m_nRowCount - 1;
+  for ( int iColumn = 0; iColumn < e_NumColumns; ++iColumn ) {
+    ColumnKeys& cKeys = m_acKeys[iColumn];
+    if ( false == cKeys.isValid )
+      continue;
+    if ( isTextColumn(iColumn) )
+      cKeys.acTexts.resize(m_nRowCount);
+    else
+      cKeys.avNumbers.resize(m_nRowCount);
+    setKey(iColumn, nIndex);
+  }
+  if ( m_isSearchTextValid ) {
+    m_acSearchTexts.resize(m_nRowCount);
+    setSearchText(nIndex);
+  }
+  if ( false == isListOrder() ) {
+    m_apcSorted.append(pcLog);
+    m_apcRows.append(pcLog);
+  }
+  endInsertRows();
+}
+
+
+//*****************************************************************************
+/*!
+  Delete the log \a pcLog from the list, removing its row.
+
+  The list positions of the logs after it change, so the sort keys and
+  search texts are dropped, to be built again when next needed.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::deleteLog(DiveLog* pcLog)
+{
+  assert(m_pcDiveList);
+  const int nRow = rowOf(pcLog);
+  if ( nRow >= 0 )
+    beginRemoveRows(QModelIndex(), nRow, nRow);
+  if ( false == isListOrder() ) {
+    m_apcSorted.removeOne(pcLog);
+    if ( nRow >= 0 )
+      m_apcRows.remove(nRow);
+  }
+  m_pcDiveList->deleteLog(pcLog);
+  m_nRowCount = m_pcDiveList->count();
+  invalidateKeys();
+  markHandled();
+  if ( nRow >= 0 )
+    endRemoveRows();
+}
+
+
+//*****************************************************************************
+/*!
+  Delete the logs \a apcLogs from the list, removing their rows.
+
+  The logs are deleted from the list together, and the model is reset
+  once, so the view is refreshed once however many logs are deleted.
+  The rows left keep their order, without being sorted or filtered again.
+  The batch the change tracker sends for the deletion is then skipped.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::deleteLogs(const QVector<DiveLog*>& apcLogs)
+{
+  assert(m_pcDiveList);
+  if ( apcLogs.isEmpty() )
+    return;
+  beginResetModel();
+  if ( false == isListOrder() ) {
+    QSet<DiveLog*> cLogs;
+    cLogs.reserve(apcLogs.count());
+    for ( int iLog = 0; iLog < apcLogs.count(); ++iLog )
+      cLogs.insert(apcLogs.at(iLog));
+    removeLogs(m_apcSorted, cLogs);
+    removeLogs(m_apcRows, cLogs);
+  }
+  m_pcDiveList->deleteLogs(apcLogs);
+  m_nRowCount = m_pcDiveList->count();
+  invalidateKeys();
+  markHandled();
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number of rows; the number of logs shown.
+*/
+//*****************************************************************************
+
+int
+DiveListModel::rowCount(const QModelIndex& cParent) const
+{
+  if ( cParent.isValid() )
+    return 0;
+  return isListOrder() ? m_nRowCount : m_apcRows.count();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number of columns.
+*/
+//*****************************************************************************
+
+int
+DiveListModel::columnCount(const QModelIndex& cParent) const
+{
+  return cParent.isValid() ? 0 : e_NumColumns;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the data of \a cIndex for the role \a nRole, read from the log.
+*/
+//*****************************************************************************
+
+QVariant
+DiveListModel::data(const QModelIndex& cIndex, int nRole) const
+{
+  const DiveLog* pcLog = log(cIndex);
+  if ( 0 == pcLog || Qt::DisplayRole != nRole )
+    return QVariant();
+
+  switch ( cIndex.column() ) {
+  case e_LogNumber: return pcLog->logNumber();
+  case e_DiveDate:  return pcLog->diveDate();
+  case e_DiveStart: return pcLog->diveStart();
+  default:          return cellText(*pcLog, cIndex.column());
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Get the title of the column \a nSection.
+*/
+//*****************************************************************************
+
+QVariant
+DiveListModel::headerData(int nSection, Qt::Orientation eOrientation,
+                          int nRole) const
+{
+  if ( Qt::Horizontal != eOrientation || Qt::DisplayRole != nRole )
+    return QVariant();
+
+  switch ( nSection ) {
+  case e_LogNumber:    return i18n("Dive");
+  case e_DiveDate:     return i18n("Date");
+  case e_DiveStart:    return i18n("Time");
+  case e_DiveLocation: return i18n("Location");
+  case e_MaxDepth:     return i18n("Depth");
+  case e_BuddyName:    return i18n("Buddy");
+  case e_DiveType:     return i18n("Type");
+  default:             return QVariant();
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Sort the rows on the column \a nColumn in the order \a eOrder.
+  If \a nColumn is -1, the rows are shown in list order.
+
+  The keys of the column are built the first time it is sorted on.
+  Only the order of the rows changes, so the selection is kept.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::sort(int nColumn, Qt::SortOrder eOrder)
+{
+  if ( nColumn < 0 || nColumn >= e_NumColumns )
+    nColumn = -1;
+  if ( nColumn == m_nSortColumn && (nColumn < 0 || eOrder == m_eSortOrder) )
+    return;
+
+  emit layoutAboutToBeChanged();
+  rememberLayout();
+  m_nSortColumn = nColumn;
+  m_eSortOrder = eOrder;
+  if ( isListOrder() ) {
+    m_apcSorted.clear();
+    m_apcRows.clear();
+  }
+  else {
+    // The search texts are built, so filtering the sorted logs is cheap
+    sortRows();
+    filterRows(m_apcSorted);
+  }
+  restoreLayout();
+  emit layoutChanged();
+}
+
+
+//*****************************************************************************
+/*!
+  Show only the logs with \a cText in one of their cells, ignoring case
+  and leading and trailing white space, or all logs if \a cText is empty.
+
+  If the new filter contains the old one, only the rows already shown are
+  searched, and the rows that no longer match are removed, a run at
+  a time. Otherwise the rows are built again as a layout change. Either
+  way the current and selected logs are kept if they are still shown.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::setFilter(const QString& cText)
+{
+  const QString cFilter = cText.trimmed().toLower();
+  if ( cFilter == m_cFilter )
+    return;
+
+  const bool isNarrowing =
+    false == m_cFilter.isEmpty() && cFilter.contains(m_cFilter);
+  if ( isNarrowing ) {
+    m_cFilter = cFilter;
+    removeUnmatchedRows();
+    return;
+  }
+
+  const bool wasListOrder = isListOrder();
+  emit layoutAboutToBeChanged();
+  rememberLayout();
+  m_cFilter = cFilter;
+  if ( isListOrder() ) {
+    m_apcSorted.clear();
+    m_apcRows.clear();
+  }
+  else {
+    if ( wasListOrder )
+      sortRows();
+    filterRows(m_apcSorted);
+  }
+  restoreLayout();
+  emit layoutChanged();
+}
+
+
+//*****************************************************************************
+/*!
+  The log book has changed. Update the rows of the logs changed, or the
+  whole table if many logs changed. If logs have been added or deleted
+  other than through this model, reset it.
+
+  Of the changes to anything but the logs, only the location names are
+  shown, so the logs at a location added, renamed or removed are updated
+  as if they were changed. The other changes are ignored.
+
+  When sorted or filtered, the keys and search texts of the logs changed
+  are updated. If that moves a log, or changes whether it matches the
+  filter, the rows are rebuilt and the model reset. If many logs changed,
+  or the keys were dropped when a log was deleted, everything is built
+  again.
+
+  If nothing has changed since the model updated itself, as when logs
+  were deleted through it, the batch is skipped, so the view isn't
+  refreshed twice.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::logBookChanged()
+{
+  if ( 0 == m_pcDiveList || m_pcTracker->generation() == m_nHandledGeneration )
+    return;
+
+  if ( m_pcDiveList->count() != m_nRowCount ) {
+    beginResetModel();
+    m_nRowCount = m_pcDiveList->count();
+    invalidateKeys();
+    rebuildRows();
+    endResetModel();
+    return;
+  }
+  if ( 0 == m_nRowCount )
+    return;
+
+  QSet<DiveLog*> cLogs = m_pcTracker->changedLogs();
+  const QSet<QString>& cNames = m_pcTracker->changedLocationNames();
+  QSet<QString>::const_iterator iName = cNames.constBegin();
+  for ( ; iName != cNames.constEnd(); ++iName ) {
+    const QVector<DiveLog*> apcAt = m_pcDiveList->logsAtLocation(*iName);
+    for ( int iLog = 0; iLog < apcAt.count(); ++iLog )
+      cLogs.insert(apcAt.at(iLog));
+  }
+  if ( cLogs.isEmpty() )
+    return;
+
+  const bool isStale = false == isListOrder() &&
+    ((m_nSortColumn >= 0 && false == m_acKeys[m_nSortColumn].isValid) ||
+     (false == m_cFilter.isEmpty() && false == m_isSearchTextValid));
+  if ( isStale || cLogs.count() > s_nMaxRowUpdates ) {
+    invalidateKeys();
+    if ( isListOrder() ) {
+      emit dataChanged(index(0, 0), index(m_nRowCount - 1, e_NumColumns - 1));
+    }
+    else {
+      beginResetModel();
+      rebuildRows();
+      endResetModel();
+    }
+    return;
+  }
+
+  bool isMoved = false;
+  QSet<DiveLog*>::const_iterator iLog = cLogs.constBegin();
+  for ( ; iLog != cLogs.constEnd(); ++iLog ) {
+    if ( updateLog(*iLog) )
+      isMoved = true;
+  }
+  if ( isMoved ) {
+    beginResetModel();
+    sortRows();
+    filterRows(m_apcSorted);
+    endResetModel();
+    return;
+  }
+  for ( iLog = cLogs.constBegin(); iLog != cLogs.constEnd(); ++iLog ) {
+    const QModelIndex cFirst = indexOf(*iLog);
+    if ( cFirst.isValid() )
+      emit dataChanged(cFirst, indexOf(*iLog, e_NumColumns - 1));
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  The logs are about to be reordered in the list, as when they are
+  renumbered. Remember which log each persistent index is at, so the
+  current and selected logs are kept when the rows move.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::reorderingLogs()
+{
+  emit layoutAboutToBeChanged();
+  rememberLayout();
+}
+
+
+//*****************************************************************************
+/*!
+  The logs have been reordered in the list. The keys are by list position,
+  so they are dropped, and the rows are built again and the persistent
+  indexes moved to the rows of their logs.
+
+  This is done before the change tracker sends its batch, so the rows are
+  never left mapped to the old positions.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::reorderedLogs()
+{
+  invalidateKeys();
+  rebuildRows();
+  restoreLayout();
+  markHandled();
+  emit layoutChanged();
+}
+
+
+//*****************************************************************************
+/*!
+  The model is up to date with the log book, so the changes made so far
+  needn't be handled again when the change tracker sends its batch.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::markHandled()
+{
+  if ( m_pcTracker )
+    m_nHandledGeneration = m_pcTracker->generation();
+}
+
+
+//*****************************************************************************
+/*!
+  Remember the log at each persistent index, before the rows are moved.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::rememberLayout()
+{
+  m_cLayoutIndexes = persistentIndexList();
+  m_apcLayoutLogs.clear();
+  m_apcLayoutLogs.reserve(m_cLayoutIndexes.count());
+  for ( int iIndex = 0; iIndex < m_cLayoutIndexes.count(); ++iIndex )
+    m_apcLayoutLogs.append(log(m_cLayoutIndexes.at(iIndex)));
+}
+
+
+//*****************************************************************************
+/*!
+  Move the persistent indexes remembered by rememberLayout() to the rows
+  their logs are shown in now.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::restoreLayout()
+{
+  QModelIndexList cNewIndexes;
+  for ( int iIndex = 0; iIndex < m_cLayoutIndexes.count(); ++iIndex )
+    cNewIndexes.append(indexOf(m_apcLayoutLogs.at(iIndex),
+                               m_cLayoutIndexes.at(iIndex).column()));
+  changePersistentIndexList(m_cLayoutIndexes, cNewIndexes);
+  m_cLayoutIndexes.clear();
+  m_apcLayoutLogs.clear();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the log shown in the row \a nRow, or 0 if there is none.
+*/
+//*****************************************************************************
+
+DiveLog*
+DiveListModel::rowLog(int nRow) const
+{
+  if ( nRow < 0 )
+    return 0;
+  if ( isListOrder() ) {
+    if ( 0 == m_pcDiveList || nRow >= m_nRowCount ||
+         nRow >= m_pcDiveList->count() )
+      return 0;
+    return m_pcDiveList->at(nRow);
+  }
+  return nRow < m_apcRows.count() ? m_apcRows.at(nRow) : 0;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the row showing \a pcLog, or -1 if it isn't shown.
+
+  When sorted or filtered, the rows are searched, which takes time in
+  proportion to the number of rows shown.
+*/
+//*****************************************************************************
+
+int
+DiveListModel::rowOf(const DiveLog* pcLog) const
+{
+  if ( 0 == m_pcDiveList || 0 == pcLog )
+    return -1;
+  if ( isListOrder() ) {
+    const int nRow = m_pcDiveList->indexOf(pcLog);
+    return nRow < m_nRowCount ? nRow : -1;
+  }
+  return m_apcRows.indexOf(const_cast<DiveLog*>(pcLog));
+}
+
+
+//*****************************************************************************
+/*!
+  Returns `true' if the column \a nColumn is sorted as text.
+*/
+//*****************************************************************************
+
+bool
+DiveListModel::isTextColumn(int nColumn)
+{
+  return e_DiveLocation == nColumn || e_BuddyName == nColumn ||
+    e_DiveType == nColumn;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the text of the column \a nColumn of the log \a cLog, as shown.
+*/
+//*****************************************************************************
+
+QString
+DiveListModel::cellText(const DiveLog& cLog, int nColumn)
+{
+  switch ( nColumn ) {
+  case e_LogNumber:
+    return QString::number(cLog.logNumber());
+  case e_DiveDate:
+    return QLocale().toString(cLog.diveDate(), QLocale::ShortFormat);
+  case e_DiveStart:
+    return QLocale().toString(cLog.diveStart(), QLocale::ShortFormat);
+  case e_DiveLocation:
+    return cLog.diveLocation();
+  case e_MaxDepth:
+    return QString::asprintf("%.2f", cLog.maxDepth());
+  case e_BuddyName:
+    return cLog.buddyName();
+  case e_DiveType:
+    return cLog.diveType();
+  default:
+    return QString();
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Get the key of the sorted view of the dive list ordered like the column
+  \a nColumn, as a DiveList::SortKey_e, or -1 if the list has no such view.
+*/
+//*****************************************************************************
+
+int
+DiveListModel::listSortKey(int nColumn)
+{
+  switch ( nColumn ) {
+  case e_DiveDate:     return DiveList::e_ByDate;
+  case e_DiveLocation: return DiveList::e_ByLocation;
+  case e_MaxDepth:     return DiveList::e_ByMaxDepth;
+  default:             return -1;
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Set the sort key of the column \a nColumn for the log at the list
+  position \a nIndex. The keys of the column must have room for it.
+
+  The date column is ordered on the date and then the start time.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::setKey(int nColumn, int nIndex)
+{
+  const DiveLog* pcLog = m_pcDiveList->at(nIndex);
+  ColumnKeys& cKeys = m_acKeys[nColumn];
+  switch ( nColumn ) {
+  case e_LogNumber:
+    cKeys.avNumbers[nIndex] = pcLog->logNumber();
+    break;
+  case e_DiveDate:
+    cKeys.avNumbers[nIndex] = pcLog->diveDate().toJulianDay() * 86400.0 +
+      pcLog->diveStart().msecsSinceStartOfDay() / 1000.0;
+    break;
+  case e_DiveStart:
+    cKeys.avNumbers[nIndex] = pcLog->diveStart().msecsSinceStartOfDay();
+    break;
+  case e_MaxDepth:
+    cKeys.avNumbers[nIndex] = pcLog->maxDepth();
+    break;
+  case e_DiveLocation:
+    cKeys.acTexts[nIndex] = pcLog->diveLocation().toCaseFolded();
+    break;
+  case e_BuddyName:
+    cKeys.acTexts[nIndex] = pcLog->buddyName().toCaseFolded();
+    break;
+  case e_DiveType:
+    cKeys.acTexts[nIndex] = pcLog->diveType().toCaseFolded();
+    break;
+  default:
+    break;
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Build the sort keys of the column \a nColumn for all the logs.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::buildKeys(int nColumn)
+{
+  ColumnKeys& cKeys = m_acKeys[nColumn];
+  const int nCount = m_pcDiveList->count();
+  if ( isTextColumn(nColumn) )
+    cKeys.acTexts.resize(nCount);
+  else
+    cKeys.avNumbers.resize(nCount);
+  for ( int iLog = 0; iLog < nCount; ++iLog )
+    setKey(nColumn, iLog);
+  cKeys.isValid = true;
+}
+
+
+//*****************************************************************************
+/*!
+  Set the search text of the log at the list position \a nIndex; the
+  lower case text of its cells, one per line.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::setSearchText(int nIndex)
+{
+  const DiveLog& cLog = *m_pcDiveList->at(nIndex);
+  QString cText;
+  for ( int iColumn = 0; iColumn < e_NumColumns; ++iColumn ) {
+    if ( iColumn )
+      cText += '\n';
+    cText += cellText(cLog, iColumn);
+  }
+  m_acSearchTexts[nIndex] = cText.toLower();
+}
+
+
+//*****************************************************************************
+/*!
+  Build the search texts of all the logs.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::buildSearchTexts()
+{
+  const int nCount = m_pcDiveList->count();
+  m_acSearchTexts.resize(nCount);
+  for ( int iLog = 0; iLog < nCount; ++iLog )
+    setSearchText(iLog);
+  m_isSearchTextValid = true;
+}
+
+
+//*****************************************************************************
+/*!
+  Returns `true' if the log at the list position \a nIndex matches the
+  filter. The search texts must be built.
+*/
+//*****************************************************************************
+
+bool
+DiveListModel::isMatch(int nIndex) const
+{
+  return m_acSearchTexts.at(nIndex).contains(m_cFilter);
+}
+
+
+//*****************************************************************************
+/*!
+  Drop the sort keys and search texts, as the list positions of the logs
+  have changed. They are built again when next needed.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::invalidateKeys()
+{
+  for ( int iColumn = 0; iColumn < e_NumColumns; ++iColumn ) {
+    ColumnKeys& cKeys = m_acKeys[iColumn];
+    cKeys.isValid = false;
+    cKeys.avNumbers.clear();
+    cKeys.acTexts.clear();
+  }
+  m_isSearchTextValid = false;
+  m_acSearchTexts.clear();
+}
+
+
+//*****************************************************************************
+/*!
+  Sort \a apcLogs, which must be in the list, on the sort column.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::sortLogs(QVector<DiveLog*>& apcLogs)
+{
+  if ( 0 == m_pcDiveList )
+    return;
+  static const QVector<double> avNone;
+  static const QVector<QString> acNone;
+  if ( m_nSortColumn < 0 ) {
+    std::sort(apcLogs.begin(), apcLogs.end(),
+              RowKeyLess(*m_pcDiveList, avNone, acNone, false, false));
+    return;
+  }
+  if ( false == m_acKeys[m_nSortColumn].isValid )
+    buildKeys(m_nSortColumn);
+  const ColumnKeys& cKeys = m_acKeys[m_nSortColumn];
+  std::sort(apcLogs.begin(), apcLogs.end(),
+            RowKeyLess(*m_pcDiveList, cKeys.avNumbers, cKeys.acTexts,
+                       isTextColumn(m_nSortColumn),
+                       Qt::DescendingOrder == m_eSortOrder));
+}
+
+
+//*****************************************************************************
+/*!
+  Set all the logs, sorted on the sort column, as the sorted logs.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::sortRows()
+{
+  if ( 0 == m_pcDiveList ) {
+    m_apcSorted.clear();
+    return;
+  }
+  const int nKey = m_nSortColumn < 0 ? -1 : listSortKey(m_nSortColumn);
+  if ( nKey < 0 ) {
+    m_apcSorted = m_pcDiveList->logs();
+    if ( m_nSortColumn >= 0 )
+      sortLogs(m_apcSorted);
+    return;
+  }
+
+  // The list keeps this view sorted, so it is just copied. The keys are
+  // still built, to tell when an edit moves a log.
+  if ( false == m_acKeys[m_nSortColumn].isValid )
+    buildKeys(m_nSortColumn);
+  m_apcSorted =
+    m_pcDiveList->sortedLogs(static_cast<DiveList::SortKey_e>(nKey));
+  if ( Qt::DescendingOrder == m_eSortOrder )
+    std::reverse(m_apcSorted.begin(), m_apcSorted.end());
+}
+
+
+//*****************************************************************************
+/*!
+  Show the logs in \a apcLogs that match the filter, in the same order.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::filterRows(const QVector<DiveLog*>& apcLogs)
+{
+  if ( m_cFilter.isEmpty() || 0 == m_pcDiveList ) {
+    m_apcRows = apcLogs;
+    return;
+  }
+  if ( false == m_isSearchTextValid )
+    buildSearchTexts();
+  m_apcRows.clear();
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog ) {
+    DiveLog* pcLog = apcLogs.at(iLog);
+    if ( isMatch(m_pcDiveList->indexOf(pcLog)) )
+      m_apcRows.append(pcLog);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the rows that don't match the filter, which has been narrowed.
+  The rows are removed a run at a time from the end, so the rows before
+  each run keep their numbers, and the view is told before each run goes.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::removeUnmatchedRows()
+{
+  if ( false == m_isSearchTextValid )
+    buildSearchTexts();
+  int nEnd = m_apcRows.count();
+  while ( nEnd > 0 ) {
+    int nLast = nEnd - 1;
+    while ( nLast >= 0 &&
+            isMatch(m_pcDiveList->indexOf(m_apcRows.at(nLast))) )
+      --nLast;
+    if ( nLast < 0 )
+      break;
+    int nFirst = nLast;
+    while ( nFirst > 0 &&
+            false == isMatch(m_pcDiveList->indexOf(m_apcRows.at(nFirst - 1))) )
+      --nFirst;
+    beginRemoveRows(QModelIndex(), nFirst, nLast);
+    m_apcRows.remove(nFirst, nLast - nFirst + 1);
+    endRemoveRows();
+    nEnd = nFirst;
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Sort and filter all the logs again, unless they are shown in list order.
+*/
+//*****************************************************************************
+
+void
+DiveListModel::rebuildRows()
+{
+  if ( isListOrder() ) {
+    m_apcSorted.clear();
+    m_apcRows.clear();
+    return;
+  }
+  sortRows();
+  filterRows(m_apcSorted);
+}
+
+
+//*****************************************************************************
+/*!
+  The log \a pcLog has been edited. Update its built sort keys and search
+  text. Returns `true' if its key in the sort column has changed, or it
+  has started or stopped matching the filter, so the rows must be rebuilt.
+*/
+//*****************************************************************************
+
+bool
+DiveListModel::updateLog(DiveLog* pcLog)
+{
+  const int nIndex = m_pcDiveList->indexOf(pcLog);
+  if ( nIndex < 0 )
+    return false;
+
+  bool isMoved = false;
+  for ( int iColumn = 0; iColumn < e_NumColumns; ++iColumn ) {
+    ColumnKeys& cKeys = m_acKeys[iColumn];
+    if ( false == cKeys.isValid )
+      continue;
+    if ( iColumn != m_nSortColumn ) {
+      setKey(iColumn, nIndex);
+    }
+    else if ( isTextColumn(iColumn) ) {
+      const QString cOld = cKeys.acTexts.at(nIndex);
+      setKey(iColumn, nIndex);
+      isMoved = isMoved || cOld != cKeys.acTexts.at(nIndex);
+    }
+    else {
+      const double vOld = cKeys.avNumbers.at(nIndex);
+      setKey(iColumn, nIndex);
+      isMoved = isMoved || vOld != cKeys.avNumbers.at(nIndex);
+    }
+  }
+  if ( m_isSearchTextValid ) {
+    const bool wasMatch = isMatch(nIndex);
+    setSearchText(nIndex);
+    if ( false == m_cFilter.isEmpty() && wasMatch != isMatch(nIndex) )
+      isMoved = true;
+  }
+  return isMoved;
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,194 @@
+//*****************************************************************************
+/*!
+  \file divelistmodel.h
+  \brief This file contains the definition of the DiveListModel class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef DIVELISTMODEL_H
+#define DIVELISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <qstring.h>
+#include <qvector.h>
+
+class DiveList;
+class DiveLog;
+class ChangeTracker;
+
+
+//*****************************************************************************
+/*!
+  \class DiveListModel
+  \brief The DiveListModel class is a table model of a dive list.
+
+  There is one row per log shown. Unless the model is sorted or filtered,
+  the rows are in list order, and the cells are read from the logs when
+  the view asks for them, so nothing is built per log, and setting a list
+  takes the same time whatever its size; the view only asks for the rows
+  it shows.
+
+  The model can be sorted on any column with sort(). The sort key of each
+  log is computed once per column and kept, indexed by list position, so
+  sorting compares numbers and case folded strings, not logs. A column's
+  keys are kept until a log is deleted, and are updated for just the logs
+  changed when they are edited.
+
+  The date, location and depth columns are sorted by copying the sorted
+  view the dive list keeps of them, see DiveList::sortedLogs(), rather
+  than sorting again; their keys are only used to tell when an edit moves
+  a log.
+
+  setFilter() shows only the logs with the filter text in one of their
+  cells. The lower case text of the cells of each log is built the first
+  time a filter is set. A filter that contains the previous one can only
+  match fewer logs, so then only the rows shown are searched again, and
+  the rows that no longer match are removed; typing a filter narrows the
+  rows a key at a time instead of searching the whole log book for every
+  key, and keeps the selection.
+
+  Logs should be added and deleted through appendLog(), deleteLog() and
+  deleteLogs(), so the view is told before the rows change. Other changes
+  are picked up from the change tracker of the list: edited logs, and the
+  logs at a location that was renamed, have their rows updated, and if
+  the number of logs has changed behind the model's back, the model is
+  reset. When sorted or filtered, an edit that moves a log or changes
+  whether it matches rebuilds the rows, and resets the model. When the list is reordered, as by renumbering, the rows are
+  rebuilt at once, as a layout change, so the current and selected logs
+  are kept.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class DiveListModel : public QAbstractTableModel {
+  Q_OBJECT
+public:
+  //! The columns.
+  enum Column_e {
+    e_LogNumber,
+    e_DiveDate,
+    e_DiveStart,
+    e_DiveLocation,
+    e_MaxDepth,
+    e_BuddyName,
+    e_DiveType,
+    e_NumColumns
+  };
+
+  DiveListModel(QObject* pcParent = 0);
+  virtual ~DiveListModel();
+
+  void setDiveList(DiveList* pcDiveList);
+  //! Get the dive list, or 0 if there is none.
+  DiveList* diveList() const { return m_pcDiveList; }
+  DiveLog* log(const QModelIndex& cIndex) const;
+  QModelIndex indexOf(const DiveLog* pcLog, int nColumn = 0) const;
+
+  void appendLog(DiveLog* pcLog);
+  void deleteLog(DiveLog* pcLog);
+  void deleteLogs(const QVector<DiveLog*>& apcLogs);
+
+  //! Get the filter, in lower case, or an empty string if there is none.
+  QString filter() const { return m_cFilter; }
+
+  virtual int rowCount(const QModelIndex& cParent = QModelIndex()) const;
+  virtual int columnCount(const QModelIndex& cParent = QModelIndex()) const;
+  virtual QVariant data(const QModelIndex& cIndex,
+                        int nRole = Qt::DisplayRole) const;
+  virtual QVariant headerData(int nSection, Qt::Orientation eOrientation,
+                              int nRole = Qt::DisplayRole) const;
+  virtual void sort(int nColumn, Qt::SortOrder eOrder = Qt::AscendingOrder);
+
+public slots:
+  void setFilter(const QString& cText);
+
+private slots:
+  void logBookChanged();
+  void reorderingLogs();
+  void reorderedLogs();
+
+private:
+  //! Disabled copy constructor.
+  DiveListModel(const DiveListModel&);
+  //! Disabled assignment operator.
+  DiveListModel& operator =(const DiveListModel&);
+
+  //! Returns `true' if the rows are the logs in list order.
+  bool isListOrder() const { return m_nSortColumn < 0 && m_cFilter.isEmpty(); }
+  DiveLog* rowLog(int nRow) const;
+  int rowOf(const DiveLog* pcLog) const;
+  static bool isTextColumn(int nColumn);
+  static int listSortKey(int nColumn);
+  static QString cellText(const DiveLog& cLog, int nColumn);
+  void setKey(int nColumn, int nIndex);
+  void buildKeys(int nColumn);
+  void setSearchText(int nIndex);
+  void buildSearchTexts();
+  bool isMatch(int nIndex) const;
+  void invalidateKeys();
+  void sortLogs(QVector<DiveLog*>& apcLogs);
+  void sortRows();
+  void filterRows(const QVector<DiveLog*>& apcLogs);
+  void removeUnmatchedRows();
+  void rebuildRows();
+  bool updateLog(DiveLog* pcLog);
+  void rememberLayout();
+  void restoreLayout();
+  void markHandled();
+
+  //! The sort keys of one column, indexed by list position.
+  struct ColumnKeys {
+    //! Set when the keys are built.
+    bool             isValid;
+    //! The keys of a number, date or time column.
+    QVector<double>  avNumbers;
+    //! The case folded keys of a text column.
+    QVector<QString> acTexts;
+  };
+
+  //! The dive list, or 0.
+  DiveList*         m_pcDiveList;
+  //! The change tracker of the dive list, or 0.
+  ChangeTracker*    m_pcTracker;
+  //! The number of logs the view has been told about.
+  int               m_nRowCount;
+  //! The column sorted on, or -1 if the rows are in list order.
+  int               m_nSortColumn;
+  //! The sort order.
+  Qt::SortOrder     m_eSortOrder;
+  //! The filter, in lower case.
+  QString           m_cFilter;
+  //! All the logs, sorted; empty when the rows are in list order.
+  QVector<DiveLog*> m_apcSorted;
+  //! The logs shown, sorted and filtered; empty when in list order.
+  QVector<DiveLog*> m_apcRows;
+  //! The sort keys of each column.
+  ColumnKeys        m_acKeys[e_NumColumns];
+  //! The lower case text of the cells of each log, by list position.
+  QVector<QString>  m_acSearchTexts;
+  //! Set when the search texts are built.
+  bool              m_isSearchTextValid;
+  //! The persistent indexes while the rows are moved.
+  QModelIndexList   m_cLayoutIndexes;
+  //! The log at each of #m_cLayoutIndexes before the rows were moved.
+  QVector<DiveLog*> m_apcLayoutLogs;
+  //! The tracker generation the model was last brought up to date at.
+  unsigned int      m_nHandledGeneration;
+};
+
+#endif // DIVELISTMODEL_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -12,6 +12,8 @@
 //*****************************************************************************
 
 #include "divelog.h"
+#include "divelist.h"
+#include "locationlog.h"
 #include "chunkio.h"
 #include <KLocalizedString>
 #include <qdatastream.h>
@@ -26,7 +28,11 @@
 //*****************************************************************************
 
 DiveLog::DiveLog()
-  : m_nLogNumber(0),
+  : m_pcOwner(0),
+    m_nListIndex(-1),
+    m_pcLocationLog(0),
+    m_nLocationSlot(-1),
+    m_nLogNumber(0),
     m_cDiveDate(QDate::currentDate()),
     m_cDiveStart(QTime()),
     m_cLocation(""),
@@ -60,6 +66,189 @@ DiveLog::~DiveLog()
 }
 
 
+//*****************************************************************************
+/*!
+  Set the log number for this dive to \a nNumber.
+  The list the log is in is told, so it can update its index.
+*/
+//*****************************************************************************
+
+void
+DiveLog::setLogNumber(int nNumber)
+{
+  if ( nNumber == m_nLogNumber )
+    return;
+
+  // The log number breaks ties in all the sorted views
+  const int nAllKeys = DiveList::e_AllKeys;
+  if ( m_pcOwner )
+    m_pcOwner->keysAboutToChange(this, nAllKeys);
+  const int nOldNumber = m_nLogNumber;
+  m_nLogNumber = nNumber;
+  if ( m_pcOwner ) {
+    m_pcOwner->logNumberChanged(this, nOldNumber);
+    m_pcOwner->keysChanged(this, nAllKeys);
+  }
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  Report a change of this log to the list it is in, if any.
+*/
+//*****************************************************************************
+
+void
+DiveLog::touch()
+{
+  if ( m_pcOwner )
+    m_pcOwner->logChanged(this);
+}
+
+
+//*****************************************************************************
+/*!
+  Set the date for this dive to \a cDate.
+*/
+//*****************************************************************************
+
+void
+DiveLog::setDiveDate(QDate cDate)
+{
+  if ( cDate == m_cDiveDate )
+    return;
+
+  if ( m_pcOwner )
+    m_pcOwner->keysAboutToChange(this, 1 << DiveList::e_ByDate);
+  m_cDiveDate = cDate;
+  if ( m_pcOwner )
+    m_pcOwner->keysChanged(this, 1 << DiveList::e_ByDate);
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  Set the start time for this dive to \a cTime.
+*/
+//*****************************************************************************
+
+void
+DiveLog::setDiveStart(QTime cTime)
+{
+  if ( cTime == m_cDiveStart )
+    return;
+
+  if ( m_pcOwner )
+    m_pcOwner->keysAboutToChange(this, 1 << DiveList::e_ByDate);
+  m_cDiveStart = cTime;
+  if ( m_pcOwner )
+    m_pcOwner->keysChanged(this, 1 << DiveList::e_ByDate);
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the dive location. When the dive is linked to a location log, this
+  is the name of that location, so renaming the location renames it here.
+*/
+//*****************************************************************************
+
+QString
+DiveLog::diveLocation() const
+{
+  return m_pcLocationLog ? m_pcLocationLog->getName() : m_cLocation;
+}
+
+
+//*****************************************************************************
+/*!
+  Set the dive location to \a cLocation.
+  If the log is in a list, the list links it to the location log with
+  that name, if there is one.
+*/
+//*****************************************************************************
+
+void
+DiveLog::setDiveLocation(const QString& cLocation)
+{
+  if ( cLocation == diveLocation() )
+    return;
+
+  if ( m_pcOwner )
+    m_pcOwner->keysAboutToChange(this, 1 << DiveList::e_ByLocation);
+  m_cLocation = cLocation;
+  if ( m_pcOwner )
+    m_pcOwner->keysChanged(this, 1 << DiveList::e_ByLocation);
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  Set the maximum depth for this dive to \a vDepth.
+*/
+//*****************************************************************************
+
+void
+DiveLog::setMaxDepth(float vDepth)
+{
+  if ( vDepth == m_vMaxDepth )
+    return;
+
+  if ( m_pcOwner )
+    m_pcOwner->keysAboutToChange(this, 1 << DiveList::e_ByMaxDepth);
+  m_vMaxDepth = vDepth;
+  if ( m_pcOwner )
+    m_pcOwner->keysChanged(this, 1 << DiveList::e_ByMaxDepth);
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  Set the dive time to \a cTime.
+*/
+//*****************************************************************************
+
+void
+DiveLog::setDiveTime(QTime cTime)
+{
+  if ( cTime == m_cDiveTime )
+    return;
+
+  if ( m_pcOwner )
+    m_pcOwner->keysAboutToChange(this, 1 << DiveList::e_ByDiveTime);
+  m_cDiveTime = cTime;
+  if ( m_pcOwner )
+    m_pcOwner->keysChanged(this, 1 << DiveList::e_ByDiveTime);
+  touch();
+}
+
+
+//*****************************************************************************
+/*!
+  Set the surface air consuption to \a nLitres.
+*/
+//*****************************************************************************
+
+void
+DiveLog::setSurfaceAirConsumption(int nLitres)
+{
+  if ( nLitres == m_nNumLitresUsed )
+    return;
+
+  if ( m_pcOwner )
+    m_pcOwner->keysAboutToChange(this, DiveList::e_TotalsKey);
+  m_nNumLitresUsed = nLitres;
+  if ( m_pcOwner )
+    m_pcOwner->keysChanged(this, DiveList::e_TotalsKey);
+  touch();
+}
+
+
 // Local Variables:
 // mode: c++
 // tab-width: 8
@@ -14,9 +14,13 @@
 #ifndef DIVELOG_H
 #define DIVELOG_H
 
+#include "diveprofile.h"
 #include <qdatetime.h>
 #include <qstring.h>
 
+class DiveList;
+class LocationLog;
+
 //*****************************************************************************
 /*!
   \class DiveLog
@@ -42,84 +46,111 @@ public:
 
   //! Get the log number for this dive.
   int logNumber() const { return m_nLogNumber; }
-  //! Set the log number for this dive to \a nNumber.
-  void setLogNumber(int nNumber) { m_nLogNumber = nNumber; }
+  void setLogNumber(int nNumber);
   //! Get the date for this dive.
   QDate diveDate() const { return m_cDiveDate; }
-  //! Set the date for this dive to \a cDate.
-  void setDiveDate(QDate cDate) { m_cDiveDate = cDate; }
+  void setDiveDate(QDate cDate);
   //! Get the start-time for this dive.
   QTime diveStart() const { return m_cDiveStart; }
-  //! Set the start time for this dive to \a cTime.
-  void setDiveStart(QTime cTime) { m_cDiveStart = cTime; }
-  //! Get the dive location.
-  QString diveLocation() const { return m_cLocation; }
-  //! Set the dive location to \a cLocation.
-  void setDiveLocation(const QString& cLocation) { m_cLocation = cLocation; }
+  void setDiveStart(QTime cTime);
+  QString diveLocation() const;
+  void setDiveLocation(const QString& cLocation);
+  //! Get the logged location of this dive, or 0 if it isn't logged.
+  LocationLog* location() const { return m_pcLocationLog; }
+  //! Get the dive list this log is in, or 0 if it isn't in one.
+  DiveList* diveList() const { return m_pcOwner; }
   //! Get the buddy name.
   QString buddyName() const { return m_cBuddyName; }
   //! Set the buddy name to \a cName.
-  void setBuddyName(const QString& cName) { m_cBuddyName = cName; }
+  void setBuddyName(const QString& cName) { assign(m_cBuddyName, cName); }
   //! Get the maximum depth on this dive.
   float maxDepth() const { return m_vMaxDepth; }
-  //! Set the maximum depth for this dive to \a vDepth.
-  void setMaxDepth(float vDepth) { m_vMaxDepth = vDepth; }
+  void setMaxDepth(float vDepth);
   //! Get the dive time (duration).
   QTime diveTime() const { return m_cDiveTime; }
-  //! Set the dive time to \a cTime.
-  void setDiveTime(QTime cTime) { m_cDiveTime = cTime; }
+  void setDiveTime(QTime cTime);
   //! Get the bottom-time for this dive (only applies to single-level).
   QTime bottomTime() const { return m_cBottomTime; }
   //! Set the bottom-time for this dive to \a cTime.
-  void setBottomTime(QTime cTime) { m_cBottomTime = cTime; }
+  void setBottomTime(QTime cTime) { assign(m_cBottomTime, cTime); }
   //! Get the gas-type(s) used in this dive.
   QString gasType() const { return m_cGasType; }
   //! Set the gas-type(s) used in this dive to \a eType.
-  void setGasType(const QString& cType) { m_cGasType = cType; }
+  void setGasType(const QString& cType) { assign(m_cGasType, cType); }
   //! Get the air temperature on this dive.
   float airTemperature() const { return m_vAirTemperature; }
   //! Set the air temperature on this dive to \a vTemp.
-  void setAirTemperature(float vTemp) { m_vAirTemperature = vTemp; }
+  void setAirTemperature(float vTemp) { assign(m_vAirTemperature, vTemp); }
   //! Get the water surface temperature on this dive.
   float waterSurfaceTemperature() const { return m_vSurfaceTemperature; }
   //! Set the water surface temperature on this dive to \a vTemp.
-  void setWaterSurfaceTemperature(float vTemp) {m_vSurfaceTemperature = vTemp;}
+  void setWaterSurfaceTemperature(float vTemp) {
+    assign(m_vSurfaceTemperature, vTemp);
+  }
   //! Get the water temperature on this dive.
   float waterTemperature() const { return m_vWaterTemperature; }
   //! Set the water temperature on this dive to \a vTemp.
-  void setWaterTemperature(float vTemp) { m_vWaterTemperature = vTemp; }
+  void setWaterTemperature(float vTemp) { assign(m_vWaterTemperature, vTemp); }
   //! Get the plan-type for this dive.
   PlanType_e planType() const { return m_ePlanType; }
   //! Set the plan-type for this dive to \e eType.
-  void setPlanType(PlanType_e eType) { m_ePlanType = eType; }
+  void setPlanType(PlanType_e eType) { assign(m_ePlanType, eType); }
   //! Get the dive type for this dive.
   QString diveType() const { return m_cDiveType; }
   //! Set the dive type for this dive to \a cDiveType.
-  void setDiveType(const QString& cDiveType) { m_cDiveType = cDiveType; }
+  void setDiveType(const QString& cDiveType) {
+    assign(m_cDiveType, cDiveType);
+  }
   //! Get the dive description.
   QString diveDescription() const { return m_cDiveDescription; }
   //! Set the dive description to \a cDescription.
   void setDiveDescription(const QString& cDescription) {
-    m_cDiveDescription = cDescription;
+    assign(m_cDiveDescription, cDescription);
   }
   //! Get the surface air consuption.
   unsigned int surfaceAirConsuption() const { return m_nNumLitresUsed; }
-  //! Set the surface air consuption to \a nLitres.
-  void setSurfaceAirConsumption(int nLitres) { m_nNumLitresUsed = nLitres; }
+  void setSurfaceAirConsumption(int nLitres);
+  //! Get the depth profile, which is empty if no samples are recorded.
+  const DiveProfile& profile() const { return m_cProfile; }
+  //! Set the depth profile to \a cProfile.
+  void setProfile(const DiveProfile& cProfile) {
+    m_cProfile = cProfile;
+    touch();
+  }
 
 private:
+  friend class DiveList;
+
   //! Disabled copy constructor.
   DiveLog(const DiveLog&);
   //! Disabled assignment operator.
   DiveLog& operator =(const DiveLog&);
 
+  void touch();
+  //! Set \a cMember to \a cValue, and report a change if it differs.
+  template <class T> void assign(T& cMember, const T& cValue) {
+    if ( !(cMember == cValue) ) {
+      cMember = cValue;
+      touch();
+    }
+  }
+
+  //! The list this log is in, or 0 if it isn't in a list.
+  DiveList*  m_pcOwner;
+  //! The position of this log in its list, or -1 if it isn't in a list.
+  int        m_nListIndex;
+  //! The logged location, or 0. Set by the list.
+  LocationLog* m_pcLocationLog;
+  //! The position of this log in the dives of #m_pcLocationLog, or -1.
+  int        m_nLocationSlot;
+
   //! The log number.
   int        m_nLogNumber;
   //! The date of the dive.
   QDate      m_cDiveDate;
   //! The time of the start of the dive.
   QTime      m_cDiveStart;
-  //! The location of the dive.
+  //! The location of the dive, used when it isn't linked to a location log.
   QString    m_cLocation;
   //! The name of the buddy.
   QString    m_cBuddyName;
@@ -145,6 +176,8 @@ private:
   QString    m_cDiveType;
   //! A long description about the dive.
   QString    m_cDiveDescription;
+  //! The depth samples recorded on the dive.
+  DiveProfile m_cProfile;
 };
 
 #endif // DIVELOG_H
@@ -0,0 +1,445 @@
+//*****************************************************************************
+/*!
+  \file divelogedit.cpp
+  \brief This file contains the implementation of the DiveLogEdit class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "divelogedit.h"
+#include "divelog.h"
+#include "divelist.h"
+#include "changetracker.h"
+#include <KLocalizedString>
+#include <qdatetime.h>
+#include <qstring.h>
+
+
+/**
+ * The command id shared by edits of a single field.
+ * Edits with other ids are never merged.
+ */
+
+static const int s_nSingleFieldId = 1;
+
+
+/**
+ * Returns `true' if \a cText has any white space in it.
+ */
+
+static bool
+hasWhiteSpace(const QString& cText)
+{
+  for ( int iChar = 0; iChar < cText.length(); ++iChar ) {
+    if ( cText.at(iChar).isSpace() )
+      return true;
+  }
+  return false;
+}
+
+
+/**
+ * Get the user visible name of \a eField.
+ */
+
+static QString
+fieldName(DiveLogEdit::Field_e eField)
+{
+  switch ( eField ) {
+  case DiveLogEdit::e_LogNumber:        return i18n("log number");
+  case DiveLogEdit::e_DiveDate:         return i18n("dive date");
+  case DiveLogEdit::e_DiveStart:        return i18n("dive start");
+  case DiveLogEdit::e_DiveTime:         return i18n("dive time");
+  case DiveLogEdit::e_GasType:          return i18n("gas type");
+  case DiveLogEdit::e_BottomTime:       return i18n("bottom time");
+  case DiveLogEdit::e_AirTemperature:   return i18n("air temperature");
+  case DiveLogEdit::e_WaterTemperature: return i18n("water temperature");
+  case DiveLogEdit::e_DiveLocation:     return i18n("location");
+  case DiveLogEdit::e_MaxDepth:         return i18n("max depth");
+  case DiveLogEdit::e_BuddyName:        return i18n("buddy");
+  case DiveLogEdit::e_DiveType:         return i18n("dive type");
+  case DiveLogEdit::e_DiveDescription:  return i18n("description");
+  }
+  return QString();
+}
+
+
+//*****************************************************************************
+/*!
+  Create an empty edit with the undo text \a cText.
+  Add the changes with addChange().
+*/
+//*****************************************************************************
+
+DiveLogEdit::DiveLogEdit(const QString& cText)
+  : QUndoCommand(cText)
+{
+  m_cLastChange.start();
+}
+
+
+//*****************************************************************************
+/*!
+  Create an edit setting the field \a eField of the log \a pcLog
+  to \a cValue.
+*/
+//*****************************************************************************
+
+DiveLogEdit::DiveLogEdit(DiveLog* pcLog, Field_e eField,
+                         const QVariant& cValue)
+  : QUndoCommand(i18n("Edit %1", fieldName(eField)))
+{
+  m_cLastChange.start();
+  addChange(pcLog, eField, cValue);
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the edit.
+*/
+//*****************************************************************************
+
+DiveLogEdit::~DiveLogEdit()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Add a change setting the field \a eField of the log \a pcLog to \a cValue.
+  The old value is taken from the log, so it must not be changed until
+  the edit is redone.
+
+  Returns `false' if the log already has the value, as nothing needs
+  to be recorded then.
+*/
+//*****************************************************************************
+
+bool
+DiveLogEdit::addChange(DiveLog* pcLog, Field_e eField, const QVariant& cValue)
+{
+  const QVariant cOld = fieldValue(*pcLog, eField);
+  if ( cOld == cValue )
+    return false;
+
+  Change cChange;
+  cChange.pcLog = pcLog;
+  cChange.eField = eField;
+  cChange.nPosition = 0;
+  if ( isTextField(eField) ) {
+    setTextChange(cChange, cOld.toString(), cValue.toString());
+  }
+  else {
+    cChange.cOld = cOld;
+    cChange.cNew = cValue;
+  }
+  m_acChanges.append(cChange);
+  return true;
+}
+
+
+//*****************************************************************************
+/*!
+  Drop the changes of the log \a pcLog, which is about to be removed.
+  If no changes are left, the edit is made obsolete, so the undo stack
+  removes it when it is next undone or redone.
+*/
+//*****************************************************************************
+
+void
+DiveLogEdit::forgetLog(const DiveLog* pcLog)
+{
+  int nKept = 0;
+  for ( int iChange = 0; iChange < m_acChanges.count(); ++iChange ) {
+    if ( m_acChanges.at(iChange).pcLog != pcLog )
+      m_acChanges[nKept++] = m_acChanges.at(iChange);
+  }
+  if ( nKept == m_acChanges.count() )
+    return;
+  m_acChanges.resize(nKept);
+  if ( m_acChanges.isEmpty() )
+    setObsolete(true);
+}
+
+
+//*****************************************************************************
+/*!
+  Restore the old values.
+*/
+//*****************************************************************************
+
+void
+DiveLogEdit::undo()
+{
+  applyAll(true);
+}
+
+
+//*****************************************************************************
+/*!
+  Set the new values.
+*/
+//*****************************************************************************
+
+void
+DiveLogEdit::redo()
+{
+  applyAll(false);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the merge id of this edit. Only edits of a single field can be merged.
+*/
+//*****************************************************************************
+
+int
+DiveLogEdit::id() const
+{
+  return 1 == m_acChanges.count() ? s_nSingleFieldId : -1;
+}
+
+
+//*****************************************************************************
+/*!
+  Merge \a pcOther, which has just been redone, into this edit if it
+  changes the same field in the same log. Returns `true' if merged.
+
+  Edits made more than #e_MergeMsecs milliseconds apart are not merged,
+  and neither is an edit of a text field that types white space, so each
+  word of a text gets an undo step.
+
+  For text fields, the text of both edits is undone from the current text
+  to find the text before this edit, and a single change is made from that.
+*/
+//*****************************************************************************
+
+bool
+DiveLogEdit::mergeWith(const QUndoCommand* pcOther)
+{
+  if ( pcOther->id() != s_nSingleFieldId || id() != s_nSingleFieldId )
+    return false;
+  const Change& cOther =
+    static_cast<const DiveLogEdit*>(pcOther)->m_acChanges.first();
+  Change& cChange = m_acChanges.first();
+  if ( cOther.pcLog != cChange.pcLog || cOther.eField != cChange.eField )
+    return false;
+  if ( m_cLastChange.elapsed() > e_MergeMsecs )
+    return false;
+  if ( isTextField(cChange.eField) && hasWhiteSpace(cOther.cNew.toString()) )
+    return false;
+  m_cLastChange.restart();
+
+  if ( isTextField(cChange.eField) ) {
+    const QString cCurrent =
+      fieldValue(*cChange.pcLog, cChange.eField).toString();
+    const QString cOriginal =
+      applyText(applyText(cCurrent, cOther, true), cChange, true);
+    setTextChange(cChange, cOriginal, cCurrent);
+  }
+  else {
+    cChange.cNew = cOther.cNew;
+  }
+  return true;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the value of the field \a eField of the log \a cLog.
+*/
+//*****************************************************************************
+
+QVariant
+DiveLogEdit::fieldValue(const DiveLog& cLog, Field_e eField)
+{
+  switch ( eField ) {
+  case e_LogNumber:        return cLog.logNumber();
+  case e_DiveDate:         return cLog.diveDate();
+  case e_DiveStart:        return cLog.diveStart();
+  case e_DiveTime:         return cLog.diveTime();
+  case e_GasType:          return cLog.gasType();
+  case e_BottomTime:       return cLog.bottomTime();
+  case e_AirTemperature:   return cLog.airTemperature();
+  case e_WaterTemperature: return cLog.waterTemperature();
+  case e_DiveLocation:     return cLog.diveLocation();
+  case e_MaxDepth:         return cLog.maxDepth();
+  case e_BuddyName:        return cLog.buddyName();
+  case e_DiveType:         return cLog.diveType();
+  case e_DiveDescription:  return cLog.diveDescription();
+  }
+  return QVariant();
+}
+
+
+//*****************************************************************************
+/*!
+  Set the field \a eField of the log \a cLog to \a cValue.
+*/
+//*****************************************************************************
+
+void
+DiveLogEdit::setFieldValue(DiveLog& cLog, Field_e eField,
+                           const QVariant& cValue)
+{
+  switch ( eField ) {
+  case e_LogNumber:        cLog.setLogNumber(cValue.toInt()); break;
+  case e_DiveDate:         cLog.setDiveDate(cValue.toDate()); break;
+  case e_DiveStart:        cLog.setDiveStart(cValue.toTime()); break;
+  case e_DiveTime:         cLog.setDiveTime(cValue.toTime()); break;
+  case e_GasType:          cLog.setGasType(cValue.toString()); break;
+  case e_BottomTime:       cLog.setBottomTime(cValue.toTime()); break;
+  case e_AirTemperature:   cLog.setAirTemperature(cValue.toFloat()); break;
+  case e_WaterTemperature: cLog.setWaterTemperature(cValue.toFloat()); break;
+  case e_DiveLocation:     cLog.setDiveLocation(cValue.toString()); break;
+  case e_MaxDepth:         cLog.setMaxDepth(cValue.toFloat()); break;
+  case e_BuddyName:        cLog.setBuddyName(cValue.toString()); break;
+  case e_DiveType:         cLog.setDiveType(cValue.toString()); break;
+  case e_DiveDescription:  cLog.setDiveDescription(cValue.toString()); break;
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Returns `true' if \a eField is stored as the text that differs.
+
+  The location is not, as renaming its location log changes the text of
+  the log without an edit, and a stored position would then be wrong.
+*/
+//*****************************************************************************
+
+bool
+DiveLogEdit::isTextField(Field_e eField)
+{
+  return e_GasType == eField || e_BuddyName == eField ||
+    e_DiveType == eField || e_DiveDescription == eField;
+}
+
+
+//*****************************************************************************
+/*!
+  Make \a cChange replace \a cOld with \a cNew, storing only the part
+  between the prefix and suffix they have in common.
+*/
+//*****************************************************************************
+
+void
+DiveLogEdit::setTextChange(Change& cChange, const QString& cOld,
+                           const QString& cNew)
+{
+  const int nMaxCommon = qMin(cOld.length(), cNew.length());
+  int nPrefix = 0;
+  while ( nPrefix < nMaxCommon && cOld.at(nPrefix) == cNew.at(nPrefix) )
+    ++nPrefix;
+  int nSuffix = 0;
+  while ( nSuffix < nMaxCommon - nPrefix &&
+          cOld.at(cOld.length() - 1 - nSuffix) ==
+          cNew.at(cNew.length() - 1 - nSuffix) )
+    ++nSuffix;
+
+  cChange.nPosition = nPrefix;
+  cChange.cOld = cOld.mid(nPrefix, cOld.length() - nPrefix - nSuffix);
+  cChange.cNew = cNew.mid(nPrefix, cNew.length() - nPrefix - nSuffix);
+}
+
+
+//*****************************************************************************
+/*!
+  Get \a cText with the text change \a cChange redone, or undone if
+  \a isUndo is `true'.
+*/
+//*****************************************************************************
+
+QString
+DiveLogEdit::applyText(const QString& cText, const Change& cChange,
+                       bool isUndo)
+{
+  const QString cRemove = (isUndo ? cChange.cNew : cChange.cOld).toString();
+  const QString cInsert = (isUndo ? cChange.cOld : cChange.cNew).toString();
+  QString cResult(cText);
+  cResult.replace(cChange.nPosition, cRemove.length(), cInsert);
+  return cResult;
+}
+
+
+//*****************************************************************************
+/*!
+  Redo \a cChange, or undo it if \a isUndo is `true'.
+*/
+//*****************************************************************************
+
+void
+DiveLogEdit::apply(const Change& cChange, bool isUndo)
+{
+  DiveLog& cLog = *cChange.pcLog;
+  if ( isTextField(cChange.eField) ) {
+    const QString cText = fieldValue(cLog, cChange.eField).toString();
+    setFieldValue(cLog, cChange.eField, applyText(cText, cChange, isUndo));
+  }
+  else {
+    setFieldValue(cLog, cChange.eField, isUndo ? cChange.cOld : cChange.cNew);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Redo all the changes, or undo them in the reverse order if \a isUndo
+  is `true'.
+
+  If there is more than one change, the log number changes are collected
+  and set last, all at once.
+
+  The change tracker of the list is told that the changes come from the
+  edit history, so undoing back to the saved state leaves the log book
+  unmodified.
+*/
+//*****************************************************************************
+
+void
+DiveLogEdit::applyAll(bool isUndo)
+{
+  ChangeTracker* pcTracker = 0;
+  if ( false == m_acChanges.isEmpty() && m_acChanges.first().pcLog->diveList() )
+    pcTracker = m_acChanges.first().pcLog->diveList()->changeTracker();
+  if ( pcTracker )
+    pcTracker->editAboutToBeApplied();
+
+  QVector<DiveLog*> apcRenumbered;
+  QVector<int> anNumbers;
+  const bool isBulk = m_acChanges.count() > 1;
+  for ( int iStep = 0; iStep < m_acChanges.count(); ++iStep ) {
+    const int iChange = isUndo ? m_acChanges.count() - 1 - iStep : iStep;
+    const Change& cChange = m_acChanges.at(iChange);
+    if ( isBulk && e_LogNumber == cChange.eField &&
+         cChange.pcLog->diveList() ) {
+      apcRenumbered.append(cChange.pcLog);
+      anNumbers.append((isUndo ? cChange.cOld : cChange.cNew).toInt());
+    }
+    else {
+      apply(cChange, isUndo);
+    }
+  }
+  if ( false == apcRenumbered.isEmpty() )
+    apcRenumbered.first()->diveList()->setLogNumbers(apcRenumbered, anNumbers);
+
+  if ( pcTracker )
+    pcTracker->editApplied();
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,132 @@
+//*****************************************************************************
+/*!
+  \file divelogedit.h
+  \brief This file contains the definition of the DiveLogEdit class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef DIVELOGEDIT_H
+#define DIVELOGEDIT_H
+
+#include <qelapsedtimer.h>
+#include <qundostack.h>
+#include <qvariant.h>
+#include <qvector.h>
+
+class DiveLog;
+
+
+//*****************************************************************************
+/*!
+  \class DiveLogEdit
+  \brief The DiveLogEdit class is an undoable edit of dive log fields.
+
+  An edit holds one or more changes, each of one field in one dive log.
+  Only the changed field is stored, not a copy of the log. For the text
+  fields, only the part of the text that differs is stored, so typing in
+  a long description costs a few characters per edit, not the whole text.
+  The location is stored whole, as its text also changes outside the
+  history when a location log is renamed or the log is linked to one.
+
+  Bulk operations, like renumbering, put all their changes in one edit,
+  which is then undone and redone as one step. The log numbers of an edit
+  with many changes are set together with DiveList::setLogNumbers(), so
+  renumbering a big log book doesn't update the list once per log.
+
+  Edits of a single field are merged with the next edit of the same field
+  in the same log, so typing a word gives one undo step, not one per key.
+  Typing white space, or pausing for #e_MergeMsecs milliseconds, starts
+  a new step, so a paragraph isn't undone all at once.
+
+  Changes are recorded with addChange(), but not applied until redo() is
+  called; QUndoStack::push() does that.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class DiveLogEdit : public QUndoCommand
+{
+public:
+  //! The longest pause between two edits that are merged, in milliseconds.
+  enum { e_MergeMsecs = 2000 };
+
+  //! The fields that can be edited.
+  enum Field_e {
+    e_LogNumber,
+    e_DiveDate,
+    e_DiveStart,
+    e_DiveTime,
+    e_GasType,
+    e_BottomTime,
+    e_AirTemperature,
+    e_WaterTemperature,
+    e_DiveLocation,
+    e_MaxDepth,
+    e_BuddyName,
+    e_DiveType,
+    e_DiveDescription
+  };
+
+  explicit DiveLogEdit(const QString& cText);
+  DiveLogEdit(DiveLog* pcLog, Field_e eField, const QVariant& cValue);
+  virtual ~DiveLogEdit();
+
+  bool addChange(DiveLog* pcLog, Field_e eField, const QVariant& cValue);
+  //! Get the number of changes in this edit.
+  int numChanges() const { return m_acChanges.count(); }
+  void forgetLog(const DiveLog* pcLog);
+
+  virtual void undo();
+  virtual void redo();
+  virtual int id() const;
+  virtual bool mergeWith(const QUndoCommand* pcOther);
+
+  static QVariant fieldValue(const DiveLog& cLog, Field_e eField);
+
+private:
+  //! A change of one field in one log.
+  struct Change {
+    //! The log changed.
+    DiveLog* pcLog;
+    //! The field changed.
+    Field_e  eField;
+    //! For text fields, the position of the text replaced.
+    int      nPosition;
+    //! The old value, or for text fields the text replaced.
+    QVariant cOld;
+    //! The new value, or for text fields the replacing text.
+    QVariant cNew;
+  };
+
+  static bool isTextField(Field_e eField);
+  static void setFieldValue(DiveLog& cLog, Field_e eField,
+                            const QVariant& cValue);
+  static void setTextChange(Change& cChange, const QString& cOld,
+                            const QString& cNew);
+  static QString applyText(const QString& cText, const Change& cChange,
+                           bool isUndo);
+  static void apply(const Change& cChange, bool isUndo);
+  void applyAll(bool isUndo);
+
+  //! The changes, in the order they are redone.
+  QVector<Change> m_acChanges;
+  //! Started when the edit was made or last merged with.
+  QElapsedTimer   m_cLastChange;
+};
+
+#endif // DIVELOGEDIT_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
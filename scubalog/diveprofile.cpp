@@ -0,0 +1,214 @@
+//*****************************************************************************
+/*!
+  \file diveprofile.cpp
+  \brief This file contains the implementation of the DiveProfile class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "diveprofile.h"
+#include <qpair.h>
+
+
+//*****************************************************************************
+/*!
+  Create an empty profile.
+*/
+//*****************************************************************************
+
+DiveProfile::DiveProfile()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the profile.
+*/
+//*****************************************************************************
+
+DiveProfile::~DiveProfile()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Add a sample with the depth \a vDepth meters at \a nSeconds seconds
+  from the start of the dive.
+*/
+//*****************************************************************************
+
+void
+DiveProfile::addSample(int nSeconds, float vDepth)
+{
+  m_anTimes.append(nSeconds);
+  m_avDepths.append(vDepth);
+}
+
+
+//*****************************************************************************
+/*!
+  Remove all the samples.
+*/
+//*****************************************************************************
+
+void
+DiveProfile::clear()
+{
+  m_anTimes.clear();
+  m_avDepths.clear();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the time of the last sample, in seconds, or 0 if there are no samples.
+*/
+//*****************************************************************************
+
+int
+DiveProfile::duration() const
+{
+  return m_anTimes.isEmpty() ? 0 : m_anTimes.last();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the deepest sample, in meters, or 0 if there are no samples.
+*/
+//*****************************************************************************
+
+float
+DiveProfile::maxDepth() const
+{
+  float vMaxDepth = 0.0F;
+  for ( int iSample = 0; iSample < m_avDepths.count(); ++iSample ) {
+    if ( m_avDepths.at(iSample) > vMaxDepth )
+      vMaxDepth = m_avDepths.at(iSample);
+  }
+  return vMaxDepth;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the points for drawing the profile in \a cArea.
+
+  The time runs from the left to the right edge of the area, and the depth
+  from the top (the surface) to the bottom (the maximum depth). The points
+  are simplified with a tolerance of \a vTolerance in the coordinates of
+  \a cArea, so a tolerance of half a pixel or so keeps the drawing exact.
+*/
+//*****************************************************************************
+
+QVector<QPointF>
+DiveProfile::chartPoints(const QRectF& cArea, double vTolerance) const
+{
+  QVector<QPointF> acPoints;
+  if ( isEmpty() )
+    return acPoints;
+
+  const int   nDuration = duration() > 0 ? duration() : 1;
+  const float vMaxDepth = maxDepth() > 0.0F ? maxDepth() : 1.0F;
+  const double vXScale  = cArea.width() / nDuration;
+  const double vYScale  = cArea.height() / vMaxDepth;
+  acPoints.reserve(numSamples());
+  for ( int iSample = 0; iSample < numSamples(); ++iSample ) {
+    acPoints.append(QPointF(cArea.left() + m_anTimes.at(iSample) * vXScale,
+                            cArea.top() + m_avDepths.at(iSample) * vYScale));
+  }
+  return simplify(acPoints, vTolerance);
+}
+
+
+//*****************************************************************************
+/*!
+  Simplify the polyline \a acPoints with the Ramer-Douglas-Peucker
+  algorithm, and return the simplified polyline.
+
+  The end points are always kept. Between them, the point farthest from
+  the line through the end points is kept if it is more than \a vTolerance
+  away, and the two halves are simplified the same way. The halves are
+  kept on an explicit stack rather than by recursion, as long profiles
+  could otherwise recurse very deep.
+*/
+//*****************************************************************************
+
+QVector<QPointF>
+DiveProfile::simplify(const QVector<QPointF>& acPoints, double vTolerance)
+{
+  const int nNumPoints = acPoints.count();
+  if ( nNumPoints < 3 )
+    return acPoints;
+
+  const double vToleranceSquared = vTolerance * vTolerance;
+  QVector<bool> aisKept(nNumPoints, false);
+  aisKept[0] = true;
+  aisKept[nNumPoints - 1] = true;
+
+  QVector<QPair<int, int> > acSegments;
+  acSegments.append(qMakePair(0, nNumPoints - 1));
+  while ( false == acSegments.isEmpty() ) {
+    const QPair<int, int> cSegment = acSegments.last();
+    acSegments.removeLast();
+    const int nFirst = cSegment.first;
+    const int nLast  = cSegment.second;
+    if ( nLast - nFirst < 2 )
+      continue;
+
+    const QPointF& cStart = acPoints.at(nFirst);
+    const QPointF& cEnd   = acPoints.at(nLast);
+    const double vDX = cEnd.x() - cStart.x();
+    const double vDY = cEnd.y() - cStart.y();
+    const double vLengthSquared = vDX * vDX + vDY * vDY;
+
+    int    nFarthest = -1;
+    double vFarthestSquared = vToleranceSquared;
+    for ( int iPoint = nFirst + 1; iPoint < nLast; ++iPoint ) {
+      const QPointF& cPoint = acPoints.at(iPoint);
+      const double vPX = cPoint.x() - cStart.x();
+      const double vPY = cPoint.y() - cStart.y();
+      double vDistanceSquared;
+      if ( vLengthSquared > 0.0 ) {
+        const double vCross = vDX * vPY - vDY * vPX;
+        vDistanceSquared = vCross * vCross / vLengthSquared;
+      }
+      else {
+        vDistanceSquared = vPX * vPX + vPY * vPY;
+      }
+      if ( vDistanceSquared > vFarthestSquared ) {
+        vFarthestSquared = vDistanceSquared;
+        nFarthest = iPoint;
+      }
+    }
+
+    if ( nFarthest >= 0 ) {
+      aisKept[nFarthest] = true;
+      acSegments.append(qMakePair(nFirst, nFarthest));
+      acSegments.append(qMakePair(nFarthest, nLast));
+    }
+  }
+
+  QVector<QPointF> acSimplified;
+  for ( int iPoint = 0; iPoint < nNumPoints; ++iPoint ) {
+    if ( aisKept.at(iPoint) )
+      acSimplified.append(acPoints.at(iPoint));
+  }
+  return acSimplified;
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
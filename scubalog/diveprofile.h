@@ -0,0 +1,80 @@
+//*****************************************************************************
+/*!
+  \file diveprofile.h
+  \brief This file contains the definition of the DiveProfile class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef DIVEPROFILE_H
+#define DIVEPROFILE_H
+
+#include <qpoint.h>
+#include <qrect.h>
+#include <qvector.h>
+
+
+//*****************************************************************************
+/*!
+  \class DiveProfile
+  \brief The DiveProfile class holds the depth samples recorded on a dive.
+
+  Each sample is a time, in seconds from the start of the dive, and a depth
+  in meters. The samples are kept in the order they were added, which
+  should be ascending time.
+
+  A dive computer may record thousands of samples on one dive, which is far
+  more than is needed to draw the profile. simplify() reduces a polyline
+  with the Ramer-Douglas-Peucker algorithm, and chartPoints() uses it to
+  get the points for drawing the profile in a given area, so HTML export,
+  printing and the views all draw the profile the same way.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class DiveProfile
+{
+public:
+  DiveProfile();
+  ~DiveProfile();
+
+  //! Returns `true' if there are no samples.
+  bool isEmpty() const { return m_anTimes.isEmpty(); }
+  //! Get the number of samples.
+  int numSamples() const { return m_anTimes.count(); }
+  //! Get the time of sample \a nIndex, in seconds.
+  int sampleTime(int nIndex) const { return m_anTimes.at(nIndex); }
+  //! Get the depth of sample \a nIndex, in meters.
+  float sampleDepth(int nIndex) const { return m_avDepths.at(nIndex); }
+  void addSample(int nSeconds, float vDepth);
+  void clear();
+
+  int duration() const;
+  float maxDepth() const;
+
+  QVector<QPointF> chartPoints(const QRectF& cArea, double vTolerance) const;
+  static QVector<QPointF> simplify(const QVector<QPointF>& acPoints,
+                                   double vTolerance);
+
+private:
+  //! The time of each sample, in seconds from the start of the dive.
+  QVector<int>   m_anTimes;
+  //! The depth of each sample, in meters.
+  QVector<float> m_avDepths;
+};
+
+#endif // DIVEPROFILE_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
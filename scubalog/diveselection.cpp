@@ -0,0 +1,115 @@
+//*****************************************************************************
+/*!
+  \file diveselection.cpp
+  \brief This file contains the implementation of the DiveSelection class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "diveselection.h"
+#include "divelist.h"
+#include <algorithm>
+
+
+//*****************************************************************************
+/*!
+  Create a selection of all the logs.
+*/
+//*****************************************************************************
+
+DiveSelection::DiveSelection()
+  : m_eKind(e_All)
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Create a selection of the logs at the indices \a anIndices in the dive
+  list. The indices need not be sorted; duplicates and negative indices
+  are ignored.
+*/
+//*****************************************************************************
+
+DiveSelection::DiveSelection(const QVector<int>& anIndices)
+  : m_eKind(e_Indices),
+    m_anIndices(anIndices)
+{
+  std::sort(m_anIndices.begin(), m_anIndices.end());
+  m_anIndices.erase(std::unique(m_anIndices.begin(), m_anIndices.end()),
+                    m_anIndices.end());
+  m_anIndices.erase(m_anIndices.begin(),
+                    std::lower_bound(m_anIndices.begin(), m_anIndices.end(),
+                                     0));
+}
+
+
+//*****************************************************************************
+/*!
+  Create a selection of the logs \a cPredicate returns `true' for.
+*/
+//*****************************************************************************
+
+DiveSelection::DiveSelection(const Predicate_t& cPredicate)
+  : m_eKind(e_Predicate),
+    m_cPredicate(cPredicate)
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the selection.
+*/
+//*****************************************************************************
+
+DiveSelection::~DiveSelection()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Get the ascending indices of the selected logs in \a cDiveList.
+  Indices past the end of the list are dropped.
+*/
+//*****************************************************************************
+
+QVector<int>
+DiveSelection::indices(const DiveList& cDiveList) const
+{
+  QVector<int> anIndices;
+  const int nNumLogs = cDiveList.count();
+  if ( e_All == m_eKind ) {
+    anIndices.reserve(nNumLogs);
+    for ( int iLog = 0; iLog < nNumLogs; ++iLog )
+      anIndices.append(iLog);
+  }
+  else if ( e_Indices == m_eKind ) {
+    anIndices = m_anIndices;
+    anIndices.erase(std::lower_bound(anIndices.begin(), anIndices.end(),
+                                     nNumLogs),
+                    anIndices.end());
+  }
+  else {
+    for ( int iLog = 0; iLog < nNumLogs; ++iLog ) {
+      if ( m_cPredicate(*cDiveList.at(iLog)) )
+        anIndices.append(iLog);
+    }
+  }
+  return anIndices;
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,83 @@
+//*****************************************************************************
+/*!
+  \file diveselection.h
+  \brief This file contains the definition of the DiveSelection class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef DIVESELECTION_H
+#define DIVESELECTION_H
+
+#include <qvector.h>
+#include <functional>
+
+class DiveLog;
+class DiveList;
+
+
+//*****************************************************************************
+/*!
+  \class DiveSelection
+  \brief The DiveSelection class selects the dive logs to export.
+
+  A selection is either all the logs, a list of indices into the dive list,
+  or a predicate that is asked about each log. The exporters get the
+  selected logs with indices(), and only generate output for those.
+
+  An index list costs time in proportion to the number of selected logs.
+  A predicate has to be asked about every log, but that is cheap compared
+  to generating the output.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class DiveSelection
+{
+public:
+  //! A predicate returning `true' for the logs to select.
+  typedef std::function<bool (const DiveLog&)> Predicate_t;
+
+  DiveSelection();
+  explicit DiveSelection(const QVector<int>& anIndices);
+  explicit DiveSelection(const Predicate_t& cPredicate);
+  ~DiveSelection();
+
+  //! Returns `true' if all the logs are selected.
+  bool isAll() const { return e_All == m_eKind; }
+  QVector<int> indices(const DiveList& cDiveList) const;
+
+private:
+  //! The kinds of selection.
+  enum Kind_e {
+    //! All the logs.
+    e_All,
+    //! The logs in #m_anIndices.
+    e_Indices,
+    //! The logs accepted by #m_cPredicate.
+    e_Predicate
+  };
+
+  //! The kind of selection.
+  Kind_e       m_eKind;
+  //! The selected indices, sorted and without duplicates.
+  QVector<int> m_anIndices;
+  //! The predicate selecting logs.
+  Predicate_t  m_cPredicate;
+};
+
+#endif // DIVESELECTION_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
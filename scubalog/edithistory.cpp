@@ -0,0 +1,77 @@
+//*****************************************************************************
+/*!
+  \file edithistory.cpp
+  \brief This file contains the implementation of the EditHistory class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "edithistory.h"
+#include "divelogedit.h"
+
+
+//*****************************************************************************
+/*!
+  Create an empty history, with \a pcParent as the parent object.
+*/
+//*****************************************************************************
+
+EditHistory::EditHistory(QObject* pcParent)
+  : QUndoStack(pcParent)
+{
+  setUndoLimit(e_MaxSteps);
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the history.
+*/
+//*****************************************************************************
+
+EditHistory::~EditHistory()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  The log \a pcLog is about to be removed. Drop the changes of it from
+  the edits, as they could not be undone or redone anymore.
+
+  QUndoStack can't remove a command from the middle of the stack, so an
+  edit left without changes is marked obsolete; it does nothing, and is
+  removed when it is next undone or redone. The changes of the other logs
+  don't depend on the log, so they are kept. The history only holds
+  DiveLogEdit commands, but if it holds any other, it is cleared, as
+  there is no telling if the command changes the log.
+*/
+//*****************************************************************************
+
+void
+EditHistory::forgetLog(DiveLog* pcLog)
+{
+  for ( int iCommand = 0; iCommand < count(); ++iCommand ) {
+    const DiveLogEdit* pcEdit =
+      dynamic_cast<const DiveLogEdit*>(command(iCommand));
+    if ( 0 == pcEdit ) {
+      clear();
+      return;
+    }
+    const_cast<DiveLogEdit*>(pcEdit)->forgetLog(pcLog);
+  }
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,65 @@
+//*****************************************************************************
+/*!
+  \file edithistory.h
+  \brief This file contains the definition of the EditHistory class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef EDITHISTORY_H
+#define EDITHISTORY_H
+
+#include <qundostack.h>
+
+class DiveLog;
+
+
+//*****************************************************************************
+/*!
+  \class EditHistory
+  \brief The EditHistory class is the undo history of a log book.
+
+  The history holds DiveLogEdit commands only. The number of steps kept
+  is limited, and as each step only stores the fields it changed, so is
+  the memory used.
+
+  The edits point to the logs they change, so when a log is removed
+  the changes of it are dropped from the edits.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class EditHistory : public QUndoStack {
+  Q_OBJECT
+public:
+  //! The maximum number of undo steps kept.
+  enum { e_MaxSteps = 100 };
+
+  EditHistory(QObject* pcParent = 0);
+  virtual ~EditHistory();
+
+public slots:
+  void forgetLog(DiveLog* pcLog);
+
+private:
+  //! Disabled copy constructor.
+  EditHistory(const EditHistory&);
+  //! Disabled assignment operator.
+  EditHistory& operator =(const EditHistory&);
+};
+
+#endif // EDITHISTORY_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,306 @@
+//*****************************************************************************
+/*!
+  \file equipmenthistorymodel.cpp
+  \brief This file contains the implementation of the EquipmentHistoryModel
+  class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "equipmenthistorymodel.h"
+#include "equipmentlog.h"
+#include "changetracker.h"
+#include <KLocalizedString>
+#include <algorithm>
+#include <assert.h>
+
+
+//*****************************************************************************
+/*!
+  Create an empty model, with \a pcParent as the parent object.
+*/
+//*****************************************************************************
+
+EquipmentHistoryModel::EquipmentHistoryModel(QObject* pcParent)
+  : QAbstractTableModel(pcParent),
+    m_pcEquipment(0),
+    m_pcTracker(0)
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the model. The equipment is not touched.
+*/
+//*****************************************************************************
+
+EquipmentHistoryModel::~EquipmentHistoryModel()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Report edits to \a pcTracker, or to nothing if it is 0.
+*/
+//*****************************************************************************
+
+void
+EquipmentHistoryModel::setChangeTracker(ChangeTracker* pcTracker)
+{
+  m_pcTracker = pcTracker;
+}
+
+
+//*****************************************************************************
+/*!
+  Show the history of \a pcEquipment, or nothing if it is 0.
+  The model doesn't own the equipment.
+*/
+//*****************************************************************************
+
+void
+EquipmentHistoryModel::setEquipment(EquipmentLog* pcEquipment)
+{
+  if ( pcEquipment == m_pcEquipment )
+    return;
+  beginResetModel();
+  m_pcEquipment = pcEquipment;
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  Add an entry dated \a cDate, with no comment, to the history.
+  Returns the row of the new entry, which is where the date puts it.
+*/
+//*****************************************************************************
+
+int
+EquipmentHistoryModel::addEntry(const QDate& cDate)
+{
+  assert(m_pcEquipment);
+  const QVector<QDate>& acDates = m_pcEquipment->historyDates();
+  const int nRow =
+    std::upper_bound(acDates.constBegin(), acDates.constEnd(), cDate)
+    - acDates.constBegin();
+  beginInsertRows(QModelIndex(), nRow, nRow);
+  m_pcEquipment->addHistoryEntry(cDate, QString());
+  endInsertRows();
+  entryChanged(true);
+  return nRow;
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the history entry in the row \a nRow.
+*/
+//*****************************************************************************
+
+void
+EquipmentHistoryModel::removeEntry(int nRow)
+{
+  assert(m_pcEquipment);
+  if ( nRow < 0 || nRow >= m_pcEquipment->historyCount() )
+    return;
+  beginRemoveRows(QModelIndex(), nRow, nRow);
+  m_pcEquipment->removeHistoryEntry(nRow);
+  endRemoveRows();
+  entryChanged(true);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number of rows; the number of history entries.
+*/
+//*****************************************************************************
+
+int
+EquipmentHistoryModel::rowCount(const QModelIndex& cParent) const
+{
+  if ( cParent.isValid() || 0 == m_pcEquipment )
+    return 0;
+  return m_pcEquipment->historyCount();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number of columns.
+*/
+//*****************************************************************************
+
+int
+EquipmentHistoryModel::columnCount(const QModelIndex& cParent) const
+{
+  return cParent.isValid() ? 0 : e_NumColumns;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the data of \a cIndex for the role \a nRole, read from the history.
+  The date is given as a QDate.
+*/
+//*****************************************************************************
+
+QVariant
+EquipmentHistoryModel::data(const QModelIndex& cIndex, int nRole) const
+{
+  if ( false == cIndex.isValid() || 0 == m_pcEquipment ||
+       cIndex.row() >= m_pcEquipment->historyCount() ||
+       (Qt::DisplayRole != nRole && Qt::EditRole != nRole) )
+    return QVariant();
+
+  if ( e_Date == cIndex.column() )
+    return m_pcEquipment->historyDate(cIndex.row());
+  return m_pcEquipment->historyComment(cIndex.row());
+}
+
+
+//*****************************************************************************
+/*!
+  Get the title of the column \a nSection.
+*/
+//*****************************************************************************
+
+QVariant
+EquipmentHistoryModel::headerData(int nSection, Qt::Orientation eOrientation,
+                                  int nRole) const
+{
+  if ( Qt::Horizontal != eOrientation || Qt::DisplayRole != nRole )
+    return QVariant();
+
+  switch ( nSection ) {
+  case e_Date:    return i18n("Date");
+  case e_Comment: return i18n("Event");
+  default:        return QVariant();
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Get the flags of \a cIndex. All cells can be edited.
+*/
+//*****************************************************************************
+
+Qt::ItemFlags
+EquipmentHistoryModel::flags(const QModelIndex& cIndex) const
+{
+  if ( false == cIndex.isValid() )
+    return Qt::NoItemFlags;
+  return QAbstractTableModel::flags(cIndex) | Qt::ItemIsEditable;
+}
+
+
+//*****************************************************************************
+/*!
+  Set the cell \a cIndex to \a cValue, for the edit role \a nRole.
+  Returns `false' if the cell can't be set, like for an invalid date.
+*/
+//*****************************************************************************
+
+bool
+EquipmentHistoryModel::setData(const QModelIndex& cIndex,
+                               const QVariant& cValue, int nRole)
+{
+  if ( false == cIndex.isValid() || 0 == m_pcEquipment ||
+       cIndex.row() >= m_pcEquipment->historyCount() ||
+       Qt::EditRole != nRole )
+    return false;
+
+  const int nRow = cIndex.row();
+  if ( e_Date == cIndex.column() )
+    return setDate(nRow, cValue.toDate());
+
+  const QString cComment = cValue.toString();
+  if ( cComment != m_pcEquipment->historyComment(nRow) ) {
+    m_pcEquipment->setHistoryComment(nRow, cComment);
+    emit dataChanged(cIndex, cIndex);
+    entryChanged(false);
+  }
+  return true;
+}
+
+
+//*****************************************************************************
+/*!
+  Set the date of the entry in the row \a nRow to \a cDate, moving the
+  row to where the new date puts it in the history.
+
+  The new row is found before the entry is changed, the same way
+  EquipmentLog::setHistoryDate() finds it; after any entries with the
+  same date, not counting the entry itself.
+*/
+//*****************************************************************************
+
+bool
+EquipmentHistoryModel::setDate(int nRow, const QDate& cDate)
+{
+  if ( false == cDate.isValid() )
+    return false;
+  if ( cDate == m_pcEquipment->historyDate(nRow) )
+    return true;
+
+  const QVector<QDate>& acDates = m_pcEquipment->historyDates();
+  int nNewRow =
+    std::upper_bound(acDates.constBegin(), acDates.constEnd(), cDate)
+    - acDates.constBegin();
+  if ( nNewRow > nRow )
+    --nNewRow;
+
+  if ( nNewRow != nRow ) {
+    // The destination is given as the row it is put before, counted
+    // with the row still in place
+    beginMoveRows(QModelIndex(), nRow, nRow, QModelIndex(),
+                  nNewRow > nRow ? nNewRow + 1 : nNewRow);
+    m_pcEquipment->setHistoryDate(nRow, cDate);
+    endMoveRows();
+  }
+  else {
+    m_pcEquipment->setHistoryDate(nRow, cDate);
+  }
+  const QModelIndex cChanged = index(nNewRow, e_Date);
+  emit dataChanged(cChanged, cChanged);
+  entryChanged(true);
+  return true;
+}
+
+
+//*****************************************************************************
+/*!
+  Report the history of the equipment shown as changed. \a isDateChanged
+  is `true' if an entry was added, removed or dated, rather than only
+  given a new comment.
+*/
+//*****************************************************************************
+
+void
+EquipmentHistoryModel::entryChanged(bool isDateChanged)
+{
+  if ( 0 == m_pcTracker )
+    return;
+  if ( isDateChanged )
+    m_pcTracker->equipmentHistoryChanged(m_pcEquipment);
+  else
+    m_pcTracker->equipmentChanged(m_pcEquipment);
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
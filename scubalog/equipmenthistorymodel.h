@@ -0,0 +1,103 @@
+//*****************************************************************************
+/*!
+  \file equipmenthistorymodel.h
+  \brief This file contains the definition of the EquipmentHistoryModel class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef EQUIPMENTHISTORYMODEL_H
+#define EQUIPMENTHISTORYMODEL_H
+
+#include <QAbstractTableModel>
+#include <qdatetime.h>
+
+class EquipmentLog;
+class ChangeTracker;
+
+
+//*****************************************************************************
+/*!
+  \class EquipmentHistoryModel
+  \brief The EquipmentHistoryModel class is a table model of the history
+  of a piece of equipment.
+
+  There is one row per history entry, in the order of the history, which
+  is sorted on the date, with the date and the comment as the columns.
+  The cells are read from the equipment log when the view asks for them,
+  so showing another piece of equipment takes the same time, and allocates
+  nothing, whatever the length of its history.
+
+  The date is given to the view as a QDate, so it is edited with a date
+  editor and never parsed from text. A new date moves the entry to keep
+  the history sorted; the row is moved with it, so the view keeps it
+  current.
+
+  Entries should be added and removed through addEntry() and removeEntry(),
+  so the view is told before the rows change. Edits are reported to the
+  change tracker given with setChangeTracker().
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class EquipmentHistoryModel : public QAbstractTableModel {
+  Q_OBJECT
+public:
+  //! The columns.
+  enum Column_e {
+    e_Date,
+    e_Comment,
+    e_NumColumns
+  };
+
+  EquipmentHistoryModel(QObject* pcParent = 0);
+  virtual ~EquipmentHistoryModel();
+
+  void setChangeTracker(ChangeTracker* pcTracker);
+  void setEquipment(EquipmentLog* pcEquipment);
+  //! Get the equipment shown, or 0 if there is none.
+  EquipmentLog* equipment() const { return m_pcEquipment; }
+
+  int addEntry(const QDate& cDate);
+  void removeEntry(int nRow);
+
+  virtual int rowCount(const QModelIndex& cParent = QModelIndex()) const;
+  virtual int columnCount(const QModelIndex& cParent = QModelIndex()) const;
+  virtual QVariant data(const QModelIndex& cIndex,
+                        int nRole = Qt::DisplayRole) const;
+  virtual QVariant headerData(int nSection, Qt::Orientation eOrientation,
+                              int nRole = Qt::DisplayRole) const;
+  virtual Qt::ItemFlags flags(const QModelIndex& cIndex) const;
+  virtual bool setData(const QModelIndex& cIndex, const QVariant& cValue,
+                       int nRole = Qt::EditRole);
+
+private:
+  //! Disabled copy constructor.
+  EquipmentHistoryModel(const EquipmentHistoryModel&);
+  //! Disabled assignment operator.
+  EquipmentHistoryModel& operator =(const EquipmentHistoryModel&);
+
+  bool setDate(int nRow, const QDate& cDate);
+  void entryChanged(bool isDateChanged);
+
+  //! The equipment shown, or 0.
+  EquipmentLog*  m_pcEquipment;
+  //! The change tracker to report edits to, or 0.
+  ChangeTracker* m_pcTracker;
+};
+
+#endif // EQUIPMENTHISTORYMODEL_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
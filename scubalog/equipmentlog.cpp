@@ -12,6 +12,8 @@
 //*****************************************************************************
 
 #include "equipmentlog.h"
+#include <algorithm>
+#include <assert.h>
 
 //*****************************************************************************
 /*!
@@ -32,32 +34,81 @@ EquipmentLog::EquipmentLog()
 
 EquipmentLog::~EquipmentLog()
 {
-  // Delete the history entries
-  while ( !m_cHistory.isEmpty() ) {
-    delete m_cHistory.takeFirst();
-  }
 }
 
 
 //*****************************************************************************
 /*!
-  Create an history entry.
+  Add a history entry with the date \a cDate and the comment \a cComment.
+  The entry is put after any entries with the same date.
+  Returns the index of the new entry.
+
+  Entries added in date order are appended, so reading a history is linear.
+*/
+//*****************************************************************************
+
+int
+EquipmentLog::addHistoryEntry(const QDate& cDate, const QString& cComment)
+{
+  const int nEntry =
+    std::upper_bound(m_acHistoryDates.constBegin(),
+                     m_acHistoryDates.constEnd(), cDate)
+    - m_acHistoryDates.constBegin();
+  m_acHistoryDates.insert(nEntry, cDate);
+  m_acHistoryComments.insert(nEntry, cComment);
+  return nEntry;
+}
+
+
+//*****************************************************************************
+/*!
+  Change the date of the history entry \a nEntry to \a cDate.
+  The entry is moved to keep the history sorted; it is put after any other
+  entries with the same date. Returns the new index of the entry.
+*/
+//*****************************************************************************
+
+int
+EquipmentLog::setHistoryDate(int nEntry, const QDate& cDate)
+{
+  assert(nEntry >= 0 && nEntry < historyCount());
+  if ( cDate == m_acHistoryDates.at(nEntry) )
+    return nEntry;
+
+  const QString cComment = m_acHistoryComments.at(nEntry);
+  removeHistoryEntry(nEntry);
+  return addHistoryEntry(cDate, cComment);
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the history entry \a nEntry.
 */
 //*****************************************************************************
 
-EquipmentHistoryEntry::EquipmentHistoryEntry()
+void
+EquipmentLog::removeHistoryEntry(int nEntry)
 {
+  assert(nEntry >= 0 && nEntry < historyCount());
+  m_acHistoryDates.remove(nEntry);
+  m_acHistoryComments.remove(nEntry);
 }
 
 
 //*****************************************************************************
 /*!
-  Destroy the history entry.
+  Get the index of the first history entry on or after \a cDate, or
+  historyCount() if there is none.
 */
 //*****************************************************************************
 
-EquipmentHistoryEntry::~EquipmentHistoryEntry()
+int
+EquipmentLog::findHistory(const QDate& cDate) const
 {
+  return std::lower_bound(m_acHistoryDates.constBegin(),
+                          m_acHistoryDates.constEnd(), cDate)
+    - m_acHistoryDates.constBegin();
 }
 
 
@@ -16,43 +16,7 @@
 
 #include <qstring.h>
 #include <qdatetime.h>
-#include <qlist.h>
-
-//*****************************************************************************
-/*!
-  \class EquipmentHistoryEntry
-  \brief The EquipmentHistoryEntry is used to hold equipment history events.
-
-  Each history entry consists of a date and a comment explaining what
-  happened.
-
-  History entries should include events like date of purchase, major
-  service occasions, failures and other special incidents.
-
-  \author André Johansen
-*/
-//*****************************************************************************
-
-class EquipmentHistoryEntry {
-public:
-  EquipmentHistoryEntry();
-  ~EquipmentHistoryEntry();
-
-  //! Get the date for the history entry.
-  const QDate date() const { return m_cDate; }
-  //! Set the date for the history entry.
-  void setDate(const QDate cDate) { m_cDate = cDate; }
-  //! Get the comment for the history entry.
-  const QString comment() const { return m_cComment; }
-  //! Set the comment for the history entry.
-  void setComment(const QString& cComment) { m_cComment = cComment; }
-
-private:
-  //! The date of the event.
-  QDate   m_cDate;
-  //! An explanation of the event.
-  QString m_cComment;
-};
+#include <qvector.h>
 
 
 //*****************************************************************************
@@ -63,6 +27,16 @@ private:
   Each log holds the name, serial number, service type and history of one
   piece of equipment.
 
+  The history is a list of events, each with a date and a comment
+  explaining what happened. It should include events like date of
+  purchase, major service occasions, failures and other special incidents.
+
+  The history is kept sorted on the date. The dates and the comments are
+  kept in two arrays, so searching the dates doesn't touch the comments,
+  and an entry costs no allocation of its own. Entries are given by their
+  index, which changes when an entry is added or removed before it, or
+  when its date is changed.
+
   \author André Johansen
 */
 //*****************************************************************************
@@ -91,9 +65,25 @@ public:
   void setServiceRequirements(const QString& cServiceRequirements ) {
     m_cServiceRequirements = cServiceRequirements;
   }
-  //! Get the history for this equipment item.
-  QList<EquipmentHistoryEntry*>& history() { return m_cHistory; }
-  const QList<EquipmentHistoryEntry*>& history() const { return m_cHistory; }
+
+  //! Get the number of history entries.
+  int historyCount() const { return m_acHistoryDates.count(); }
+  //! Get the date of the history entry \a nEntry.
+  QDate historyDate(int nEntry) const { return m_acHistoryDates.at(nEntry); }
+  //! Get the comment of the history entry \a nEntry.
+  QString historyComment(int nEntry) const {
+    return m_acHistoryComments.at(nEntry);
+  }
+  //! Get the dates of the history entries, in ascending order.
+  const QVector<QDate>& historyDates() const { return m_acHistoryDates; }
+  int addHistoryEntry(const QDate& cDate, const QString& cComment);
+  int setHistoryDate(int nEntry, const QDate& cDate);
+  //! Set the comment of the history entry \a nEntry to \a cComment.
+  void setHistoryComment(int nEntry, const QString& cComment) {
+    m_acHistoryComments[nEntry] = cComment;
+  }
+  void removeHistoryEntry(int nEntry);
+  int findHistory(const QDate& cDate) const;
 
 private:
   //! The type of equipment (i.e. mask, regulators).
@@ -104,8 +94,10 @@ private:
   QString m_cSerial;
   //! The service requirements.
   QString m_cServiceRequirements;
-  //! The history.
-  QList<EquipmentHistoryEntry*> m_cHistory;
+  //! The dates of the history entries, in ascending order.
+  QVector<QDate>   m_acHistoryDates;
+  //! The comments of the history entries, in the same order as the dates.
+  QVector<QString> m_acHistoryComments;
 };
 
 #endif // EQUIPMENTLOG_H
@@ -14,21 +14,24 @@
 #include "equipmentview.h"
 #include "equipmentlog.h"
 #include "logbook.h"
-#include "kdateedit.h"
-#include "kdatevalidator.h"
-#include "dateitem.h"
-#include "debug.h"
+#include "changetracker.h"
+#include "equipmenthistorymodel.h"
+#include "serviceindex.h"
 
 #include <KLocalizedString>
 #include <QHeaderView>
 #include <QListWidget>
+#include <QTableView>
 #include <qlayout.h>
 #include <qpushbutton.h>
 #include <qlineedit.h>
 #include <qlabel.h>
+#include <qspinbox.h>
+#include <qstringlist.h>
 #include <qsplitter.h>
 #include <qwidget.h>
 #include <qmenu.h>
+#include <qevent.h>
 #include <assert.h>
 #include <stdio.h>
 
@@ -41,6 +44,7 @@
 EquipmentView::EquipmentView(QWidget* pcParent)
   : QWidget(pcParent),
     m_pcLogBook(0),
+    m_pcTracker(0),
     m_pcItemView(0),
     m_pcNew(0),
     m_pcDelete(0),
@@ -50,8 +54,12 @@ EquipmentView::EquipmentView(QWidget* pcParent)
     m_pcType(0),
     m_pcSerial(0),
     m_pcService(0),
+    m_pcServiceInterval(0),
+    m_pcDueText(0),
     m_pcLogView(0),
-    m_pcLogEntryMenu(0)
+    m_pcHistory(0),
+    m_pcLogEntryMenu(0),
+    m_isListFilled(false)
 {
   QSplitter* pcSplitter =
     new QSplitter(Qt::Vertical, this);
@@ -109,15 +117,25 @@ EquipmentView::EquipmentView(QWidget* pcParent)
   connect(m_pcService, SIGNAL(textChanged(const QString&)),
           SLOT(itemServiceChanged(const QString&)));
 
-  m_pcLogView = new QTableWidget(0, 2, pcSplitter);
-  m_pcLogView->setSelectionMode(QTableWidget::SingleSelection);
+  QLabel* pcIntervalText = new QLabel(pcTop);
+  pcIntervalText->setText(i18n("Service every: "));
+
+  m_pcServiceInterval = new QSpinBox(pcTop);
+  m_pcServiceInterval->setRange(1, 3650);
+  m_pcServiceInterval->setValue(365);
+  m_pcServiceInterval->setSuffix(i18n(" days"));
+  connect(m_pcServiceInterval, SIGNAL(valueChanged(int)),
+          SLOT(updateDueText()));
+
+  m_pcDueText = new QLabel(pcTop);
+  m_pcDueText->setWordWrap(true);
+
+  m_pcHistory = new EquipmentHistoryModel(this);
+  m_pcLogView = new QTableView(pcSplitter);
+  m_pcLogView->setModel(m_pcHistory);
+  m_pcLogView->setSelectionMode(QTableView::SingleSelection);
   m_pcLogView->verticalHeader()->hide();
-  QStringList hl;
-  hl.append(i18n("Date"));
-  hl.append(i18n("Event"));
-  m_pcLogView->setHorizontalHeaderLabels(hl);
-  connect(m_pcLogView, SIGNAL(itemChanged(QTableWidgetItem*)),
-          SLOT(logEntryChanged(QTableWidgetItem*)));
+  m_pcLogView->horizontalHeader()->setStretchLastSection(true);
   m_pcLogView->setContextMenuPolicy(Qt::CustomContextMenu);
   connect(m_pcLogView, SIGNAL(customContextMenuRequested(const QPoint&)),
           SLOT(showLogEntryMenu(const QPoint&)));
@@ -139,6 +157,8 @@ EquipmentView::EquipmentView(QWidget* pcParent)
   m_pcSerial->setMinimumSize(m_pcSerial->sizeHint());
   pcServiceText->setMinimumSize(pcServiceText->sizeHint());
   m_pcService->setMinimumSize(m_pcService->sizeHint());
+  pcIntervalText->setMinimumSize(pcIntervalText->sizeHint());
+  m_pcServiceInterval->setMinimumSize(m_pcServiceInterval->sizeHint());
 
   QBoxLayout* pcSplitLayout = new QVBoxLayout(this);
   pcSplitLayout->addWidget(pcSplitter);
@@ -164,6 +184,9 @@ EquipmentView::EquipmentView(QWidget* pcParent)
   pcInfoLayout->addWidget(m_pcSerial,     0, 3);
   pcInfoLayout->addWidget(pcServiceText,  1, 0);
   pcInfoLayout->addWidget(m_pcService, 1, 1, 1, 3);
+  pcInfoLayout->addWidget(pcIntervalText, 2, 0);
+  pcInfoLayout->addWidget(m_pcServiceInterval, 2, 1);
+  pcInfoLayout->addWidget(m_pcDueText, 2, 2, 1, 2);
   pcTopLayout->activate();
 }
 
@@ -183,19 +206,64 @@ EquipmentView::~EquipmentView()
 /*!
   Set the log book to \a pcLogBook.
 
-  This function will update the view. If a null-pointer is passed,
-  the view will be cleared and the widgets will be disabled.
+  The equipment list is filled in when the view is shown, so a log book can be
+  opened without filling views that are never looked at. If a null-pointer
+  is passed, the view will be cleared and the widgets will be disabled.
 */
 //*****************************************************************************
 
 void
 EquipmentView::setLogBook(LogBook* pcLogBook)
 {
+  if ( m_pcTracker )
+    disconnect(m_pcTracker, 0, this, 0);
   m_pcLogBook = pcLogBook;
-  if ( pcLogBook ) {
+  m_pcTracker = pcLogBook ? &pcLogBook->changeTracker() : 0;
+  if ( m_pcTracker )
+    connect(m_pcTracker, SIGNAL(changed()), SLOT(logBookChanged()));
+  m_pcHistory->setEquipment(0);
+  m_pcHistory->setChangeTracker(pcLogBook ? &pcLogBook->changeTracker() : 0);
+  m_isListFilled = false;
+  if ( isVisible() )
+    fillList();
+}
+
+
+//*****************************************************************************
+/*!
+  The view is about to be shown. Fill in the equipment list if it doesn't
+  show the current log book yet, and find the items due for service, as
+  the log book may have changed while the view was hidden.
+*/
+//*****************************************************************************
+
+void
+EquipmentView::showEvent(QShowEvent* pcEvent)
+{
+  if ( false == m_isListFilled )
+    fillList();
+  else
+    updateDueText();
+  QWidget::showEvent(pcEvent);
+}
+
+
+//*****************************************************************************
+/*!
+  Fill in the equipment list from the log book, and update the rest
+  of the view.
+*/
+//*****************************************************************************
+
+void
+EquipmentView::fillList()
+{
+  m_isListFilled = true;
+  updateDueText();
+  if ( m_pcLogBook ) {
     m_pcItemView->clear();
     m_pcItemView->setUpdatesEnabled(false);
-    QList<EquipmentLog*>& cEquipment = pcLogBook->equipmentLog();
+    QList<EquipmentLog*>& cEquipment = m_pcLogBook->equipmentLog();
     QListIterator<EquipmentLog*> iEquipment(cEquipment);
     while ( iEquipment.hasNext() ) {
       EquipmentLog* pcItem = iEquipment.next();
@@ -218,7 +286,7 @@ EquipmentView::setLogBook(LogBook* pcLogBook)
       m_pcType->setText("");
       m_pcSerial->setText("");
       m_pcService->setText("");
-      m_pcLogView->setRowCount(0);
+      m_pcHistory->setEquipment(0);
     }
   }
   else {
@@ -230,16 +298,66 @@ EquipmentView::setLogBook(LogBook* pcLogBook)
     m_pcType->setText("");
     m_pcSerial->setText("");
     m_pcService->setText("");
-    m_pcLogView->setRowCount(0);
+    m_pcHistory->setEquipment(0);
   }
 }
 
 
 //*****************************************************************************
 /*!
-  The item with index \a nItemNumber has been selected.
+  The log book has changed. If the view is shown, find the items due for
+  service again, as the change may be to a history.
+*/
+//*****************************************************************************
+
+void
+EquipmentView::logBookChanged()
+{
+  if ( isVisible() )
+    updateDueText();
+}
 
-  Update the rest of the GUI.
+
+//*****************************************************************************
+/*!
+  Show the items due for service within #e_DueWithinDays days, serviced
+  at the interval set.
+
+  The service index of the log book is only built again if the dates in
+  the equipment history have changed, so this is cheap to call.
+*/
+//*****************************************************************************
+
+void
+EquipmentView::updateDueText()
+{
+  if ( 0 == m_pcLogBook ) {
+    m_pcDueText->setText("");
+    return;
+  }
+  const QDate cDate = QDate::currentDate().addDays(e_DueWithinDays);
+  const QList<EquipmentLog*> cDue =
+    m_pcLogBook->serviceIndex().dueForService(cDate,
+                                              m_pcServiceInterval->value());
+  if ( cDue.isEmpty() ) {
+    m_pcDueText->setText(i18n("Nothing is due for service within %1 days.",
+                              int(e_DueWithinDays)));
+    return;
+  }
+  QStringList cNames;
+  for ( int iItem = 0; iItem < cDue.count(); ++iItem )
+    cNames.append(cDue.at(iItem)->name());
+  m_pcDueText->setText(i18n("Due for service within %1 days: %2",
+                            int(e_DueWithinDays), cNames.join(", ")));
+}
+
+
+//*****************************************************************************
+/*!
+  The current equipment item has changed.
+
+  Update the rest of the GUI. The history table is given the new item
+  through its model, so nothing is built for it.
 */
 //*****************************************************************************
 
@@ -260,18 +378,7 @@ EquipmentView::itemSelected()
   m_pcType->setText(pcLog->type());
   m_pcSerial->setText(pcLog->serialNumber());
   m_pcService->setText(pcLog->serviceRequirements());
-
-  QList<EquipmentHistoryEntry*>& cHistory = pcLog->history();
-  const unsigned int nNumRows = cHistory.count();
-  m_pcLogView->setRowCount(nNumRows);
-  QList<EquipmentHistoryEntry*>::const_iterator i = cHistory.begin();
-  for ( int iRow = 0; i != cHistory.end(); ++i, ++iRow ) {
-    const EquipmentHistoryEntry* pcEntry = (*i);
-    QString cDateText(pcEntry->date().toString());
-    DateItem* pcDateItem = new DateItem(cDateText);
-    m_pcLogView->setItem(iRow, 0, pcDateItem);
-    m_pcLogView->setItem(iRow, 1, new QTableWidgetItem(pcEntry->comment()));
-  }
+  m_pcHistory->setEquipment(pcLog);
 }
 
 
@@ -288,6 +395,7 @@ EquipmentView::newItem()
   QList<EquipmentLog*>& cEquipmentLogList = m_pcLogBook->equipmentLog();
   EquipmentLog* pcLog = new EquipmentLog();
   cEquipmentLogList.append(pcLog);
+  m_pcLogBook->changeTracker().equipmentChanged(pcLog);
   m_pcItemView->addItem(new QListWidgetItem());
   m_pcItemView->setCurrentItem(m_pcItemView->item(m_pcItemView->count()-1));
   m_pcItemName->setText("");
@@ -322,8 +430,14 @@ EquipmentView::deleteItem()
   if ( -1 == nCurrentItem )
     return;
   assert(cEquipmentLogList.count() > nCurrentItem);
+  // Take the log out before the list item, so the new current item
+  // is looked up in the list without it
+  EquipmentLog* pcLog = cEquipmentLogList.takeAt(nCurrentItem);
+  if ( m_pcHistory->equipment() == pcLog )
+    m_pcHistory->setEquipment(0);
   delete m_pcItemView->item(nCurrentItem);
-  delete cEquipmentLogList.takeAt(nCurrentItem);
+  m_pcLogBook->changeTracker().equipmentRemoved(pcLog);
+  delete pcLog;
 
   // Update the view with the new current item, if any
   unsigned int nNumItems = m_pcItemView->count();
@@ -357,6 +471,7 @@ EquipmentView::moveCurrentUp()
   QList<EquipmentLog*>& cEquipmentLogList = m_pcLogBook->equipmentLog();
   EquipmentLog* pcLog = cEquipmentLogList.takeAt(nCurrentItem);
   cEquipmentLogList.insert(nCurrentItem-1, pcLog);
+  m_pcLogBook->changeTracker().equipmentChanged(pcLog);
 
   QString cName(m_pcItemView->item(nCurrentItem)->text());
   delete m_pcItemView->item(nCurrentItem);
@@ -386,6 +501,7 @@ EquipmentView::moveCurrentDown()
   QList<EquipmentLog*>& cEquipmentLogList = m_pcLogBook->equipmentLog();
   EquipmentLog* pcLog = cEquipmentLogList.takeAt(nCurrentItem);
   cEquipmentLogList.insert(nCurrentItem+1, pcLog);
+  m_pcLogBook->changeTracker().equipmentChanged(pcLog);
 
   QString cName(m_pcItemView->item(nCurrentItem)->text());
   delete m_pcItemView->item(nCurrentItem);
@@ -415,6 +531,7 @@ EquipmentView::changeItemName()
   EquipmentLog* pcLog = cEquipmentLogList.at(nCurrentItem);
   QString cName(m_pcItemName->text());
   pcLog->setName(cName);
+  m_pcLogBook->changeTracker().equipmentChanged(pcLog);
   m_pcItemName->hide();
   m_pcItemView->item(nCurrentItem)->setText(cName);
   m_pcItemView->setFocus();
@@ -457,8 +574,9 @@ EquipmentView::itemTypeChanged(const QString& cType)
   int i = m_pcItemView->currentRow();
   if ( i >= 0 && i < cEquipmentLogList.count() ) {
     EquipmentLog* pcLog = cEquipmentLogList.at(i);
-    if ( pcLog ) {
+    if ( pcLog && pcLog->type() != cType ) {
       pcLog->setType(cType);
+      m_pcLogBook->changeTracker().equipmentChanged(pcLog);
     }
   }
 }
@@ -480,8 +598,9 @@ EquipmentView::itemSerialChanged(const QString& cSerial)
   int i = m_pcItemView->currentRow();
   if ( i >= 0 && i < cEquipmentLogList.count() ) {
     EquipmentLog* pcLog = cEquipmentLogList.at(i);
-    if ( pcLog ) {
+    if ( pcLog && pcLog->serialNumber() != cSerial ) {
       pcLog->setSerialNumber(cSerial);
+      m_pcLogBook->changeTracker().equipmentChanged(pcLog);
     }
   }
 }
@@ -503,58 +622,14 @@ EquipmentView::itemServiceChanged(const QString& cService)
   int i = m_pcItemView->currentRow();
   if ( i >= 0 && i < cEquipmentLogList.count() ) {
     EquipmentLog* pcLog = cEquipmentLogList.at(i);
-    if ( pcLog ) {
+    if ( pcLog && pcLog->serviceRequirements() != cService ) {
       pcLog->setServiceRequirements(cService);
+      m_pcLogBook->changeTracker().equipmentChanged(pcLog);
     }
   }
 }
 
 
-//*****************************************************************************
-/*!
-  The log entry in cell containing item \a item has been changed.
-
-  Save the text for later use.
-*/
-//*****************************************************************************
-
-void
-EquipmentView::logEntryChanged(QTableWidgetItem* item)
-{
-  int nCurrentItem = m_pcItemView->currentRow();
-  if ( nCurrentItem < 0 )
-    return;
-
-  int nRow = item->row();
-  int nCol = item->column();
-
-  QList<EquipmentLog*>& cEquipmentLogList = m_pcLogBook->equipmentLog();
-  EquipmentLog* pcLog = cEquipmentLogList.at(nCurrentItem);
-  if ( 0 == pcLog )
-    return;
-  QList<EquipmentHistoryEntry*>& cHistory = pcLog->history();
-  while ( cHistory.count() <= nRow )
-    cHistory.append(new EquipmentHistoryEntry());
-  EquipmentHistoryEntry& cEntry = *cHistory.at(nRow);
-  // Convert text to date
-  if ( 0 == nCol ) {
-    QTableWidgetItem* pcItem = m_pcLogView->item(nRow, nCol);
-    assert(pcItem != 0);
-    QDate cDate(KDateValidator::convertToDate(pcItem->text()));
-    if ( !cDate.isNull() ) {
-      cEntry.setDate(cDate);
-    }
-    else {
-      DBG(("EquipmentView::logEntryChanged(): Invalid date \"%s\"\n",
-           pcItem->text().toUtf8().constData()));
-    }
-  }
-  else {
-    const QString cComment = m_pcLogView->item(nRow, nCol)->text();
-    cEntry.setComment(cComment);
-  }
-}
-
 //*****************************************************************************
 /*!
   Create the menu to use in the log entry view.
@@ -600,8 +675,8 @@ EquipmentView::showLogEntryMenu(const QPoint& i_cPos)
 
 //*****************************************************************************
 /*!
-  Create a new log entry.
-  New entries are always inserted at the end.
+  Create a new log entry for the current item, dated today.
+  The entry is inserted where the date puts it in the history.
 */
 //*****************************************************************************
 
@@ -609,14 +684,14 @@ void
 EquipmentView::newLogEntry()
 {
   assert(m_pcLogView);
+  EquipmentLog* pcLog = currentItem();
+  if ( 0 == pcLog )
+    return;
 
-  const int nNewRow = m_pcLogView->rowCount();
-
-  m_pcLogView->insertRow(nNewRow);
-  QString today = QDate::currentDate().toString();
-  DateItem* pcDateItem = new DateItem(today);
-  m_pcLogView->setItem(nNewRow, 0, pcDateItem);
-  m_pcLogView->setCurrentCell(nNewRow, 0);
+  assert(m_pcHistory->equipment() == pcLog);
+  const int nNewRow = m_pcHistory->addEntry(QDate::currentDate());
+  m_pcLogView->setCurrentIndex(
+    m_pcHistory->index(nNewRow, EquipmentHistoryModel::e_Date));
 }
 
 
@@ -630,7 +705,30 @@ void
 EquipmentView::deleteLogEntry()
 {
   assert(m_pcLogView);
-  m_pcLogView->removeRow(m_pcLogView->currentRow());
+  EquipmentLog* pcLog = currentItem();
+  const int nRow = m_pcLogView->currentIndex().row();
+  if ( 0 == pcLog || nRow < 0 || nRow >= pcLog->historyCount() )
+    return;
+
+  m_pcHistory->removeEntry(nRow);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the selected equipment item, or 0 if none is selected.
+*/
+//*****************************************************************************
+
+EquipmentLog*
+EquipmentView::currentItem() const
+{
+  assert(m_pcLogBook);
+  const QList<EquipmentLog*>& cEquipmentLogList = m_pcLogBook->equipmentLog();
+  const int nItem = m_pcItemView->currentRow();
+  if ( nItem < 0 || nItem >= cEquipmentLogList.count() )
+    return 0;
+  return cEquipmentLogList.at(nItem);
 }
 
 
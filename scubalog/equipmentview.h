@@ -22,9 +22,14 @@ class QListWidgetItem;
 class QPushButton;
 class QLineEdit;
 class LogBook;
+class EquipmentLog;
 class QMenu;
-class QTableWidget;
-class QTableWidgetItem;
+class QTableView;
+class EquipmentHistoryModel;
+class QShowEvent;
+class QLabel;
+class QSpinBox;
+class ChangeTracker;
 
 //*****************************************************************************
 /*!
@@ -34,6 +39,13 @@ class QTableWidgetItem;
   A log book may contain descriptions of the divers equipment, together
   with a history, service requirements etc.
 
+  Below the item editors, the view tells which items are due for service
+  within #e_DueWithinDays days, if they are serviced as often as the
+  interval set. The service requirements are free text, so the interval is
+  set here, and an item is counted from the last entry in its history.
+  The items are found with LogBook::serviceIndex(), and found again when
+  the log book changes while the view is shown.
+
   \author André Hübert Johansen
 */
 //*****************************************************************************
@@ -41,11 +53,17 @@ class QTableWidgetItem;
 class EquipmentView : public QWidget {
   Q_OBJECT
 public:
+  //! The number of days ahead to look for items due for service.
+  enum { e_DueWithinDays = 30 };
+
   EquipmentView(QWidget* pcParent);
   virtual ~EquipmentView();
 
   void setLogBook(LogBook* pcLogBook);
 
+protected:
+  virtual void showEvent(QShowEvent* pcEvent);
+
 private slots:
   void newItem();
   void deleteItem();
@@ -55,19 +73,24 @@ private slots:
   void itemTypeChanged(const QString& cType);
   void itemSerialChanged(const QString& cSerial);
   void itemServiceChanged(const QString& cService);
-  void logEntryChanged(QTableWidgetItem* item);
   void newLogEntry();
   void deleteLogEntry();
   void moveCurrentUp();
   void moveCurrentDown();
   void showLogEntryMenu(const QPoint& i_cPos);
+  void logBookChanged();
+  void updateDueText();
 
 private:
+  void fillList();
   void createLogEntryMenu();
+  EquipmentLog* currentItem() const;
 
 private:
   //! The log book.
   LogBook*       m_pcLogBook;
+  //! The change tracker of the log book, or 0.
+  ChangeTracker* m_pcTracker;
   //! The equipment list view.
   QListWidget*   m_pcItemView;
   //! The new item button.
@@ -86,10 +109,18 @@ private:
   QLineEdit*     m_pcSerial;
   //! The service editor.
   QLineEdit*     m_pcService;
+  //! The service interval editor, in days.
+  QSpinBox*      m_pcServiceInterval;
+  //! The items due for service.
+  QLabel*        m_pcDueText;
   //! The log edit view.
-  QTableWidget*  m_pcLogView;
+  QTableView*    m_pcLogView;
+  //! The model of the history shown in the log edit view.
+  EquipmentHistoryModel* m_pcHistory;
   //! The context menu used in the log for an entry.
   QMenu*         m_pcLogEntryMenu;
+  //! Whether the equipment list view shows the current log book.
+  bool           m_isListFilled;
 };
 
 #endif // EQUIPMENTVIEW_H
@@ -14,6 +14,8 @@
 #ifndef EXPORTER_H
 #define EXPORTER_H
 
+#include "diveselection.h"
+
 class DiveLog;
 class LogBook;
 class QString;
@@ -38,7 +40,13 @@ public:
                          const QString& cName) const = 0;
   //! Export the logbook \a cLogBook to  \a cName.
   virtual bool exportLogBook(const LogBook& cLogBook,
-                             const QString& cName) const = 0;
+                             const QString& cName) const {
+    return exportLogs(cLogBook, DiveSelection(), cName);
+  }
+  //! Export the logs in \a cSelection from \a cLogBook to \a cName.
+  virtual bool exportLogs(const LogBook&       cLogBook,
+                          const DiveSelection& cSelection,
+                          const QString&       cName) const = 0;
 };
 
 #endif // EXPORTER_H
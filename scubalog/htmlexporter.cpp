@@ -16,14 +16,19 @@
 #include "locationlog.h"
 #include "divelog.h"
 #include "divelist.h"
+#include "searchindex.h"
 #include "debug.h"
 #include <KLocalizedString>
+#include <KZip>
 #include <qregexp.h>
 #include <qmessagebox.h>
 #include <qtextstream.h>
 #include <qfile.h>
 #include <qdir.h>
+#include <qfileinfo.h>
+#include <qbuffer.h>
 #include <qlist.h>
+#include <qmap.h>
 #include <QApplication>
 #include <assert.h>
 #include <limits.h>
@@ -36,6 +41,9 @@
 //*****************************************************************************
 
 HTMLExporter::HTMLExporter()
+  : m_ePagination(e_PageByCount),
+    m_nLogsPerPage(500),
+    m_pcArchive(0)
 {
 }
 
@@ -51,6 +59,21 @@ HTMLExporter::~HTMLExporter()
 }
 
 
+//*****************************************************************************
+/*!
+  Set the way the dive log index is split into pages to \a ePagination.
+  When paginating by count, each page lists at most \a nLogsPerPage logs.
+*/
+//*****************************************************************************
+
+void
+HTMLExporter::setPagination(Pagination_e ePagination, int nLogsPerPage)
+{
+  m_ePagination  = ePagination;
+  m_nLogsPerPage = nLogsPerPage > 0 ? nLogsPerPage : 1;
+}
+
+
 //*****************************************************************************
 /*!
   Export the log \a cLog to the file \a cFileName.
@@ -70,14 +93,16 @@ HTMLExporter::exportLog(const DiveLog& /*cLog*/,
 
 //*****************************************************************************
 /*!
-  Export the logbook \a cLogBook to the directory \a cDirName.
+  Export the logs in \a cSelection from the logbook \a cLogBook to the
+  directory \a cDirName. All the location logs are exported.
   Returns `true' on success, `false' on failure.
 */
 //*****************************************************************************
 
 bool
-HTMLExporter::exportLogBook(const LogBook& cLogBook,
-                            const QString& cDirName) const
+HTMLExporter::exportLogs(const LogBook&       cLogBook,
+                         const DiveSelection& cSelection,
+                         const QString&       cDirName) const
 {
   QDir cOutputDir(cDirName);
   if ( false == cOutputDir.exists() ) {
@@ -89,11 +114,80 @@ HTMLExporter::exportLogBook(const LogBook& cLogBook,
     }
   }
 
+  return exportPages(cLogBook, cSelection.indices(cLogBook.diveList()),
+                     cDirName);
+}
+
+
+//*****************************************************************************
+/*!
+  Export the logs in \a cSelection from the logbook \a cLogBook to the
+  zip archive \a cFileName. The pages are stored in a directory named
+  after the archive, and are compressed with deflate if \a isCompressed
+  is `true'.
+
+  Each page is generated into memory and added to the archive before
+  the next is started, so no temporary files are used.
+
+  Returns `true' on success, `false' on failure.
+*/
+//*****************************************************************************
+
+bool
+HTMLExporter::exportArchive(const LogBook&       cLogBook,
+                            const DiveSelection& cSelection,
+                            const QString&       cFileName,
+                            bool                 isCompressed) const
+{
+  KZip cArchive(cFileName);
+  if ( false == cArchive.open(QIODevice::WriteOnly) ) {
+    QString cMessage;
+    cMessage = QString(i18n("Couldn't open file for output"))
+      + "\n(`" + cFileName + "')";
+    errorMessage(cMessage);
+    return false;
+  }
+  cArchive.setCompression(isCompressed ? KZip::DeflateCompression
+                                       : KZip::NoCompression);
+
+  m_pcArchive = &cArchive;
+  bool isOk = exportPages(cLogBook, cSelection.indices(cLogBook.diveList()),
+                          QFileInfo(cFileName).completeBaseName());
+  m_pcArchive = 0;
+
+  if ( false == cArchive.close() && isOk ) {
+    QString cMessage;
+    cMessage = QString(i18n("Error writing to file"))
+      + "\n`" + cFileName + "'!";
+    errorMessage(cMessage);
+    isOk = false;
+  }
+  if ( false == isOk )
+    QFile::remove(cFileName);
+
+  return isOk;
+}
+
+
+//*****************************************************************************
+/*!
+  Export all the pages for the logs at the ascending indices \a anLogs in
+  the logbook \a cLogBook, to the directory \a cDirName or to the archive
+  being written. The previous and next links of a log lead to the
+  neighbouring logs in \a anLogs.
+  Returns `true' on success, `false' on failure.
+*/
+//*****************************************************************************
+
+bool
+HTMLExporter::exportPages(const LogBook&      cLogBook,
+                          const QVector<int>& anLogs,
+                          const QString&      cDirName) const
+{
   const QDate cCurrentDate(QDate::currentDate());
   const DiveList& cDiveList = cLogBook.diveList();
-  QListIterator<DiveLog*> iLog(cDiveList);
 
-  bool isIndexOk = exportIndex(cLogBook, cDirName);
+  bool isIndexOk = exportIndex(cLogBook, anLogs, cDirName);
   if ( false == isIndexOk )
     return false;
 
@@ -103,25 +197,18 @@ HTMLExporter::exportLogBook(const LogBook& cLogBook,
 
 
   //
-  // Export the dive logs
+  // Export the dive logs, building the search index on the way
   //
-  while ( iLog.hasNext() ) {
-    const DiveLog* pcCurrentLog = iLog.next();
+  SearchIndex cSearchIndex;
+  for ( int iLog = 0; iLog < anLogs.count(); ++iLog ) {
+    const DiveLog* pcCurrentLog = cDiveList.at(anLogs.at(iLog));
+    cSearchIndex.addLog(*pcCurrentLog);
     QString cLogNumber;
     cLogNumber.setNum(pcCurrentLog->logNumber());
-    QString cFileName(cDirName);
-    cFileName += "/";
-    cFileName += cLogNumber;
-    cFileName += ".html";
-    QFile cFile(cFileName);
-    bool isOpen = cFile.open(QIODevice::WriteOnly);
-    if ( false == isOpen ) {
-      QString cMessage;
-      cMessage = QString(i18n("Couldn't open file for output"))
-        + "\n(`" + cFileName + "')";
-      errorMessage(cMessage);
+    const QString cFileName(cLogNumber + ".html");
+    QIODevice* pcPage = openPage(cDirName, cFileName);
+    if ( 0 == pcPage )
       return false;
-    }
 
     // Process the dive description
     QString cDescription(pcCurrentLog->diveDescription());
@@ -130,9 +217,7 @@ HTMLExporter::exportLogBook(const LogBook& cLogBook,
 
     // Create location text
     QString cLocationName;
-    bool isLocationLogged =
-      hasLocation(cLogBook, pcCurrentLog->diveLocation());
-    if ( isLocationLogged ) {
+    if ( pcCurrentLog->location() ) {
       cLocationName += "<A HREF=\""
         + getLocationExportName(pcCurrentLog->diveLocation())
         + "\">" + pcCurrentLog->diveLocation() + "</A>";        
@@ -173,7 +258,7 @@ HTMLExporter::exportLogBook(const LogBook& cLogBook,
     }
 
     // Output
-    QTextStream cStream(&cFile);
+    QTextStream cStream(pcPage);
     cStream << "<HTML>"
             << "<HEAD>\n"
             << "<TITLE>"
@@ -202,18 +287,19 @@ HTMLExporter::exportLogBook(const LogBook& cLogBook,
             << "m<BR>\n"
             << "<B>" << i18n("Dive time") << ":</B> "
             << cDiveTimeText
-            << "<BR>\n"
-            << "<P>\n"
+            << "<BR>\n";
+    writeProfile(cStream, pcCurrentLog->profile());
+    cStream << "<P>\n"
             << cDescription
             << "\n<HR>\n";
-    if ( !iLog.hasPrevious() ) {
-      const DiveLog* pcPreviousLog = iLog.peekPrevious();
+    if ( iLog > 0 ) {
+      const DiveLog* pcPreviousLog = cDiveList.at(anLogs.at(iLog - 1));
       cStream << "<A HREF=\""
               << pcPreviousLog->logNumber()
               << ".html\">" << i18n("Previous log") << "</A> ";
     }
-    if ( iLog.hasNext() ) {
-      const DiveLog* pcNextLog = iLog.peekNext();
+    if ( iLog + 1 < anLogs.count() ) {
+      const DiveLog* pcNextLog = cDiveList.at(anLogs.at(iLog + 1));
       cStream << "<A HREF=\""
               << pcNextLog->logNumber()
               << ".html\">" << i18n("Next log") << "</A> ";
@@ -229,96 +315,167 @@ HTMLExporter::exportLogBook(const LogBook& cLogBook,
             << "</HTML>\n";
 
     // Ensure output was successful
-    if ( cFile.error() != QFile::NoError ) {
+    cStream.flush();
+    if ( false == closePage(pcPage) ) {
       QString cMessage;
       cMessage = QString(i18n("Error outputting log"))
         + "\n(`" + cFileName + "')";
       errorMessage(cMessage);
-      cFile.remove();
       return false;
     }
 
   }
 
-  return true;
+  return exportSearch(cLogBook, cSearchIndex, cDirName);
 }
 
 
 //*****************************************************************************
 /*!
-  Export the dive log and location log index for the log book \a cLogBook
-  to the directory \a cDirName.
+  Export the index of the logs at the indices \a anLogs and all the
+  location logs in the log book \a cLogBook to the directory \a cDirName.
 
-  The output file will be called `logbook.html'.
+  The main index is called `logbook.html'. When paginating by count, the
+  remaining dive logs are listed on `logbook-2.html', `logbook-3.html' and
+  so on. A summary page called `year-YYYY.html' is written for each year.
+
+  The pages are written one at a time, straight to their files; only the
+  year summaries are kept in memory. The logs are gone through twice;
+  once for the summaries, and once for the year pages.
 
   Returns `true' on success and `false' on failure.
 */
 //*****************************************************************************
 
 bool
-HTMLExporter::exportIndex(const LogBook& cLogBook,
-                          const QString& cDirName) const
+HTMLExporter::exportIndex(const LogBook&      cLogBook,
+                          const QVector<int>& anLogs,
+                          const QString&      cDirName) const
 {
-  const QDate cCurrentDate(QDate::currentDate());
   const DiveList& cDiveList = cLogBook.diveList();
-  QListIterator<DiveLog*> iLog(cDiveList);
 
-  const QString cFileName(cDirName + "/logbook.html");
-  QFile cFile(cFileName);
-  bool isOpen = cFile.open(QIODevice::WriteOnly);
-  if ( false == isOpen ) {
-    QString cMessage;
-    cMessage = QString(i18n("Couldn't open file for output"))
-      + "\n(`" + cFileName + "')";
-    errorMessage(cMessage);
-    return false;
+  // Gather the year summaries
+  QMap<int, YearSummary> cYears;
+  QVectorIterator<int> iLog(anLogs);
+  for ( ; iLog.hasNext(); ) {
+    const DiveLog* pcLog = cDiveList.at(iLog.next());
+    const QDate cDate(pcLog->diveDate());
+    YearSummary& cSummary = cYears[cDate.isValid() ? cDate.year() : 0];
+    cSummary.nNumLogs++;
+    const QTime cDiveTime(pcLog->diveTime());
+    if ( cDiveTime.isValid() )
+      cSummary.nDiveSeconds += QTime(0, 0).secsTo(cDiveTime);
+    if ( pcLog->maxDepth() > cSummary.vMaxDepth )
+      cSummary.vMaxDepth = pcLog->maxDepth();
+    cSummary.vDepthSum += pcLog->maxDepth();
   }
-  QTextStream cStream(&cFile);
+
+  int nNumPages = 1;
+  if ( e_PageByCount == m_ePagination && anLogs.count() > 0 )
+    nNumPages = (anLogs.count() + m_nLogsPerPage - 1) / m_nLogsPerPage;
+
+  for ( int iPage = 0; iPage < nNumPages; ++iPage ) {
+    if ( false == exportIndexPage(cLogBook, anLogs, cDirName, cYears,
+                                  iPage, nNumPages) )
+      return false;
+  }
+
+  return exportYears(cLogBook, anLogs, cDirName, cYears);
+}
+
+
+//*****************************************************************************
+/*!
+  Export the index page number \a nPage of \a nNumPages for the logs at
+  the indices \a anLogs in the log book \a cLogBook to the directory
+  \a cDirName.
+
+  The first page also lists the years in \a cYears and the location logs.
+
+  Returns `true' on success and `false' on failure.
+*/
+//*****************************************************************************
+
+bool
+HTMLExporter::exportIndexPage(const LogBook& cLogBook,
+                              const QVector<int>& anLogs,
+                              const QString& cDirName,
+                              const QMap<int, YearSummary>& cYears,
+                              int nPage, int nNumPages) const
+{
+  const DiveList& cDiveList = cLogBook.diveList();
+
+  const QString cFileName(getIndexPageName(nPage));
+  QIODevice* pcPage = openPage(cDirName, cFileName);
+  if ( 0 == pcPage )
+    return false;
+  QTextStream cStream(pcPage);
   cStream << "<HTML>"
           << "<HEAD>\n"
           << "<TITLE>"
           << cLogBook.diverName()
-          << " -- " << i18n("log book index")
-          << "</TITLE>\n"
+          << " -- " << i18n("log book index");
+  if ( nNumPages > 1 )
+    cStream << " (" << nPage + 1 << "/" << nNumPages << ")";
+  cStream << "</TITLE>\n"
           << "</HEAD>\n"
           << "<BODY>\n"
-          << "<H1>" << i18n("Dive logs") << "</H1>\n";
-  for ( ; iLog.hasNext(); ) {
-    const DiveLog* pcCurrentLog = iLog.next();
-    QString cLogNumber;
-    cLogNumber.setNum(pcCurrentLog->logNumber());
-    cStream << "<A HREF=\""
-            << cLogNumber
-            << ".html\">"
-            << cLogNumber
-            << ".</A> "
-            << pcCurrentLog->diveLocation()
-            << "<BR>\n";
-  }
-  cStream << "<H1>" << i18n("Location logs") << "</H1>\n";
-  QListIterator<LocationLog*> iLocation(cLogBook.locationList());
-  for ( ; iLocation.hasNext(); ) {
-    const LocationLog* pcCurrentLog = iLocation.next();
-    cStream << "<A HREF=\""
-            << getLocationExportName(pcCurrentLog->getName())
-            << "\">"
-            << pcCurrentLog->getName()
-            << "</A><BR>\n";
+          << "<A HREF=\"search.html\">" << i18n("Search") << "</A>\n";
+
+  // The dive logs; none are listed here when paginating by year
+  if ( e_PageByYear != m_ePagination ) {
+    int nFirst = 0;
+    int nLast  = anLogs.count();
+    if ( e_PageByCount == m_ePagination ) {
+      nFirst = nPage * m_nLogsPerPage;
+      nLast  = qMin(nLast, nFirst + m_nLogsPerPage);
+    }
+    cStream << "<H1>" << i18n("Dive logs") << "</H1>\n";
+    writePageLinks(cStream, nPage, nNumPages);
+    for ( int iLog = nFirst; iLog < nLast; ++iLog )
+      writeLogLink(cStream, *cDiveList.at(anLogs.at(iLog)));
+    writePageLinks(cStream, nPage, nNumPages);
   }
-  cStream << "<HR>\n"
-          << i18n("Dive log exported from")
-          << " <A HREF=\"http://home.tiscali.no/andrej/scubalog/\">"
-          << "ScubaLog</A> "
-          << cCurrentDate.toString()
-          << "\n"
-          << "</BODY>\n"
-          << "</HTML>\n";
 
+  if ( 0 == nPage ) {
+    cStream << "<H1>" << i18n("Years") << "</H1>\n"
+            << "<TABLE BORDER=\"1\">\n"
+            << "<TR><TH>" << i18n("Year")
+            << "</TH><TH>" << i18n("Dives")
+            << "</TH><TH>" << i18n("Dive time")
+            << "</TH><TH>" << i18n("Maximum depth")
+            << "</TH><TH>" << i18n("Average depth")
+            << "</TH></TR>\n";
+    QMap<int, YearSummary>::const_iterator iYear = cYears.constBegin();
+    for ( ; iYear != cYears.constEnd(); ++iYear ) {
+      cStream << "<TR><TD><A HREF=\"" << getYearExportName(iYear.key())
+              << "\">";
+      if ( iYear.key() )
+        cStream << iYear.key();
+      else
+        cStream << i18n("Unknown");
+      cStream << "</A></TD>";
+      writeSummary(cStream, iYear.value());
+      cStream << "</TR>\n";
+    }
+    cStream << "</TABLE>\n";
 
-  const bool isOk = (cFile.error() == QFile::NoError);
-  cFile.close();
+    cStream << "<H1>" << i18n("Location logs") << "</H1>\n";
+    QListIterator<LocationLog*> iLocation(cLogBook.locationList());
+    for ( ; iLocation.hasNext(); ) {
+      const LocationLog* pcCurrentLog = iLocation.next();
+      cStream << "<A HREF=\""
+              << getLocationExportName(pcCurrentLog->getName())
+              << "\">"
+              << pcCurrentLog->getName()
+              << "</A><BR>\n";
+    }
+  }
+  writeFooter(cStream);
+  cStream.flush();
+
+  const bool isOk = closePage(pcPage);
   if ( !isOk ) {
-    QFile::remove(cFileName);
     QString cMessage;
     cMessage = QString(i18n("Error writing to file"))
       + "\n`" + cFileName + "'!";
@@ -330,6 +487,127 @@ HTMLExporter::exportIndex(const LogBook& cLogBook,
 }
 
 
+//*****************************************************************************
+/*!
+  Export a summary page for each year in \a cYears to the directory
+  \a cDirName, listing the logs at the indices \a anLogs in \a cLogBook
+  from that year. Logs without a valid date use year 0.
+
+  The logs are sorted on date, so the logs of each year follow each other,
+  and one pass writes all the pages, each page finished before the next
+  is started. Only the logs exported are sorted, unless all of them are,
+  when the date view of the dive list is used as it is.
+
+  Returns `true' on success and `false' on failure.
+*/
+//*****************************************************************************
+
+bool
+HTMLExporter::exportYears(const LogBook& cLogBook, const QVector<int>& anLogs,
+                          const QString& cDirName,
+                          const QMap<int, YearSummary>& cYears) const
+{
+  const QVector<DiveLog*> apcByDate =
+    cLogBook.diveList().sortedLogs(DiveList::e_ByDate, anLogs);
+  QTextStream cStream;
+  QIODevice* pcPage = 0;
+  int nYear = 0;
+  for ( int iLog = 0; iLog < apcByDate.count(); ++iLog ) {
+    const DiveLog* pcLog = apcByDate.at(iLog);
+    const QDate cDate(pcLog->diveDate());
+    const int nLogYear = cDate.isValid() ? cDate.year() : 0;
+    if ( 0 == pcPage || nLogYear != nYear ) {
+      if ( pcPage && false == endYear(cStream, pcPage, nYear) )
+        return false;
+      nYear  = nLogYear;
+      pcPage = beginYear(cStream, cLogBook, cDirName,
+                         nYear, cYears.value(nYear));
+      if ( 0 == pcPage )
+        return false;
+    }
+    writeLogLink(cStream, *pcLog);
+  }
+
+  return 0 == pcPage || endYear(cStream, pcPage, nYear);
+}
+
+
+//*****************************************************************************
+/*!
+  Open the summary page for the year \a nYear in the directory \a cDirName,
+  and write the start of it to \a cStream, which is set to write to the
+  page. The page shows the aggregates in \a cSummary.
+
+  Returns the page, to be finished with endYear(), or 0 on failure.
+*/
+//*****************************************************************************
+
+QIODevice*
+HTMLExporter::beginYear(QTextStream& cStream, const LogBook& cLogBook,
+                        const QString& cDirName,
+                        int nYear, const YearSummary& cSummary) const
+{
+  const QString cYearName(nYear ? QString::number(nYear) : i18n("Unknown"));
+  QIODevice* pcPage = openPage(cDirName, getYearExportName(nYear));
+  if ( 0 == pcPage )
+    return 0;
+
+  cStream.setDevice(pcPage);
+  cStream << "<HTML>"
+          << "<HEAD>\n"
+          << "<TITLE>"
+          << cLogBook.diverName()
+          << " -- " << cYearName
+          << "</TITLE>\n"
+          << "</HEAD>\n"
+          << "<BODY>\n"
+          << "<H1>" << cYearName << "</H1>\n"
+          << "<TABLE BORDER=\"1\">\n"
+          << "<TR><TH>" << i18n("Dives")
+          << "</TH><TH>" << i18n("Dive time")
+          << "</TH><TH>" << i18n("Maximum depth")
+          << "</TH><TH>" << i18n("Average depth")
+          << "</TH></TR>\n"
+          << "<TR>";
+  writeSummary(cStream, cSummary);
+  cStream << "</TR>\n"
+          << "</TABLE>\n"
+          << "<H2>" << i18n("Dive logs") << "</H2>\n";
+  return pcPage;
+}
+
+
+//*****************************************************************************
+/*!
+  Write the end of the summary page \a pcPage for the year \a nYear to
+  \a cStream, and close the page.
+
+  Returns `true' on success and `false' on failure.
+*/
+//*****************************************************************************
+
+bool
+HTMLExporter::endYear(QTextStream& cStream, QIODevice* pcPage,
+                      int nYear) const
+{
+  cStream << "<HR>\n"
+          << "<A HREF=\"logbook.html\">" << i18n("Index") << "</A>\n";
+  writeFooter(cStream);
+  cStream.flush();
+  cStream.setDevice(0);
+
+  if ( false == closePage(pcPage) ) {
+    QString cMessage;
+    cMessage = QString(i18n("Error outputting log"))
+      + "\n(`" + getYearExportName(nYear) + "')";
+    errorMessage(cMessage);
+    return false;
+  }
+
+  return true;
+}
+
+
 //*****************************************************************************
 /*!
   Export the location logs for the log book \a cLogBook
@@ -351,23 +629,16 @@ HTMLExporter::exportLocations(const LogBook& cLogBook,
     const LocationLog* pcLog = iLog.next();
     assert(pcLog);
     const QString cLocationName(pcLog->getName());
-    QString cFileName(cDirName + "/");
-    cFileName += getLocationExportName(cLocationName);
-    QFile cFile(cFileName);
-    bool isOpen = cFile.open(QIODevice::WriteOnly);
-    if ( false == isOpen ) {
-      QString cMessage;
-      cMessage = QString(i18n("Couldn't open file for output"))
-        + "\n(`" + cFileName + "')";
-      errorMessage(cMessage);
+    const QString cFileName(getLocationExportName(cLocationName));
+    QIODevice* pcPage = openPage(cDirName, cFileName);
+    if ( 0 == pcPage )
       return false;
-    }
 
     QString cDescription(pcLog->getDescription());
     createParagraphs(cDescription);
     createLinks(cDescription);
 
-    QTextStream cStream(&cFile);
+    QTextStream cStream(pcPage);
     cStream << "<HTML>"
             << "<HEAD>\n"
             << "<TITLE>"
@@ -406,12 +677,12 @@ HTMLExporter::exportLocations(const LogBook& cLogBook,
             << "</HTML>\n";
 
     // Ensure output was successful
-    if ( cFile.error() != QFile::NoError ) {
+    cStream.flush();
+    if ( false == closePage(pcPage) ) {
       QString cMessage;
       cMessage = QString(i18n("Error outputting log"))
         + "\n(`" + cFileName + "')";
       errorMessage(cMessage);
-      cFile.remove();
       return false;
     }
   }
@@ -420,6 +691,381 @@ HTMLExporter::exportLocations(const LogBook& cLogBook,
 }
 
 
+//*****************************************************************************
+/*!
+  Export the search index \a cIndex for the log book \a cLogBook
+  to the directory \a cDirName.
+
+  The index is written to `search.js', and the page `search.html' uses it
+  to search the logs without any server support.
+
+  Returns `true' on success and `false' on failure.
+*/
+//*****************************************************************************
+
+bool
+HTMLExporter::exportSearch(const LogBook&     cLogBook,
+                           const SearchIndex& cIndex,
+                           const QString&     cDirName) const
+{
+  const QDate cCurrentDate(QDate::currentDate());
+
+  const QString cIndexName("search.js");
+  QIODevice* pcIndexPage = openPage(cDirName, cIndexName);
+  if ( 0 == pcIndexPage )
+    return false;
+  QTextStream cIndexStream(pcIndexPage);
+  cIndexStream.setCodec("UTF-8");
+  cIndex.write(cIndexStream);
+  cIndexStream.flush();
+  if ( false == closePage(pcIndexPage) ) {
+    QString cMessage;
+    cMessage = QString(i18n("Error outputting log"))
+      + "\n(`" + cIndexName + "')";
+    errorMessage(cMessage);
+    return false;
+  }
+
+  const QString cFileName("search.html");
+  QIODevice* pcPage = openPage(cDirName, cFileName);
+  if ( 0 == pcPage )
+    return false;
+
+  // The words are written sorted, so a prefix is found by binary search
+  QTextStream cStream(pcPage);
+  cStream.setCodec("UTF-8");
+  cStream << "<HTML>"
+          << "<HEAD>\n"
+          << "<META HTTP-EQUIV=\"Content-Type\" "
+          << "CONTENT=\"text/html; charset=utf-8\">\n"
+          << "<TITLE>"
+          << cLogBook.diverName()
+          << " -- " << i18n("search")
+          << "</TITLE>\n"
+          << "<SCRIPT TYPE=\"text/javascript\" SRC=\"search.js\"></SCRIPT>\n"
+          << "<SCRIPT TYPE=\"text/javascript\">\n"
+          << "var scubalogWords = Object.keys(scubalogIndex.words).sort();\n"
+          << "function scubalogEscape(s) {\n"
+          << "  return s.replace(/&/g, \"&amp;\").replace(/</g, \"&lt;\");\n"
+          << "}\n"
+          << "function scubalogFind(prefix) {\n"
+          << "  var lo = 0, hi = scubalogWords.length, found = {};\n"
+          << "  while ( lo < hi ) {\n"
+          << "    var mid = (lo + hi) >> 1;\n"
+          << "    if ( scubalogWords[mid] < prefix ) lo = mid + 1; else hi = mid;\n"
+          << "  }\n"
+          << "  for ( ; lo < scubalogWords.length &&\n"
+          << "          scubalogWords[lo].lastIndexOf(prefix, 0) == 0; lo++ ) {\n"
+          << "    var deltas = scubalogIndex.words[scubalogWords[lo]], doc = 0;\n"
+          << "    for ( var i = 0; i < deltas.length; i++ ) {\n"
+          << "      doc += deltas[i];\n"
+          << "      found[doc] = true;\n"
+          << "    }\n"
+          << "  }\n"
+          << "  return found;\n"
+          << "}\n"
+          << "function scubalogSearch() {\n"
+          << "  var query = document.getElementById(\"query\").value.toLowerCase();\n"
+          << "  var words = query.split(/"
+          << SearchIndex::separatorPattern(true) << "/);\n"
+          << "  var result = null;\n"
+          << "  for ( var i = 0; i < words.length; i++ ) {\n"
+          << "    if ( words[i].length < 2 ) continue;\n"
+          << "    var found = scubalogFind(words[i]);\n"
+          << "    if ( result != null ) {\n"
+          << "      var both = {};\n"
+          << "      for ( var doc in result ) if ( found[doc] ) both[doc] = true;\n"
+          << "      found = both;\n"
+          << "    }\n"
+          << "    result = found;\n"
+          << "  }\n"
+          << "  var docs = [];\n"
+          << "  for ( var doc in result ) docs.push(+doc);\n"
+          << "  docs.sort(function(a, b) { return a - b; });\n"
+          << "  var html = \"\";\n"
+          << "  for ( var i = 0; i < docs.length && i < 1000; i++ ) {\n"
+          << "    var d = scubalogIndex.docs[docs[i]];\n"
+          << "    html += \"<A HREF=\\\"\" + d[0] + \".html\\\">\" + d[0] + \".</A> \"\n"
+          << "      + d[1] + \" \" + scubalogEscape(d[2]) + \"<BR>\\n\";\n"
+          << "  }\n"
+          << "  document.getElementById(\"results\").innerHTML = html;\n"
+          << "}\n"
+          << "</SCRIPT>\n"
+          << "</HEAD>\n"
+          << "<BODY>\n"
+          << "<H1>" << i18n("Search dive logs") << "</H1>\n"
+          << "<FORM onsubmit=\"return false;\">\n"
+          << "<INPUT TYPE=\"text\" ID=\"query\" SIZE=\"40\" "
+          << "oninput=\"scubalogSearch()\">\n"
+          << "</FORM>\n"
+          << "<P>\n"
+          << "<DIV ID=\"results\"></DIV>\n"
+          << "<HR>\n"
+          << "<A HREF=\"logbook.html\">" << i18n("Index") << "</A>\n"
+          << "<P>\n"
+          << i18n("Dive log exported from")
+          << " <A HREF=\"http://home.tiscali.no/andrej/scubalog/\">"
+          << "ScubaLog</A> "
+          << cCurrentDate.toString()
+          << "\n"
+          << "</BODY>\n"
+          << "</HTML>\n";
+
+  cStream.flush();
+  if ( false == closePage(pcPage) ) {
+    QString cMessage;
+    cMessage = QString(i18n("Error outputting log"))
+      + "\n(`" + cFileName + "')";
+    errorMessage(cMessage);
+    return false;
+  }
+
+  return true;
+}
+
+
+//*****************************************************************************
+/*!
+  Open the page \a cPageName for output.
+
+  When exporting to a directory, the page is the file \a cPageName in
+  \a cDirName. When exporting to an archive, the page is a buffer that
+  is added to the archive by closePage().
+
+  Returns 0 if the page could not be opened, after showing an error message.
+*/
+//*****************************************************************************
+
+QIODevice*
+HTMLExporter::openPage(const QString& cDirName,
+                       const QString& cPageName) const
+{
+  const QString cFileName(cDirName + "/" + cPageName);
+  if ( m_pcArchive ) {
+    QBuffer* pcBuffer = new QBuffer();
+    pcBuffer->setObjectName(cFileName);
+    pcBuffer->open(QIODevice::WriteOnly);
+    return pcBuffer;
+  }
+
+  QFile* pcFile = new QFile(cFileName);
+  if ( false == pcFile->open(QIODevice::WriteOnly) ) {
+    delete pcFile;
+    QString cMessage;
+    cMessage = QString(i18n("Couldn't open file for output"))
+      + "\n(`" + cFileName + "')";
+    errorMessage(cMessage);
+    return 0;
+  }
+  return pcFile;
+}
+
+
+//*****************************************************************************
+/*!
+  Finish the page \a pcPage opened by openPage(), and delete it.
+  Any text stream writing to the page must be flushed first.
+
+  Returns `true' if the page was written successfully. On failure, a
+  partly written file is removed.
+*/
+//*****************************************************************************
+
+bool
+HTMLExporter::closePage(QIODevice* pcPage) const
+{
+  assert(pcPage);
+  bool isOk = true;
+  if ( m_pcArchive ) {
+    const QBuffer* pcBuffer = static_cast<QBuffer*>(pcPage);
+    isOk = m_pcArchive->writeFile(pcBuffer->objectName(), pcBuffer->data());
+  }
+  else {
+    QFile* pcFile = static_cast<QFile*>(pcPage);
+    isOk = (pcFile->error() == QFile::NoError);
+    pcFile->close();
+    if ( false == isOk )
+      pcFile->remove();
+  }
+  delete pcPage;
+  return isOk;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the file name of the index page number \a nPage, counting from 0.
+*/
+//*****************************************************************************
+
+QString
+HTMLExporter::getIndexPageName(int nPage) const
+{
+  if ( 0 == nPage )
+    return QString("logbook.html");
+  return QString("logbook-%1.html").arg(nPage + 1);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the file name of the summary page for the year \a nYear.
+*/
+//*****************************************************************************
+
+QString
+HTMLExporter::getYearExportName(int nYear) const
+{
+  if ( 0 == nYear )
+    return QString("year-unknown.html");
+  return QString("year-%1.html").arg(nYear);
+}
+
+
+//*****************************************************************************
+/*!
+  Write an index entry for the log \a cLog to \a cStream.
+*/
+//*****************************************************************************
+
+void
+HTMLExporter::writeLogLink(QTextStream& cStream, const DiveLog& cLog) const
+{
+  QString cLogNumber;
+  cLogNumber.setNum(cLog.logNumber());
+  cStream << "<A HREF=\""
+          << cLogNumber
+          << ".html\">"
+          << cLogNumber
+          << ".</A> "
+          << cLog.diveLocation()
+          << "<BR>\n";
+}
+
+
+//*****************************************************************************
+/*!
+  Write links to the other index pages to \a cStream, for the page
+  number \a nPage of \a nNumPages. Nothing is written for a single page.
+*/
+//*****************************************************************************
+
+void
+HTMLExporter::writePageLinks(QTextStream& cStream,
+                             int nPage, int nNumPages) const
+{
+  if ( nNumPages < 2 )
+    return;
+
+  cStream << "<P>\n";
+  if ( nPage > 0 )
+    cStream << "<A HREF=\"" << getIndexPageName(nPage - 1) << "\">"
+            << i18n("Previous page") << "</A> ";
+  for ( int iPage = 0; iPage < nNumPages; ++iPage ) {
+    if ( iPage == nPage )
+      cStream << "<B>" << iPage + 1 << "</B> ";
+    else
+      cStream << "<A HREF=\"" << getIndexPageName(iPage) << "\">"
+              << iPage + 1 << "</A> ";
+  }
+  if ( nPage + 1 < nNumPages )
+    cStream << "<A HREF=\"" << getIndexPageName(nPage + 1) << "\">"
+            << i18n("Next page") << "</A>";
+  cStream << "\n<P>\n";
+}
+
+
+//*****************************************************************************
+/*!
+  Write the aggregates in \a cSummary to \a cStream as table cells.
+*/
+//*****************************************************************************
+
+void
+HTMLExporter::writeSummary(QTextStream& cStream,
+                           const YearSummary& cSummary) const
+{
+  const int nHours   = cSummary.nDiveSeconds / 3600;
+  const int nMinutes = (cSummary.nDiveSeconds / 60) % 60;
+  const double vAverageDepth =
+    cSummary.nNumLogs ? cSummary.vDepthSum / cSummary.nNumLogs : 0.0;
+  cStream << "<TD>" << cSummary.nNumLogs << "</TD>"
+          << "<TD>" << nHours << ":"
+          << QString("%1").arg(nMinutes, 2, 10, QChar('0')) << "</TD>"
+          << "<TD>" << cSummary.vMaxDepth << "m</TD>"
+          << "<TD>" << QString::number(vAverageDepth, 'f', 1) << "m</TD>";
+}
+
+
+//*****************************************************************************
+/*!
+  Write the depth profile \a cProfile to \a cStream as an inline SVG chart.
+  Nothing is written if the profile is empty.
+
+  The profile is simplified to within half a unit of the chart, so even
+  a long profile only needs a few hundred points.
+*/
+//*****************************************************************************
+
+void
+HTMLExporter::writeProfile(QTextStream&       cStream,
+                           const DiveProfile& cProfile) const
+{
+  if ( cProfile.isEmpty() )
+    return;
+
+  const int nWidth  = 400;
+  const int nHeight = 150;
+  const QRectF cChartArea(30, 10, nWidth - 40, nHeight - 30);
+  const QVector<QPointF> acPoints = cProfile.chartPoints(cChartArea, 0.5);
+  const int nMinutes = (cProfile.duration() + 59) / 60;
+
+  // Unlike HTML, SVG is case sensitive
+  cStream << "<P>\n"
+          << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << nWidth
+          << "\" height=\"" << nHeight << "\" viewBox=\"0 0 " << nWidth
+          << " " << nHeight << "\" font-size=\"10\">\n"
+          << "<rect x=\"" << cChartArea.left() << "\" y=\"" << cChartArea.top()
+          << "\" width=\"" << cChartArea.width()
+          << "\" height=\"" << cChartArea.height()
+          << "\" fill=\"none\" stroke=\"#999\"/>\n"
+          << "<text x=\"2\" y=\"" << cChartArea.top() + 4 << "\">0m</text>\n"
+          << "<text x=\"2\" y=\"" << cChartArea.bottom() << "\">"
+          << QString::number(cProfile.maxDepth(), 'f', 1) << "m</text>\n"
+          << "<text x=\"" << cChartArea.right() << "\" y=\"" << nHeight - 5
+          << "\" text-anchor=\"end\">" << nMinutes << " min</text>\n"
+          << "<polyline fill=\"none\" stroke=\"#03c\" points=\"";
+  for ( int iPoint = 0; iPoint < acPoints.count(); ++iPoint ) {
+    if ( iPoint )
+      cStream << " ";
+    cStream << QString::number(acPoints.at(iPoint).x(), 'f', 1) << ","
+            << QString::number(acPoints.at(iPoint).y(), 'f', 1);
+  }
+  cStream << "\"/>\n"
+          << "</svg>\n";
+}
+
+
+//*****************************************************************************
+/*!
+  Write the common page footer to \a cStream.
+*/
+//*****************************************************************************
+
+void
+HTMLExporter::writeFooter(QTextStream& cStream) const
+{
+  cStream << "<HR>\n"
+          << i18n("Dive log exported from")
+          << " <A HREF=\"http://home.tiscali.no/andrej/scubalog/\">"
+          << "ScubaLog</A> "
+          << QDate::currentDate().toString()
+          << "\n"
+          << "</BODY>\n"
+          << "</HTML>\n";
+}
+
+
 //*****************************************************************************
 /*!
   Create a filename suitable for the location name \a cLocationName.
@@ -442,32 +1088,6 @@ HTMLExporter::getLocationExportName(const QString& cLocationName) const
 }
 
 
-//*****************************************************************************
-/*!
-  Search the location logs in the log book \a cLogBook for a location
-  with the name \a cLocationName.
-
-  If one is found, return `true', else return `false'.
-*/
-//*****************************************************************************
-
-bool
-HTMLExporter::hasLocation(const LogBook& cLogBook,
-                          const QString& cLocationName) const
-{
-  QListIterator<LocationLog*> iLog(cLogBook.locationList());
-  bool isFound = false;
-  for ( ; iLog.hasNext(); ) {
-    const LocationLog* pcLog = iLog.next();
-    if ( pcLog->getName() == cLocationName ) {
-      isFound = true;
-      break;
-    }
-  }
-  return isFound;
-}
-
-
 //*****************************************************************************
 /*!
   Create paragraphs in the output by replacing double newlines in \a cText
@@ -15,11 +15,18 @@
 #define HTMLEXPORTER_H
 
 #include "exporter.h"
+#include <qmap.h>
+#include <qvector.h>
 
 
 class DiveLog;
+class DiveProfile;
 class LogBook;
+class KZip;
+class QIODevice;
 class QString;
+class QTextStream;
+class SearchIndex;
 
 
 //*****************************************************************************
@@ -33,26 +40,93 @@ class QString;
 
 class HTMLExporter : public Exporter {
 public:
+  //! The ways the dive log index can be split into pages.
+  enum Pagination_e {
+    //! All the logs are listed on the main index page.
+    e_NoPagination,
+    //! A fixed number of logs are listed on each index page.
+    e_PageByCount,
+    //! The logs are listed on one page for each year.
+    e_PageByYear
+  };
+
   HTMLExporter();
   virtual ~HTMLExporter();
 
+  //! Get the way the dive log index is split into pages.
+  Pagination_e pagination() const { return m_ePagination; }
+  //! Get the number of logs on each index page, used with #e_PageByCount.
+  int logsPerPage() const { return m_nLogsPerPage; }
+  void setPagination(Pagination_e ePagination, int nLogsPerPage);
+
   virtual bool exportLog(const DiveLog& cLog,
                          const QString& cFileName) const;
-  virtual bool exportLogBook(const LogBook& cLogBook,
-                             const QString& cFileName) const;
+  virtual bool exportLogs(const LogBook&       cLogBook,
+                          const DiveSelection& cSelection,
+                          const QString&       cDirName) const;
+  bool exportArchive(const LogBook& cLogBook, const DiveSelection& cSelection,
+                     const QString& cFileName, bool isCompressed) const;
 
 protected:
-  bool exportIndex(const LogBook& cLogBook, const QString& cDirName) const;
+  //! Summary of the logs from one year.
+  struct YearSummary {
+    YearSummary()
+      : nNumLogs(0), nDiveSeconds(0), vMaxDepth(0.0F), vDepthSum(0.0) {}
+    //! The number of logs.
+    int    nNumLogs;
+    //! The total dive time, in seconds.
+    int    nDiveSeconds;
+    //! The deepest dive, in meters.
+    float  vMaxDepth;
+    //! The sum of the maximum depths, used for the average.
+    double vDepthSum;
+  };
+
+  bool exportPages(const LogBook& cLogBook, const QVector<int>& anLogs,
+                   const QString& cDirName) const;
+  bool exportIndex(const LogBook& cLogBook, const QVector<int>& anLogs,
+                   const QString& cDirName) const;
+  bool exportIndexPage(const LogBook& cLogBook, const QVector<int>& anLogs,
+                       const QString& cDirName,
+                       const QMap<int, YearSummary>& cYears,
+                       int nPage, int nNumPages) const;
+  bool exportYears(const LogBook& cLogBook, const QVector<int>& anLogs,
+                   const QString& cDirName,
+                   const QMap<int, YearSummary>& cYears) const;
+  QIODevice* beginYear(QTextStream& cStream, const LogBook& cLogBook,
+                       const QString& cDirName,
+                       int nYear, const YearSummary& cSummary) const;
+  bool endYear(QTextStream& cStream, QIODevice* pcPage, int nYear) const;
   bool exportLocations(const LogBook& cLogBook, const QString& cDirName) const;
+  bool exportSearch(const LogBook& cLogBook, const SearchIndex& cIndex,
+                    const QString& cDirName) const;
+
+  QIODevice* openPage(const QString& cDirName,
+                      const QString& cPageName) const;
+  bool closePage(QIODevice* pcPage) const;
+
+  QString getIndexPageName(int nPage) const;
+  QString getYearExportName(int nYear) const;
+  void writeLogLink(QTextStream& cStream, const DiveLog& cLog) const;
+  void writePageLinks(QTextStream& cStream, int nPage, int nNumPages) const;
+  void writeSummary(QTextStream& cStream, const YearSummary& cSummary) const;
+  void writeProfile(QTextStream& cStream, const DiveProfile& cProfile) const;
+  void writeFooter(QTextStream& cStream) const;
 
-  bool hasLocation(const LogBook& cLogBook,
-                   const QString& cLocationName) const;
   QString getLocationExportName(const QString& cLocationName) const;
 
   void createParagraphs(QString& cText) const;
   void createLinks(QString& cText) const;
 
   void errorMessage(const QString& cMessage) const;
+
+private:
+  //! The way the dive log index is split into pages.
+  Pagination_e m_ePagination;
+  //! The number of logs on each index page, when paginating by count.
+  int          m_nLogsPerPage;
+  //! The archive being written by exportArchive(), or 0.
+  mutable KZip* m_pcArchive;
 };
 
 #endif // HTMLEXPORTER_H
@@ -25,7 +25,7 @@
 //*****************************************************************************
 
 ListBox::ListBox(QWidget* pcParent)
-  : QListWidget(pcParent),
+  : QListView(pcParent),
     m_pcPopupMenu(0)
 {
 }
@@ -93,15 +93,15 @@ void
 ListBox::mousePressEvent(QMouseEvent* pcEvent)
 {
   if ( m_pcPopupMenu && Qt::RightButton == pcEvent->button() ) {
-    QListWidgetItem* item = itemAt(pcEvent->pos());
-    if ( item ) {
-      setCurrentItem(item);
+    const QModelIndex cIndex = indexAt(pcEvent->pos());
+    if ( cIndex.isValid() ) {
+      setCurrentIndex(cIndex);
     }
     emit aboutToShowPopup(m_pcPopupMenu);
     m_pcPopupMenu->popup(mapToGlobal(pcEvent->pos()));
   }
   else {
-    QListWidget::mousePressEvent(pcEvent);
+    QListView::mousePressEvent(pcEvent);
   }
 }
 
@@ -131,7 +131,7 @@ ListBox::keyPressEvent(QKeyEvent* pcEvent)
     m_pcPopupMenu->popup(cPos);
   }
   else {
-    QListWidget::keyPressEvent(pcEvent);
+    QListView::keyPressEvent(pcEvent);
   }
 }
 
@@ -14,7 +14,7 @@
 #ifndef LISTBOX_H
 #define LISTBOX_H
 
-#include <QListWidget>
+#include <QListView>
 
 class QMenu;
 class QKeyEvent;
@@ -26,8 +26,9 @@ class QMouseEvent;
   \class ListBox
   \brief The ListBox class is used to show a list of items.
 
-  The class extends the QListBox widget in Qt by providing the possibility
-  to have a pop-up menu related to the widget.
+  The class extends the QListView widget in Qt by providing the possibility
+  to have a pop-up menu related to the widget. The items are taken from
+  the model set with setModel().
 
   By default, the menu is accessed with right mouse-button, the menu key or
   the esc key.
@@ -47,7 +48,7 @@ class QMouseEvent;
 */
 //*****************************************************************************
 
-class ListBox : public QListWidget {
+class ListBox : public QListView {
   Q_OBJECT
 
 public:
@@ -0,0 +1,502 @@
+//*****************************************************************************
+/*!
+  \file locationlistmodel.cpp
+  \brief This file contains the implementation of the LocationListModel class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "locationlistmodel.h"
+#include "locationlog.h"
+#include "logbook.h"
+#include "divelist.h"
+#include "changetracker.h"
+#include <KLocalizedString>
+#include <qset.h>
+#include <qstringlist.h>
+#include <algorithm>
+#include <assert.h>
+
+
+/**
+ * Get the keys of the name \a cName; the lower case name from the start
+ * of each word to its end. The whole name is always a key.
+ */
+
+static QStringList
+nameKeys(const QString& cName)
+{
+  const QString cLower = cName.toLower();
+  QStringList cKeys;
+  for ( int i = 0; i < cLower.length(); ++i ) {
+    if ( 0 == i || (cLower.at(i).isLetterOrNumber() &&
+                    false == cLower.at(i - 1).isLetterOrNumber()) )
+      cKeys.append(cLower.mid(i));
+  }
+  return cKeys;
+}
+
+
+/**
+ * Returns `true' if the location \a pcLocation1 is ordered before
+ * \a pcLocation2 by name, ignoring case.
+ */
+
+static bool
+isNameBefore(const LocationLog* pcLocation1, const LocationLog* pcLocation2)
+{
+  return QString::compare(pcLocation1->getName(), pcLocation2->getName(),
+                          Qt::CaseInsensitive) < 0;
+}
+
+
+//*****************************************************************************
+/*!
+  \brief Orders the keys of the prefix index on their text.
+
+  The text of a key can also be compared to a plain string, so the index
+  can be searched for a filter with std::lower_bound().
+*/
+//*****************************************************************************
+
+struct NameKeyLess {
+  //! Returns `true' if the key \a cKey1 is ordered before \a cKey2.
+  template<class Key1, class Key2>
+  bool operator ()(const Key1& cKey1, const Key2& cKey2) const {
+    return text(cKey1) < text(cKey2);
+  }
+
+  //! Get the text of the key \a cKey.
+  template<class Key>
+  static const QString& text(const Key& cKey) { return cKey.cText; }
+  //! Get the text \a cText.
+  static const QString& text(const QString& cText) { return cText; }
+};
+
+
+//*****************************************************************************
+/*!
+  Create an empty model, with \a pcParent as the parent object.
+*/
+//*****************************************************************************
+
+LocationListModel::LocationListModel(QObject* pcParent)
+  : QAbstractListModel(pcParent),
+    m_pcLogBook(0),
+    m_pcTracker(0),
+    m_nRowCount(0),
+    m_isIndexValid(false)
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the model. The log book is not touched.
+*/
+//*****************************************************************************
+
+LocationListModel::~LocationListModel()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Show the locations in \a pcLogBook, or nothing if it is 0.
+  The model doesn't own the log book.
+
+  The filter is kept. Unless there is one, this takes the same time
+  whatever the number of locations.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::setLogBook(LogBook* pcLogBook)
+{
+  beginResetModel();
+  if ( m_pcTracker )
+    disconnect(m_pcTracker, 0, this, 0);
+  m_pcLogBook = pcLogBook;
+  m_pcTracker = pcLogBook ? &pcLogBook->changeTracker() : 0;
+  if ( m_pcTracker )
+    connect(m_pcTracker, SIGNAL(changed()), SLOT(logBookChanged()));
+  m_nRowCount = pcLogBook ? pcLogBook->locationList().count() : 0;
+  m_acKeys.clear();
+  m_isIndexValid = false;
+  filterRows();
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the location shown at \a cIndex, or 0 if there is none.
+*/
+//*****************************************************************************
+
+LocationLog*
+LocationListModel::location(const QModelIndex& cIndex) const
+{
+  if ( false == cIndex.isValid() )
+    return 0;
+  return rowLocation(cIndex.row());
+}
+
+
+//*****************************************************************************
+/*!
+  Get the index of the row showing \a pcLocation, or an invalid index
+  if the location isn't shown.
+*/
+//*****************************************************************************
+
+QModelIndex
+LocationListModel::indexOf(const LocationLog* pcLocation) const
+{
+  const int nRow = rowOf(pcLocation);
+  if ( nRow < 0 )
+    return QModelIndex();
+  return index(nRow);
+}
+
+
+//*****************************************************************************
+/*!
+  Append the new location \a pcLocation to the list, adding a row for it.
+  A named location is also added to the dive list, so the logs at it are
+  linked to it.
+
+  When filtered, the row is added last, whatever its name, so the new
+  location is shown until the filter is changed.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::appendLocation(LocationLog* pcLocation)
+{
+  assert(m_pcLogBook);
+  const int nRow = rowCount();
+  beginInsertRows(QModelIndex(), nRow, nRow);
+  m_pcLogBook->locationList().append(pcLocation);
+  m_pcLogBook->diveList().addLocation(pcLocation);
+  m_nRowCount = m_pcLogBook->locationList().count();
+  if ( m_isIndexValid )
+    addKeys(pcLocation);
+  if ( false == isListOrder() )
+    m_apcRows.append(pcLocation);
+  endInsertRows();
+}
+
+
+//*****************************************************************************
+/*!
+  Rename the location \a pcLocation to \a cName, through the dive list so
+  the logs at it follow, and update its keys in the prefix index.
+  Returns `false', and leaves the location as it was, if another location
+  already has the name.
+
+  When filtered, the location keeps its row, whatever its new name.
+*/
+//*****************************************************************************
+
+bool
+LocationListModel::renameLocation(LocationLog* pcLocation,
+                                  const QString& cName)
+{
+  assert(m_pcLogBook);
+  if ( m_isIndexValid )
+    removeKeys(pcLocation);
+  const bool isRenamed =
+    m_pcLogBook->diveList().renameLocation(pcLocation, cName);
+  if ( m_isIndexValid )
+    addKeys(pcLocation);
+  if ( false == isRenamed )
+    return false;
+  const QModelIndex cIndex = indexOf(pcLocation);
+  if ( cIndex.isValid() )
+    emit dataChanged(cIndex, cIndex);
+  return true;
+}
+
+
+//*****************************************************************************
+/*!
+  Delete the location \a pcLocation from the list and the dive list,
+  removing its row. The location itself is not deleted.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::deleteLocation(LocationLog* pcLocation)
+{
+  assert(m_pcLogBook);
+  const int nRow = rowOf(pcLocation);
+  if ( nRow >= 0 )
+    beginRemoveRows(QModelIndex(), nRow, nRow);
+  if ( m_isIndexValid )
+    removeKeys(pcLocation);
+  if ( false == isListOrder() && nRow >= 0 )
+    m_apcRows.remove(nRow);
+  m_pcLogBook->locationList().removeOne(pcLocation);
+  m_pcLogBook->diveList().removeLocation(pcLocation);
+  m_nRowCount = m_pcLogBook->locationList().count();
+  if ( nRow >= 0 )
+    endRemoveRows();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number of rows; the number of locations shown.
+*/
+//*****************************************************************************
+
+int
+LocationListModel::rowCount(const QModelIndex& cParent) const
+{
+  if ( cParent.isValid() )
+    return 0;
+  return isListOrder() ? m_nRowCount : m_apcRows.count();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the data of \a cIndex for the role \a nRole; the name of the
+  location, and the number of dives there, if any.
+*/
+//*****************************************************************************
+
+QVariant
+LocationListModel::data(const QModelIndex& cIndex, int nRole) const
+{
+  const LocationLog* pcLocation = location(cIndex);
+  if ( 0 == pcLocation || Qt::DisplayRole != nRole )
+    return QVariant();
+
+  const int nNumDives = pcLocation->dives().count();
+  if ( 0 == nNumDives )
+    return pcLocation->getName();
+  return i18ncp("Location name and number of dives there",
+                "%2 (1 dive)", "%2 (%1 dives)",
+                nNumDives, pcLocation->getName());
+}
+
+
+//*****************************************************************************
+/*!
+  Show only the locations with a word in their name starting with
+  \a cText, ignoring case and leading and trailing white space, or all
+  locations if \a cText is empty.
+
+  The prefix index is built the first time a filter is set. The model
+  is reset, as the rows shown change.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::setFilter(const QString& cText)
+{
+  const QString cFilter = cText.trimmed().toLower();
+  if ( cFilter == m_cFilter )
+    return;
+
+  beginResetModel();
+  m_cFilter = cFilter;
+  filterRows();
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  The log book has changed. The dive counts may have changed, so update
+  all the rows; the view only reads those it shows. If locations have
+  been added or deleted other than through this model, reset it.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::logBookChanged()
+{
+  if ( 0 == m_pcLogBook )
+    return;
+
+  if ( m_pcLogBook->locationList().count() != m_nRowCount ) {
+    beginResetModel();
+    m_nRowCount = m_pcLogBook->locationList().count();
+    m_acKeys.clear();
+    m_isIndexValid = false;
+    filterRows();
+    endResetModel();
+    return;
+  }
+  if ( m_pcTracker->changedLogs().isEmpty() &&
+       false == m_pcTracker->hasOtherChanges() )
+    return;
+  const int nNumRows = rowCount();
+  if ( nNumRows > 0 )
+    emit dataChanged(index(0), index(nNumRows - 1));
+}
+
+
+//*****************************************************************************
+/*!
+  Get the location shown in the row \a nRow, or 0 if there is none.
+*/
+//*****************************************************************************
+
+LocationLog*
+LocationListModel::rowLocation(int nRow) const
+{
+  if ( nRow < 0 )
+    return 0;
+  if ( isListOrder() ) {
+    if ( 0 == m_pcLogBook || nRow >= m_nRowCount ||
+         nRow >= m_pcLogBook->locationList().count() )
+      return 0;
+    return m_pcLogBook->locationList().at(nRow);
+  }
+  return m_apcRows.value(nRow, 0);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the row showing \a pcLocation, or -1 if it isn't shown.
+*/
+//*****************************************************************************
+
+int
+LocationListModel::rowOf(const LocationLog* pcLocation) const
+{
+  if ( 0 == m_pcLogBook || 0 == pcLocation )
+    return -1;
+  LocationLog* pcKey = const_cast<LocationLog*>(pcLocation);
+  if ( isListOrder() )
+    return m_pcLogBook->locationList().indexOf(pcKey);
+  return m_apcRows.indexOf(pcKey);
+}
+
+
+//*****************************************************************************
+/*!
+  Add the keys of the name of \a pcLocation to the prefix index.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::addKeys(LocationLog* pcLocation)
+{
+  const QStringList cKeys = nameKeys(pcLocation->getName());
+  for ( int iKey = 0; iKey < cKeys.count(); ++iKey ) {
+    NameKey cKey;
+    cKey.cText = cKeys.at(iKey);
+    cKey.pcLocation = pcLocation;
+    m_acKeys.insert(std::upper_bound(m_acKeys.begin(), m_acKeys.end(),
+                                     cKey, NameKeyLess()),
+                    cKey);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the keys of the name of \a pcLocation from the prefix index.
+  The location must still have the name it was indexed by.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::removeKeys(LocationLog* pcLocation)
+{
+  const QStringList cKeys = nameKeys(pcLocation->getName());
+  for ( int iKey = 0; iKey < cKeys.count(); ++iKey ) {
+    QVector<NameKey>::iterator iEntry =
+      std::lower_bound(m_acKeys.begin(), m_acKeys.end(), cKeys.at(iKey),
+                       NameKeyLess());
+    for ( ; iEntry != m_acKeys.end() && iEntry->cText == cKeys.at(iKey);
+          ++iEntry ) {
+      if ( iEntry->pcLocation == pcLocation ) {
+        m_acKeys.erase(iEntry);
+        break;
+      }
+    }
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Build the prefix index from all the locations in the log book.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::buildIndex()
+{
+  m_acKeys.clear();
+  m_isIndexValid = true;
+  if ( 0 == m_pcLogBook )
+    return;
+
+  QListIterator<LocationLog*> iLocation(m_pcLogBook->locationList());
+  while ( iLocation.hasNext() ) {
+    LocationLog* pcLocation = iLocation.next();
+    const QStringList cKeys = nameKeys(pcLocation->getName());
+    for ( int iKey = 0; iKey < cKeys.count(); ++iKey ) {
+      NameKey cKey;
+      cKey.cText = cKeys.at(iKey);
+      cKey.pcLocation = pcLocation;
+      m_acKeys.append(cKey);
+    }
+  }
+  std::stable_sort(m_acKeys.begin(), m_acKeys.end(), NameKeyLess());
+}
+
+
+//*****************************************************************************
+/*!
+  Set the rows to the locations matching the filter, ordered by name.
+  The keys starting with the filter are a range of the prefix index;
+  a location with several words matching is shown once.
+*/
+//*****************************************************************************
+
+void
+LocationListModel::filterRows()
+{
+  m_apcRows.clear();
+  if ( isListOrder() || 0 == m_pcLogBook )
+    return;
+  if ( false == m_isIndexValid )
+    buildIndex();
+
+  QSet<LocationLog*> cShown;
+  QVector<NameKey>::const_iterator iKey =
+    std::lower_bound(m_acKeys.constBegin(), m_acKeys.constEnd(), m_cFilter,
+                     NameKeyLess());
+  for ( ; iKey != m_acKeys.constEnd() && iKey->cText.startsWith(m_cFilter);
+        ++iKey ) {
+    if ( false == cShown.contains(iKey->pcLocation) ) {
+      cShown.insert(iKey->pcLocation);
+      m_apcRows.append(iKey->pcLocation);
+    }
+  }
+  std::stable_sort(m_apcRows.begin(), m_apcRows.end(), isNameBefore);
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,134 @@
+//*****************************************************************************
+/*!
+  \file locationlistmodel.h
+  \brief This file contains the definition of the LocationListModel class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef LOCATIONLISTMODEL_H
+#define LOCATIONLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <qstring.h>
+#include <qvector.h>
+
+class LogBook;
+class LocationLog;
+class ChangeTracker;
+
+
+//*****************************************************************************
+/*!
+  \class LocationListModel
+  \brief The LocationListModel class is a list model of the locations
+  in a log book.
+
+  There is one row per location shown, with the name of the location and
+  the number of dives there. The count is read from LocationLog::dives(),
+  which the dive list keeps up to date, so no dives are counted.
+
+  Unless filtered, the rows are the locations in list order, read from
+  the log book when the view asks for them, so setting a log book takes
+  the same time whatever the number of locations.
+
+  setFilter() shows only the locations with a word in their name starting
+  with the filter text, ordered by name. The search uses a prefix index;
+  a sorted array with a key for each word of each name, running from the
+  start of that word to the end of the name, in lower case. The locations
+  matching are then a range of the array, found by binary search, so each
+  key typed costs the logarithm of the number of names, not a scan of
+  them all. The index is built the first time a filter is set, and is
+  kept up to date as locations are added, renamed and deleted.
+
+  Locations should be added, renamed and deleted through appendLocation(),
+  renameLocation() and deleteLocation(), so the index and the rows are
+  kept in step with the list. Changes to the dive logs are picked up from
+  the change tracker of the log book, and update the dive counts.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class LocationListModel : public QAbstractListModel {
+  Q_OBJECT
+public:
+  LocationListModel(QObject* pcParent = 0);
+  virtual ~LocationListModel();
+
+  void setLogBook(LogBook* pcLogBook);
+  //! Get the log book, or 0 if there is none.
+  LogBook* logBook() const { return m_pcLogBook; }
+  LocationLog* location(const QModelIndex& cIndex) const;
+  QModelIndex indexOf(const LocationLog* pcLocation) const;
+
+  void appendLocation(LocationLog* pcLocation);
+  bool renameLocation(LocationLog* pcLocation, const QString& cName);
+  void deleteLocation(LocationLog* pcLocation);
+
+  //! Get the filter, in lower case, or an empty string if there is none.
+  QString filter() const { return m_cFilter; }
+
+  virtual int rowCount(const QModelIndex& cParent = QModelIndex()) const;
+  virtual QVariant data(const QModelIndex& cIndex,
+                        int nRole = Qt::DisplayRole) const;
+
+public slots:
+  void setFilter(const QString& cText);
+
+private slots:
+  void logBookChanged();
+
+private:
+  //! Disabled copy constructor.
+  LocationListModel(const LocationListModel&);
+  //! Disabled assignment operator.
+  LocationListModel& operator =(const LocationListModel&);
+
+  //! Returns `true' if the rows are the locations in list order.
+  bool isListOrder() const { return m_cFilter.isEmpty(); }
+  LocationLog* rowLocation(int nRow) const;
+  int rowOf(const LocationLog* pcLocation) const;
+  void addKeys(LocationLog* pcLocation);
+  void removeKeys(LocationLog* pcLocation);
+  void buildIndex();
+  void filterRows();
+
+  //! A key of the prefix index.
+  struct NameKey {
+    //! The name from the start of a word, in lower case.
+    QString      cText;
+    //! The location named.
+    LocationLog* pcLocation;
+  };
+
+  //! The log book, or 0.
+  LogBook*              m_pcLogBook;
+  //! The change tracker of the log book, or 0.
+  ChangeTracker*        m_pcTracker;
+  //! The number of locations the view has been told about.
+  int                   m_nRowCount;
+  //! The filter, in lower case.
+  QString               m_cFilter;
+  //! The locations shown when filtered; empty when in list order.
+  QVector<LocationLog*> m_apcRows;
+  //! The prefix index, sorted on the key text.
+  QVector<NameKey>      m_acKeys;
+  //! Set when the prefix index is built.
+  bool                  m_isIndexValid;
+};
+
+#endif // LOCATIONLISTMODEL_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
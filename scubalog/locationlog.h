@@ -15,12 +15,19 @@
 #define LOCATIONLOG_H
 
 #include <qstring.h>
+#include <qvector.h>
+
+class DiveLog;
 
 //*****************************************************************************
 /*!
   \class LocationLog
   \brief The LocationLog class is used to log information about a location.
 
+  Dive logs at a location are linked to it by DiveList, which also keeps
+  the list of those logs up to date; see dives(). A location the dive list
+  knows about must be renamed with DiveList::renameLocation().
+
   \author André Johansen
 */
 //*****************************************************************************
@@ -35,12 +42,23 @@ public:
   void setName(const QString& cName);
   QString getDescription() const;
   void setDescription(const QString& cDescription);
+  //! Get the dive logs at this location, in no particular order.
+  const QVector<DiveLog*>& dives() const { return m_apcDives; }
 
 private:
+  friend class DiveList;
+
+  //! Disabled copy constructor.
+  LocationLog(const LocationLog&);
+  //! Disabled assignment operator.
+  LocationLog& operator =(const LocationLog&);
+
   //! The name of the location.
   QString m_cName;
   //! The description of the location.
   QString m_cDescription;
+  //! The dive logs linked to this location.
+  QVector<DiveLog*> m_apcDives;
 };
 
 
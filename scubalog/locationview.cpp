@@ -12,8 +12,11 @@
 //*****************************************************************************
 
 #include "locationview.h"
+#include "locationlistmodel.h"
 #include "locationlog.h"
 #include "logbook.h"
+#include "divelist.h"
+#include "changetracker.h"
 #include "listbox.h"
 
 #include <KLocalizedString>
@@ -22,6 +25,7 @@
 #include <QHBoxLayout>
 #include <QMenu>
 #include <qlayout.h>
+#include <qlabel.h>
 #include <qmessagebox.h>
 #include <QTextEdit>
 #include <qlineedit.h>
@@ -41,23 +45,41 @@
 
 LocationView::LocationView(QWidget* pcParent)
   : QWidget(pcParent),
+    m_pcFilter(0),
     m_pcLocations(0),
+    m_pcModel(0),
     m_pcNewLocation(0),
     m_pcDeleteLocation(0),
     m_pcLocationName(0),
     m_pcLocationDescription(0),
-    m_pcLogBook(0)
+    m_pcLogBook(0),
+    m_pcResetLocation(0)
 {
   QSplitter* pcSplitter = new QSplitter(Qt::Vertical, this);
 
   QWidget* pcTop = new QWidget(pcSplitter);
 
+  QLabel* pcFilterLabel = new QLabel(i18n("&Filter:"), pcTop);
+  m_pcFilter = new QLineEdit(pcTop);
+  m_pcFilter->setClearButtonEnabled(true);
+  m_pcFilter->setEnabled(false);
+  pcFilterLabel->setBuddy(m_pcFilter);
+
+  m_pcModel = new LocationListModel(this);
   m_pcLocations = new ListBox(pcTop);
+  m_pcLocations->setModel(m_pcModel);
+  m_pcLocations->setUniformItemSizes(true);
   m_pcLocations->setEnabled(false);
-  connect(m_pcLocations, SIGNAL(currentRowChanged(int)),
-          SLOT(locationSelected(int)));
-  connect(m_pcLocations, SIGNAL(itemDoubleClicked(QListWidgetItem*)),
-          SLOT(editLocationName(QListWidgetItem*)));
+  connect(m_pcLocations->selectionModel(),
+          SIGNAL(currentRowChanged(const QModelIndex&, const QModelIndex&)),
+          SLOT(locationSelected(const QModelIndex&)));
+  connect(m_pcLocations, SIGNAL(doubleClicked(const QModelIndex&)),
+          SLOT(editLocationName(const QModelIndex&)));
+  connect(m_pcModel, SIGNAL(modelAboutToBeReset()),
+          SLOT(rememberCurrentLocation()));
+  connect(m_pcModel, SIGNAL(modelReset()), SLOT(restoreCurrentLocation()));
+  connect(m_pcFilter, SIGNAL(textChanged(const QString&)),
+          m_pcModel, SLOT(setFilter(const QString&)));
 
   m_pcNewLocation = new QPushButton(pcTop);
   m_pcNewLocation->setEnabled(false);
@@ -109,11 +131,15 @@ LocationView::LocationView(QWidget* pcParent)
   pcSplitLayout->activate();
 
   QBoxLayout* pcTopLayout    = new QVBoxLayout(pcTop);
+  QBoxLayout* pcFilterLayout = new QHBoxLayout();
   QBoxLayout* pcButtonLayout = new QHBoxLayout();
+  pcTopLayout->addLayout(pcFilterLayout);
   pcTopLayout->addWidget(m_pcLocations, 1);
   pcTopLayout->addSpacing(5);
   pcTopLayout->addLayout(pcButtonLayout);
   pcTopLayout->addSpacing(5);
+  pcFilterLayout->addWidget(pcFilterLabel,    0);
+  pcFilterLayout->addWidget(m_pcFilter,       1);
   pcButtonLayout->addWidget(m_pcNewLocation,    0);
   pcButtonLayout->addWidget(m_pcDeleteLocation, 0);
   pcButtonLayout->addWidget(m_pcLocationName,   1);
@@ -137,8 +163,9 @@ LocationView::~LocationView()
 /*!
   Set the current log book to \a pcLogBook.
 
-  This function will update the view. If a null-pointer is passed,
-  the view will be cleared and the widgets will be disabled.
+  The model reads the locations when the list asks for them, so this
+  takes the same time whatever the number of locations. If a null-pointer
+  is passed, the view will be cleared and the widgets will be disabled.
 */
 //*****************************************************************************
 
@@ -146,37 +173,18 @@ void
 LocationView::setLogBook(LogBook* pcLogBook)
 {
   m_pcLogBook = pcLogBook;
+  m_pcModel->setLogBook(pcLogBook);
 
   if ( pcLogBook ) {
-    m_pcLocations->clear();
-    m_pcLocations->setUpdatesEnabled(false);
-    QList<LocationLog*>& cLocationList = pcLogBook->locationList();
-    QListIterator<LocationLog*> iLoc(cLocationList);
-    LocationLog* pcLocation;
-    while ( iLoc.hasNext() ) {
-      pcLocation = iLoc.next();
-      m_pcLocations->addItem(pcLocation->getName());
-    }
-    m_pcLocations->setUpdatesEnabled(true);
+    m_pcFilter->setEnabled(true);
     m_pcNewLocation->setEnabled(true);
-    unsigned int nNumLocations = cLocationList.count();
-    bool bLocationsExist = nNumLocations != 0;
-    pcLocation = 0;
-    if ( bLocationsExist ) {
-      m_pcLocations->setCurrentItem(0);
-      pcLocation = cLocationList.first();
-      assert(pcLocation);
-    }
+    const bool bLocationsExist = m_pcModel->rowCount() != 0;
     m_pcLocations->setEnabled(bLocationsExist);
-    m_pcDeleteLocation->setEnabled(bLocationsExist);
     m_pcLocationName->setEnabled(bLocationsExist);
-    m_pcLocationDescription->setEnabled(bLocationsExist);
-    m_pcLocationDescription->setText(bLocationsExist ?
-                                     pcLocation->getDescription() :
-                                     QString(""));
   }
   else {
-    m_pcLocations->clear();
+    m_pcFilter->setEnabled(false);
+    m_pcLocations->setEnabled(false);
     m_pcNewLocation->setEnabled(false);
     m_pcDeleteLocation->setEnabled(false);
     m_pcLocationDescription->setEnabled(false);
@@ -186,22 +194,23 @@ LocationView::setLogBook(LogBook* pcLogBook)
 
 //*****************************************************************************
 /*!
-  The location with the index \a nLocationIndex has been selected.
+  The location at \a cIndex has been selected.
 
-  Update the rest of the GUI.
+  Update the rest of the GUI. If no location is selected, the description
+  is cleared and disabled.
 */
 //*****************************************************************************
 
 void
-LocationView::locationSelected(int nLocationIndex)
+LocationView::locationSelected(const QModelIndex& cIndex)
 {
-  if ( nLocationIndex < 0 )
+  LocationLog* pcLog = m_pcModel->location(cIndex);
+  if ( 0 == pcLog ) {
+    m_pcDeleteLocation->setEnabled(false);
+    m_pcLocationDescription->setEnabled(false);
+    m_pcLocationDescription->setText("");
     return;
-
-  assert(m_pcLogBook);
-  QList<LocationLog*>& cLocationList = m_pcLogBook->locationList();
-  LocationLog* pcLog = cLocationList.at(nLocationIndex);
-  assert(pcLog);
+  }
 
   m_pcDeleteLocation->setEnabled(true);
   m_pcLocationDescription->setEnabled(true);
@@ -211,22 +220,20 @@ LocationView::locationSelected(int nLocationIndex)
 
 //*****************************************************************************
 /*!
-  Edit the name of the item \a item.
+  Edit the name of the location at \a cIndex.
 
   \sa locationNameChanged().
 */
 //*****************************************************************************
 
 void
-LocationView::editLocationName(QListWidgetItem* item)
+LocationView::editLocationName(const QModelIndex& cIndex)
 {
-  assert(item);
   assert(m_pcLogBook);
-  int nLocationIndex = m_pcLocations->row(item);
-  assert(m_pcLocations->count() > nLocationIndex);
-  QList<LocationLog*>& cLocationList = m_pcLogBook->locationList();
-  LocationLog* pcLog = cLocationList.at(nLocationIndex);
-  assert(pcLog);
+  LocationLog* pcLog = m_pcModel->location(cIndex);
+  if ( 0 == pcLog )
+    return;
+  m_pcFilter->setEnabled(false);
   m_pcLocations->setEnabled(false);
   m_pcNewLocation->setEnabled(false);
   m_pcDeleteLocation->setEnabled(false);
@@ -239,7 +246,7 @@ LocationView::editLocationName(QListWidgetItem* item)
 
 //*****************************************************************************
 /*!
-  Edit the name of the currently selected item, if any.
+  Edit the name of the currently selected location, if any.
 
   \sa editLocationName(), locationNameChanged().
 */
@@ -249,17 +256,19 @@ void
 LocationView::editCurrentLocationName()
 {
   assert(m_pcLogBook);
-  QListWidgetItem* current = m_pcLocations->currentItem();
-  if ( !current ) {
+  const QModelIndex cCurrent = m_pcLocations->currentIndex();
+  if ( false == cCurrent.isValid() ) {
     return;
   }
-  editLocationName(current);
+  editLocationName(cCurrent);
 }
 
 
 //*****************************************************************************
 /*!
   Edit the location \a cLocationName. If it does not exist, create it.
+
+  If the location is hidden by the filter, the filter is cleared.
 */
 //*****************************************************************************
 
@@ -268,21 +277,13 @@ LocationView::editLocation(const QString& cLocationName)
 {
   assert(m_pcLogBook);
 
-  QList<LocationLog*>& cLocations = m_pcLogBook->locationList();
-
   // First, try to find the location
-  QListIterator<LocationLog*> iLog(cLocations);
-  int nLocationIndex = 0;
-  bool isFound = false;
-  for ( ; iLog.hasNext(); ++nLocationIndex ) {
-    if ( iLog.next()->getName() == cLocationName ) {
-      isFound = true;
-      break;
-    }
-  }
-  if ( isFound ) {
-    m_pcLocations->setCurrentRow(nLocationIndex);
-    locationSelected(nLocationIndex);
+  LocationLog* pcLocation =
+    m_pcLogBook->diveList().findLocation(cLocationName);
+  if ( pcLocation ) {
+    if ( false == m_pcModel->indexOf(pcLocation).isValid() )
+      m_pcFilter->clear();
+    selectLocation(pcLocation);
     return;
   }
 
@@ -300,9 +301,9 @@ LocationView::editLocation(const QString& cLocationName)
   }
 
   pcLog->setName(cLocationName);
-  cLocations.append(pcLog);
-  m_pcLocations->addItem(cLocationName);
-  m_pcLocations->setCurrentRow(m_pcLocations->count()-1);
+  m_pcModel->appendLocation(pcLog);
+  m_pcLogBook->changeTracker().locationAdded(pcLog);
+  selectLocation(pcLog);
   m_pcLocationName->setText(cLocationName);
   m_pcLocationDescription->setText("");
 
@@ -340,13 +341,13 @@ LocationView::newLocation()
     return;
   }
 
-  QList<LocationLog*>& cLocations = m_pcLogBook->locationList();
-  cLocations.append(pcLog);
-  m_pcLocations->addItem("");
-  m_pcLocations->setCurrentRow(m_pcLocations->count()-1);
+  m_pcModel->appendLocation(pcLog);
+  m_pcLogBook->changeTracker().locationAdded(pcLog);
+  selectLocation(pcLog);
   m_pcLocationName->setText("");
   m_pcLocationDescription->setText("");
 
+  m_pcFilter->setEnabled(false);
   m_pcLocations->setEnabled(false);
   m_pcNewLocation->setEnabled(false);
   m_pcDeleteLocation->setEnabled(false);
@@ -371,15 +372,9 @@ LocationView::deleteLocation()
 {
   assert(m_pcLogBook);
 
-  // Find and delete the location
-  QList<LocationLog*>& cLocationList = m_pcLogBook->locationList();
-  int nCurrentItem = m_pcLocations->currentRow();
-  if ( -1 == nCurrentItem )
+  LocationLog* pcLog = currentLocation();
+  if ( 0 == pcLog )
     return;
-  assert(cLocationList.count() > nCurrentItem);
-
-  LocationLog* pcLog = cLocationList.at(nCurrentItem);
-  assert(pcLog);
 
   QString cMessage =
     QString(i18n("Are you sure you want to delete the location\n"
@@ -391,24 +386,23 @@ LocationView::deleteLocation()
   if ( 1 == nResult )
     return;
 
-  QListWidgetItem* item = m_pcLocations->takeItem(nCurrentItem);
-  delete item;
-  cLocationList.removeAt(nCurrentItem);
+  m_pcModel->deleteLocation(pcLog);
+  m_pcLogBook->changeTracker().locationRemoved(pcLog);
+  delete pcLog;
 
   // Update the view with the new current location, if any
-  const int nNewCurrent = m_pcLocations->currentRow();
-  if ( -1 == nNewCurrent ) {
-    m_pcLocations->setEnabled(false);
-    m_pcDeleteLocation->setEnabled(false);
-    m_pcLocationDescription->setText("");
-    m_pcLocationDescription->setEnabled(false);
+  if ( false == m_pcLocations->currentIndex().isValid() ) {
+    m_pcLocations->setEnabled(m_pcModel->rowCount() != 0);
+    locationSelected(QModelIndex());
   }
 }
 
 
 //*****************************************************************************
 /*!
-  Change the location name to \a pzName.
+  Change the name of the current location to the text of the name editor.
+  If another location already has the name, the user is told so and the
+  editor is left open.
 */
 //*****************************************************************************
 
@@ -416,19 +410,25 @@ void
 LocationView::locationNameChanged()
 {
   assert(m_pcLogBook);
-  assert(m_pcLocations->count() >= 1);
 
-  int nCurrentItem = m_pcLocations->currentRow();
-  assert(nCurrentItem >= 0);
-  QList<LocationLog*>& cLocations = m_pcLogBook->locationList();
-  LocationLog* pcLocation = cLocations.at(nCurrentItem);
+  LocationLog* pcLocation = currentLocation();
+  assert(pcLocation);
   QString cName(m_pcLocationName->text());
-  pcLocation->setName(cName);
+  const QString cOldName = pcLocation->getName();
+  if ( false == m_pcModel->renameLocation(pcLocation, cName) ) {
+    QMessageBox::warning(QApplication::topLevelWidgets().at(0),
+                         i18n("[ScubaLog] Edit location name"),
+                         i18n("There is already a location "
+                              "named `%1'!", cName));
+    m_pcLocationName->setFocus();
+    return;
+  }
+  if ( cName != cOldName )
+    m_pcLogBook->changeTracker().locationRenamed(pcLocation, cOldName);
 
   m_pcLocationName->hide();
-  QListWidgetItem* item = m_pcLocations->currentItem();
-  item->setText(cName);
 
+  m_pcFilter->setEnabled(true);
   m_pcLocations->setEnabled(true);
   m_pcNewLocation->setEnabled(true);
   m_pcDeleteLocation->setEnabled(true);
@@ -449,17 +449,17 @@ LocationView::locationNameChanged()
 void
 LocationView::locationDescriptionChanged()
 {
-  assert(m_pcLogBook);
-
-  int nCurrentItem = m_pcLocations->currentRow();
-  if ( -1 == nCurrentItem )
+  if ( 0 == m_pcLogBook )
     return;
-  QList<LocationLog*>& cLocations = m_pcLogBook->locationList();
-  LocationLog* pcLocation = cLocations.at(nCurrentItem);
+
+  LocationLog* pcLocation = currentLocation();
   if ( 0 == pcLocation )
     return;
   QString cDescription(m_pcLocationDescription->toPlainText());
-  pcLocation->setDescription(cDescription);
+  if ( cDescription != pcLocation->getDescription() ) {
+    pcLocation->setDescription(cDescription);
+    m_pcLogBook->changeTracker().locationChanged(pcLocation);
+  }
 }
 
 
@@ -474,12 +474,85 @@ LocationView::prepareLocationsMenu(QMenu* pcMenu)
 {
   assert(pcMenu);
 
-  bool bHasSelectedLocation = (m_pcLocations->currentRow() != -1);
+  bool bHasSelectedLocation = m_pcLocations->currentIndex().isValid();
   pcMenu->actions().at(1)->setEnabled(bHasSelectedLocation);
   pcMenu->actions().at(2)->setEnabled(bHasSelectedLocation);
 }
 
 
+//*****************************************************************************
+/*!
+  The model is about to be reset; remember the current location.
+*/
+//*****************************************************************************
+
+void
+LocationView::rememberCurrentLocation()
+{
+  m_pcResetLocation = currentLocation();
+}
+
+
+//*****************************************************************************
+/*!
+  The model has been reset; make the location that was current before
+  the reset current again, if it is still in the list and shown.
+  Otherwise, the first location shown is made current, so typing a filter
+  shows the description of the best match.
+
+  The list is searched, as the location may have been deleted.
+*/
+//*****************************************************************************
+
+void
+LocationView::restoreCurrentLocation()
+{
+  LocationLog* pcLocation = m_pcResetLocation;
+  m_pcResetLocation = 0;
+  if ( pcLocation && m_pcLogBook &&
+       m_pcLogBook->locationList().contains(pcLocation) &&
+       m_pcModel->indexOf(pcLocation).isValid() ) {
+    selectLocation(pcLocation);
+    return;
+  }
+  const QModelIndex cFirst = m_pcModel->index(0);
+  if ( cFirst.isValid() )
+    m_pcLocations->setCurrentIndex(cFirst);
+  locationSelected(cFirst);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the current location, or 0 if there is none.
+*/
+//*****************************************************************************
+
+LocationLog*
+LocationView::currentLocation() const
+{
+  return m_pcModel->location(m_pcLocations->currentIndex());
+}
+
+
+//*****************************************************************************
+/*!
+  Make \a pcLocation current, if it is shown, and show its description.
+*/
+//*****************************************************************************
+
+void
+LocationView::selectLocation(LocationLog* pcLocation)
+{
+  const QModelIndex cIndex = m_pcModel->indexOf(pcLocation);
+  if ( cIndex.isValid() ) {
+    m_pcLocations->setCurrentIndex(cIndex);
+    m_pcLocations->scrollTo(cIndex);
+  }
+  locationSelected(cIndex);
+}
+
+
 // Local Variables:
 // mode: c++
 // tab-width: 8
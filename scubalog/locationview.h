@@ -19,9 +19,10 @@
 class QMenu;
 class QPushButton;
 class QLineEdit;
-class QListWidgetItem;
+class QModelIndex;
 class QTextEdit;
 class ListBox;
+class LocationListModel;
 class LogBook;
 class LocationLog;
 
@@ -37,6 +38,11 @@ class LocationLog;
   Currently, only text is supported, but inline pictures will
   be supported in the future.
 
+  The locations are shown through a LocationListModel, which also finds
+  the locations matching the filter typed above the list, and tells the
+  number of dives at each location. The view works on the location logs
+  of the rows, not on row numbers, so the rows can be filtered.
+
   Notice that this class does not take ownership of the location logs,
   that responsibility belongs to the LogBook class
   (although this class might create and delete logs upon request
@@ -58,28 +64,39 @@ public slots:
   void editLocation(const QString& cLocationName);
 
 private slots:
-  void locationSelected(int nLocationIndex);
-  void editLocationName(QListWidgetItem* item);
+  void locationSelected(const QModelIndex& cIndex);
+  void editLocationName(const QModelIndex& cIndex);
   void editCurrentLocationName();
   void newLocation();
   void deleteLocation();
   void locationNameChanged();
   void locationDescriptionChanged();
   void prepareLocationsMenu(QMenu* pcMenu);
+  void rememberCurrentLocation();
+  void restoreCurrentLocation();
 
 private:
+  LocationLog* currentLocation() const;
+  void selectLocation(LocationLog* pcLocation);
+
+  //! The location filter.
+  QLineEdit*         m_pcFilter;
   //! The location selector.
-  ListBox*        m_pcLocations;
+  ListBox*           m_pcLocations;
+  //! The model of the locations.
+  LocationListModel* m_pcModel;
   //! The `new location' button.
-  QPushButton*    m_pcNewLocation;
+  QPushButton*       m_pcNewLocation;
   //! The `delete location' button.
-  QPushButton*    m_pcDeleteLocation;
+  QPushButton*       m_pcDeleteLocation;
   //! The name of the location.
-  QLineEdit*      m_pcLocationName;
+  QLineEdit*         m_pcLocationName;
   //! The location description.
-  QTextEdit*      m_pcLocationDescription;
+  QTextEdit*         m_pcLocationDescription;
   //! The current logbook.
-  LogBook*        m_pcLogBook;
+  LogBook*           m_pcLogBook;
+  //! The location that was current when the model was reset.
+  LocationLog*       m_pcResetLocation;
 };
 
 #endif // LOCATIONVIEW_H
@@ -19,6 +19,10 @@
 #include "divelist.h"
 #include "locationlog.h"
 #include "equipmentlog.h"
+#include "stringpool.h"
+#include "changetracker.h"
+#include "edithistory.h"
+#include "serviceindex.h"
 #include "logbook.h"
 
 
@@ -31,11 +35,26 @@
 LogBook::LogBook()
   : m_pcDiveList(0),
     m_pcLocations(0),
-    m_pcEquipment(0)
+    m_pcEquipment(0),
+    m_pcStrings(0),
+    m_pcTracker(0),
+    m_pcHistory(0),
+    m_pcServiceIndex(0),
+    m_nServiceIndexGeneration(0),
+    m_isServiceIndexBuilt(false)
 {
   m_pcDiveList  = new DiveList();
   m_pcLocations = new QList<LocationLog*>();
   m_pcEquipment = new QList<EquipmentLog*>();
+  m_pcStrings   = new StringPool();
+  m_pcTracker   = new ChangeTracker();
+  m_pcHistory   = new EditHistory();
+  m_pcServiceIndex = new ServiceIndex();
+  m_pcDiveList->setChangeTracker(m_pcTracker);
+  QObject::connect(m_pcTracker, SIGNAL(removingLog(DiveLog*)),
+                   m_pcHistory, SLOT(forgetLog(DiveLog*)));
+  QObject::connect(m_pcHistory, SIGNAL(cleanChanged(bool)),
+                   m_pcTracker, SLOT(historyCleanChanged(bool)));
 }
 
 
@@ -47,8 +66,17 @@ LogBook::LogBook()
 
 LogBook::~LogBook()
 {
+  if ( m_pcServiceIndex ) {
+    delete m_pcServiceIndex;
+    m_pcServiceIndex = 0;
+  }
+
+  if ( m_pcHistory ) {
+    delete m_pcHistory;
+    m_pcHistory = 0;
+  }
+
   if ( m_pcDiveList ) {
-    qDeleteAll(*m_pcDiveList);
     delete m_pcDiveList;
     m_pcDiveList  = 0;
   }
@@ -64,6 +92,106 @@ LogBook::~LogBook()
     delete m_pcEquipment;
     m_pcEquipment = 0;
   }
+
+  if ( m_pcStrings ) {
+    delete m_pcStrings;
+    m_pcStrings = 0;
+  }
+
+  if ( m_pcTracker ) {
+    delete m_pcTracker;
+    m_pcTracker = 0;
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Get the index of the equipment history on date.
+
+  The index is built again if the dates in the equipment history have
+  changed since it was last built, as told by the equipment generation of
+  the change tracker. History edits must therefore be reported to the
+  tracker, as EquipmentHistoryModel does. Other changes, to the dive logs
+  or the names of the items, leave the index as it is.
+*/
+//*****************************************************************************
+
+const ServiceIndex&
+LogBook::serviceIndex() const
+{
+  const unsigned int nGeneration = m_pcTracker->equipmentGeneration();
+  if ( false == m_isServiceIndexBuilt ||
+       nGeneration != m_nServiceIndexGeneration ) {
+    m_pcServiceIndex->build(*m_pcEquipment);
+    m_nServiceIndexGeneration = nGeneration;
+    m_isServiceIndexBuilt = true;
+  }
+  return *m_pcServiceIndex;
+}
+
+
+//*****************************************************************************
+/*!
+  Set the name of the diver to \a cName.
+*/
+//*****************************************************************************
+
+void
+LogBook::setDiverName(const QString& cName)
+{
+  if ( cName != m_cDiverName ) {
+    m_cDiverName = cName;
+    m_pcTracker->personalInfoChanged();
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Set the email address of the owner to \a cAddress.
+*/
+//*****************************************************************************
+
+void
+LogBook::setEmailAddress(const QString& cAddress)
+{
+  if ( cAddress != m_cEmailAddress ) {
+    m_cEmailAddress = cAddress;
+    m_pcTracker->personalInfoChanged();
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Set the WWW URL to \a cWwwUrl.
+*/
+//*****************************************************************************
+
+void
+LogBook::setWwwUrl(const QString& cWwwUrl)
+{
+  if ( cWwwUrl != m_cWwwUrl ) {
+    m_cWwwUrl = cWwwUrl;
+    m_pcTracker->personalInfoChanged();
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Set the comments to \a cComments.
+*/
+//*****************************************************************************
+
+void
+LogBook::setComments(const QString& cComments)
+{
+  if ( cComments != m_cComments ) {
+    m_cComments = cComments;
+    m_pcTracker->personalInfoChanged();
+  }
 }
 
 
@@ -18,8 +18,12 @@
 #include <qlist.h>
 
 class DiveList;
+class ChangeTracker;
+class EditHistory;
+class ServiceIndex;
 class EquipmentLog;
 class LocationLog;
+class StringPool;
 
 //*****************************************************************************
 /*!
@@ -29,6 +33,15 @@ class LocationLog;
   A log book contains a dive log list, personal information and
   an equipment list with history.
 
+  The string pool holds the strings shared by the dive logs, like
+  locations and buddy names. The importers put these strings through it.
+
+  The change tracker records what has changed since the log book was
+  loaded or saved, and the edit history holds the edits that can be undone.
+
+  The service index of the equipment history is built when first asked
+  for, and built again when asked for after the log book has changed.
+
   \author André Johansen
 */
 //*****************************************************************************
@@ -55,15 +68,18 @@ public:
   QList<LocationLog*>& locationList() const { return *m_pcLocations; }
   //! Get the equipment log list.
   QList<EquipmentLog*>& equipmentLog() const { return *m_pcEquipment; }
-
-  //! Set the name of the diver to \a cName.
-  void setDiverName(const QString& cName) { m_cDiverName = cName; }
-  //! Set the email address of the owner to \a cAddress.
-  void setEmailAddress(const QString& cAddress) { m_cEmailAddress = cAddress; }
-  //! Set the WWW URL for \a cWwwUrl.
-  void setWwwUrl(const QString& cWwwUrl) { m_cWwwUrl = cWwwUrl; }
-  //! Set the comments to \a cComments.
-  void setComments(const QString& cComments) { m_cComments = cComments; }
+  //! Get the pool of strings shared by the dive logs.
+  StringPool& stringPool() const { return *m_pcStrings; }
+  //! Get the tracker of changes to the log book.
+  ChangeTracker& changeTracker() const { return *m_pcTracker; }
+  //! Get the undo history of the dive log edits.
+  EditHistory& editHistory() const { return *m_pcHistory; }
+  const ServiceIndex& serviceIndex() const;
+
+  void setDiverName(const QString& cName);
+  void setEmailAddress(const QString& cAddress);
+  void setWwwUrl(const QString& cWwwUrl);
+  void setComments(const QString& cComments);
 
 private:
   //! Disabled copy constructor.
@@ -85,6 +101,18 @@ private:
   QList<LocationLog*>*  m_pcLocations;
   //! The eqipment with history.  The list owns the entries.
   QList<EquipmentLog*>* m_pcEquipment;
+  //! The strings shared by the dive logs.
+  StringPool*           m_pcStrings;
+  //! The tracker of changes.
+  ChangeTracker*        m_pcTracker;
+  //! The undo history.
+  EditHistory*          m_pcHistory;
+  //! The index of the equipment history.
+  ServiceIndex*         m_pcServiceIndex;
+  //! The equipment generation the service index was built at.
+  mutable unsigned int  m_nServiceIndexGeneration;
+  //! Set when the service index has been built.
+  mutable bool          m_isServiceIndexBuilt;
 };
 
 #endif // LOGBOOK_H
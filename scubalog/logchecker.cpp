@@ -0,0 +1,625 @@
+//*****************************************************************************
+/*!
+  \file logchecker.cpp
+  \brief This file contains the implementation of the LogChecker class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "logchecker.h"
+#include "logbook.h"
+#include "divelist.h"
+#include "divelog.h"
+#include "changetracker.h"
+#include <KLocalizedString>
+#include <qelapsedtimer.h>
+#include <qregexp.h>
+#include <qstringlist.h>
+#include <qtimer.h>
+#include <assert.h>
+
+
+/**
+ * The deepest maximum depth taken as real, in meters. It is a bit more
+ * than the deepest scuba dive made.
+ */
+
+static const float s_vMaxDepth = 350.0F;
+
+
+/**
+ * The range of air temperatures taken as real, in degrees Celsius.
+ */
+
+static const float s_vMinAirTemperature = -50.0F;
+static const float s_vMaxAirTemperature = 60.0F;
+
+
+/**
+ * The range of water temperatures taken as real, in degrees Celsius.
+ */
+
+static const float s_vMinWaterTemperature = -3.0F;
+static const float s_vMaxWaterTemperature = 40.0F;
+
+
+/**
+ * Returns `true' if \a vValue is outside [\a vMin, \a vMax].
+ */
+
+static inline bool
+isOutside(float vValue, float vMin, float vMax)
+{
+  return vValue < vMin || vValue > vMax;
+}
+
+
+//*****************************************************************************
+/*!
+  Create an empty model, with \a pcParent as the parent object.
+*/
+//*****************************************************************************
+
+LogChecker::LogChecker(QObject* pcParent)
+  : QAbstractListModel(pcParent),
+    m_pcLogBook(0),
+    m_pcTracker(0),
+    m_nQueueStart(0),
+    m_isSlicePending(false)
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the model. The log book is not touched.
+*/
+//*****************************************************************************
+
+LogChecker::~LogChecker()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Check the logs of \a pcLogBook, or nothing if it is 0.
+  The model doesn't own the log book.
+
+  The results for the old log book are dropped, and all the logs of the
+  new one are queued, to be checked in the background.
+*/
+//*****************************************************************************
+
+void
+LogChecker::setLogBook(LogBook* pcLogBook)
+{
+  beginResetModel();
+  if ( m_pcTracker )
+    disconnect(m_pcTracker, 0, this, 0);
+  m_pcLogBook = pcLogBook;
+  m_pcTracker = pcLogBook ? &pcLogBook->changeTracker() : 0;
+  if ( m_pcTracker ) {
+    connect(m_pcTracker, SIGNAL(changed()), SLOT(logBookChanged()));
+    connect(m_pcTracker, SIGNAL(removingLog(DiveLog*)),
+            SLOT(removingLog(DiveLog*)));
+  }
+  m_apcQueue.clear();
+  m_nQueueStart = 0;
+  m_cQueued.clear();
+  m_cResults.clear();
+  m_cBuddyLogs.clear();
+  m_cBuddySpellings.clear();
+  m_cBuddyKeySpellings.clear();
+  m_apcRows.clear();
+  queueAllLogs();
+  endResetModel();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the log shown at \a cIndex, or 0 if there is none.
+*/
+//*****************************************************************************
+
+DiveLog*
+LogChecker::log(const QModelIndex& cIndex) const
+{
+  if ( false == cIndex.isValid() || cIndex.row() >= m_apcRows.count() )
+    return 0;
+  return m_apcRows.at(cIndex.row());
+}
+
+
+//*****************************************************************************
+/*!
+  Get the problems found when \a pcLog was last checked, as a mask of
+  Problem_e, or 0 if none were found or it hasn't been checked.
+*/
+//*****************************************************************************
+
+int
+LogChecker::problems(const DiveLog* pcLog) const
+{
+  QHash<const DiveLog*, Result>::const_iterator i = m_cResults.find(pcLog);
+  return i == m_cResults.constEnd() ? 0 : i->nProblems;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the number of rows; the number of logs with problems found.
+*/
+//*****************************************************************************
+
+int
+LogChecker::rowCount(const QModelIndex& cParent) const
+{
+  return cParent.isValid() ? 0 : m_apcRows.count();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the data of \a cIndex for the role \a nRole; the log number and
+  what is wrong with the log.
+*/
+//*****************************************************************************
+
+QVariant
+LogChecker::data(const QModelIndex& cIndex, int nRole) const
+{
+  const DiveLog* pcLog = log(cIndex);
+  if ( 0 == pcLog || Qt::DisplayRole != nRole )
+    return QVariant();
+
+  const int nProblems = problems(pcLog);
+  QStringList cProblems;
+  if ( nProblems & e_ShortDiveTime )
+    cProblems << i18n("the dive time is shorter than the bottom time");
+  if ( nProblems & e_BadDepth )
+    cProblems << i18n("the maximum depth can't be right");
+  if ( nProblems & e_BadTemperature )
+    cProblems << i18n("a temperature can't be right");
+  if ( nProblems & e_UnknownLocation )
+    cProblems << i18n("the location '%1' isn't in the location list",
+                      pcLog->diveLocation());
+  if ( nProblems & e_DuplicateNumber )
+    cProblems << i18n("another log has the same number");
+  if ( nProblems & e_RepeatedWord )
+    cProblems << i18n("the word '%1' is repeated in the description",
+                      repeatedWord(pcLog->diveDescription()));
+  if ( nProblems & e_BuddySpelling )
+    cProblems << i18n("the buddy name '%1' is spelt differently in other logs",
+                      pcLog->buddyName().trimmed());
+  return i18nc("Log number and problems", "Log %1: %2",
+               pcLog->logNumber(), cProblems.join("; "));
+}
+
+
+//*****************************************************************************
+/*!
+  The log book has changed. Queue the changed logs, and the logs with the
+  location names added or removed, as whether their location is known
+  may have changed. Nothing else changes the results.
+*/
+//*****************************************************************************
+
+void
+LogChecker::logBookChanged()
+{
+  if ( 0 == m_pcLogBook )
+    return;
+
+  const QSet<DiveLog*>& cLogs = m_pcTracker->changedLogs();
+  QSet<DiveLog*>::const_iterator iLog = cLogs.constBegin();
+  for ( ; iLog != cLogs.constEnd(); ++iLog )
+    queueLog(*iLog);
+
+  const DiveList& cDiveList = m_pcLogBook->diveList();
+  const QSet<QString>& cNames = m_pcTracker->changedLocationNames();
+  QSet<QString>::const_iterator iName = cNames.constBegin();
+  for ( ; iName != cNames.constEnd(); ++iName ) {
+    const QVector<DiveLog*> apcAt = cDiveList.logsAtLocation(*iName);
+    for ( int iAt = 0; iAt < apcAt.count(); ++iAt )
+      queueLog(apcAt.at(iAt));
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  The log \a pcLog is about to be removed. Drop it from the queue and the
+  rows, and check the logs it shared its number with again, and the logs
+  with its buddy name if it had the last log with its spelling.
+*/
+//*****************************************************************************
+
+void
+LogChecker::removingLog(DiveLog* pcLog)
+{
+  // The log is left in the queue vector; it is skipped when not queued
+  m_cQueued.remove(pcLog);
+  QHash<const DiveLog*, Result>::iterator i = m_cResults.find(pcLog);
+  if ( i != m_cResults.end() ) {
+    const int nLogNumber = i->nLogNumber;
+    const QString cBuddyName = i->cBuddyName;
+    const int nRow = i->nRow;
+    m_cResults.erase(i);
+    if ( nRow >= 0 )
+      removeProblemRow(nRow);
+    queueNumbered(nLogNumber, pcLog);
+    uncountBuddy(cBuddyName, pcLog);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Check queued logs until the queue is empty or the time slice is used,
+  and schedule the next slice if logs are left.
+
+  At least one log is checked in each slice, so the queue always drains.
+*/
+//*****************************************************************************
+
+void
+LogChecker::checkSlice()
+{
+  m_isSlicePending = false;
+  QElapsedTimer cTimer;
+  cTimer.start();
+  do {
+    if ( m_nQueueStart >= m_apcQueue.count() )
+      break;
+    DiveLog* pcLog = m_apcQueue.at(m_nQueueStart++);
+    if ( m_cQueued.remove(pcLog) )
+      checkLog(pcLog);
+  } while ( cTimer.elapsed() < e_SliceMsecs );
+
+  if ( m_nQueueStart >= m_apcQueue.count() ) {
+    m_apcQueue.clear();
+    m_nQueueStart = 0;
+  }
+  else {
+    scheduleSlice();
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Find the problems of \a cLog, as a mask of Problem_e. \a isDuplicate
+  tells if another log has the same number.
+*/
+//*****************************************************************************
+
+int
+LogChecker::findProblems(const DiveLog& cLog, bool isDuplicate)
+{
+  int nProblems = 0;
+  if ( cLog.diveTime().isValid() && cLog.bottomTime().isValid() &&
+       cLog.diveTime() < cLog.bottomTime() )
+    nProblems |= e_ShortDiveTime;
+  if ( isOutside(cLog.maxDepth(), 0.0F, s_vMaxDepth) )
+    nProblems |= e_BadDepth;
+  if ( isOutside(cLog.airTemperature(),
+                 s_vMinAirTemperature, s_vMaxAirTemperature) ||
+       isOutside(cLog.waterSurfaceTemperature(),
+                 s_vMinWaterTemperature, s_vMaxWaterTemperature) ||
+       isOutside(cLog.waterTemperature(),
+                 s_vMinWaterTemperature, s_vMaxWaterTemperature) )
+    nProblems |= e_BadTemperature;
+  // A log is linked to the location log with the name of its location
+  if ( 0 == cLog.location() && false == cLog.diveLocation().isEmpty() )
+    nProblems |= e_UnknownLocation;
+  if ( isDuplicate )
+    nProblems |= e_DuplicateNumber;
+  if ( false == repeatedWord(cLog.diveDescription()).isEmpty() )
+    nProblems |= e_RepeatedWord;
+  return nProblems;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the first word in \a cText that is followed by the same word, like
+  `the the', ignoring case, or an empty string if there is none.
+*/
+//*****************************************************************************
+
+QString
+LogChecker::repeatedWord(const QString& cText)
+{
+  static const QRegExp cRepeated("\\b(\\w+)\\s+\\1\\b", Qt::CaseInsensitive);
+  QRegExp cExpression(cRepeated);
+  if ( cExpression.indexIn(cText) < 0 )
+    return QString();
+  return cExpression.cap(1);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the key the spellings of the buddy name \a cName are counted under;
+  the name in lower case, with the white space simplified.
+*/
+//*****************************************************************************
+
+QString
+LogChecker::buddyKey(const QString& cName)
+{
+  return cName.simplified().toLower();
+}
+
+
+//*****************************************************************************
+/*!
+  Queue \a pcLog to be checked, unless it is queued already.
+*/
+//*****************************************************************************
+
+void
+LogChecker::queueLog(DiveLog* pcLog)
+{
+  if ( m_cQueued.contains(pcLog) )
+    return;
+  m_cQueued.insert(pcLog);
+  m_apcQueue.append(pcLog);
+  scheduleSlice();
+}
+
+
+//*****************************************************************************
+/*!
+  Queue all the logs of the log book, in list order.
+*/
+//*****************************************************************************
+
+void
+LogChecker::queueAllLogs()
+{
+  if ( 0 == m_pcLogBook )
+    return;
+  const DiveList& cDiveList = m_pcLogBook->diveList();
+  m_cQueued.reserve(cDiveList.count());
+  DiveList::const_iterator iLog = cDiveList.begin();
+  for ( ; iLog != cDiveList.end(); ++iLog )
+    queueLog(*iLog);
+}
+
+
+//*****************************************************************************
+/*!
+  Queue the logs with the number \a nLogNumber, except \a pcExcept.
+*/
+//*****************************************************************************
+
+void
+LogChecker::queueNumbered(int nLogNumber, const DiveLog* pcExcept)
+{
+  const QList<DiveLog*> apcLogs =
+    m_pcLogBook->diveList().logsNumbered(nLogNumber);
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog ) {
+    if ( apcLogs.at(iLog) != pcExcept )
+      queueLog(apcLogs.at(iLog));
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Queue the logs with the buddy name key \a cKey, except \a pcExcept.
+*/
+//*****************************************************************************
+
+void
+LogChecker::queueBuddy(const QString& cKey, const DiveLog* pcExcept)
+{
+  const QSet<DiveLog*> cLogs = m_cBuddyLogs.value(cKey);
+  QSet<DiveLog*>::const_iterator iLog = cLogs.constBegin();
+  for ( ; iLog != cLogs.constEnd(); ++iLog ) {
+    if ( *iLog != pcExcept )
+      queueLog(*iLog);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Count \a pcLog as having the buddy name \a cName. If this is the first
+  log with this spelling, and the name had one spelling before, the other
+  logs with the name are queued, as they now have a spelling problem.
+*/
+//*****************************************************************************
+
+void
+LogChecker::countBuddy(const QString& cName, DiveLog* pcLog)
+{
+  if ( cName.isEmpty() )
+    return;
+  const QString cKey = buddyKey(cName);
+  m_cBuddyLogs[cKey].insert(pcLog);
+  if ( 1 == ++m_cBuddySpellings[cName] &&
+       2 == ++m_cBuddyKeySpellings[cKey] )
+    queueBuddy(cKey, pcLog);
+}
+
+
+//*****************************************************************************
+/*!
+  Stop counting \a pcLog as having the buddy name \a cName. If it was the
+  last log with this spelling, and one spelling is left, the other logs
+  with the name are queued, as they no longer have a spelling problem.
+*/
+//*****************************************************************************
+
+void
+LogChecker::uncountBuddy(const QString& cName, DiveLog* pcLog)
+{
+  if ( cName.isEmpty() )
+    return;
+  const QString cKey = buddyKey(cName);
+  QHash<QString, QSet<DiveLog*> >::iterator iLogs = m_cBuddyLogs.find(cKey);
+  if ( iLogs != m_cBuddyLogs.end() ) {
+    iLogs->remove(pcLog);
+    if ( iLogs->isEmpty() )
+      m_cBuddyLogs.erase(iLogs);
+  }
+
+  QHash<QString, int>::iterator iSpelling = m_cBuddySpellings.find(cName);
+  if ( iSpelling == m_cBuddySpellings.end() || --*iSpelling > 0 )
+    return;
+  m_cBuddySpellings.erase(iSpelling);
+  QHash<QString, int>::iterator iKey = m_cBuddyKeySpellings.find(cKey);
+  assert(iKey != m_cBuddyKeySpellings.end());
+  if ( 1 == --*iKey )
+    queueBuddy(cKey, pcLog);
+  else if ( 0 == *iKey )
+    m_cBuddyKeySpellings.erase(iKey);
+}
+
+
+//*****************************************************************************
+/*!
+  Have checkSlice() called from the event loop, unless it already is.
+*/
+//*****************************************************************************
+
+void
+LogChecker::scheduleSlice()
+{
+  if ( false == m_isSlicePending ) {
+    m_isSlicePending = true;
+    QTimer::singleShot(0, this, SLOT(checkSlice()));
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Check \a pcLog, and update its row.
+
+  If the log number has changed since the log was last checked, or the
+  log is new and a duplicate, the logs with the old number and the new one
+  are queued, as they may have stopped or started being duplicates. If the
+  buddy name has changed, it is counted under the new spelling, which may
+  queue the logs with the old or new name, see countBuddy().
+*/
+//*****************************************************************************
+
+void
+LogChecker::checkLog(DiveLog* pcLog)
+{
+  const DiveList& cDiveList = m_pcLogBook->diveList();
+  if ( cDiveList.indexOf(pcLog) < 0 )
+    return;
+
+  const int nLogNumber = pcLog->logNumber();
+  const bool isDuplicate = cDiveList.logsNumbered(nLogNumber).count() > 1;
+  const QString cBuddyName = pcLog->buddyName().trimmed();
+  QHash<const DiveLog*, Result>::iterator i = m_cResults.find(pcLog);
+  if ( i == m_cResults.end() ) {
+    Result cResult;
+    cResult.nLogNumber = nLogNumber;
+    cResult.nProblems = 0;
+    cResult.nRow = -1;
+    cResult.cBuddyName = cBuddyName;
+    m_cResults.insert(pcLog, cResult);
+    if ( isDuplicate )
+      queueNumbered(nLogNumber, pcLog);
+    countBuddy(cBuddyName, pcLog);
+  }
+  else {
+    if ( i->nLogNumber != nLogNumber ) {
+      queueNumbered(i->nLogNumber, pcLog);
+      queueNumbered(nLogNumber, pcLog);
+      i->nLogNumber = nLogNumber;
+    }
+    if ( i->cBuddyName != cBuddyName ) {
+      const QString cOldName = i->cBuddyName;
+      i->cBuddyName = cBuddyName;
+      uncountBuddy(cOldName, pcLog);
+      countBuddy(cBuddyName, pcLog);
+    }
+  }
+
+  int nProblems = findProblems(*pcLog, isDuplicate);
+  if ( false == cBuddyName.isEmpty() &&
+       m_cBuddyKeySpellings.value(buddyKey(cBuddyName)) > 1 )
+    nProblems |= e_BuddySpelling;
+  setProblems(pcLog, nProblems);
+}
+
+
+//*****************************************************************************
+/*!
+  Record \a nProblems as the problems of \a pcLog, adding, updating or
+  removing its row. The row of the log is kept in its result, so it isn't
+  searched for.
+*/
+//*****************************************************************************
+
+void
+LogChecker::setProblems(DiveLog* pcLog, int nProblems)
+{
+  Result& cResult = m_cResults[pcLog];
+  const int nOldProblems = cResult.nProblems;
+  cResult.nProblems = nProblems;
+  if ( 0 == nOldProblems && 0 == nProblems )
+    return;
+
+  const int nRow = cResult.nRow;
+  if ( nRow < 0 ) {
+    if ( nProblems ) {
+      const int nNewRow = m_apcRows.count();
+      beginInsertRows(QModelIndex(), nNewRow, nNewRow);
+      m_apcRows.append(pcLog);
+      cResult.nRow = nNewRow;
+      endInsertRows();
+    }
+  }
+  else if ( 0 == nProblems ) {
+    cResult.nRow = -1;
+    removeProblemRow(nRow);
+  }
+  else {
+    // The log number or location in the text may have changed too
+    const QModelIndex cIndex = index(nRow);
+    emit dataChanged(cIndex, cIndex);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Remove the row \a nRow. The rows after it move up one, and the rows kept
+  in their results are updated, which takes time in proportion to the rows
+  after it, as the removal itself does.
+*/
+//*****************************************************************************
+
+void
+LogChecker::removeProblemRow(int nRow)
+{
+  beginRemoveRows(QModelIndex(), nRow, nRow);
+  m_apcRows.remove(nRow);
+  for ( int iRow = nRow; iRow < m_apcRows.count(); ++iRow )
+    m_cResults[m_apcRows.at(iRow)].nRow = iRow;
+  endRemoveRows();
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,166 @@
+//*****************************************************************************
+/*!
+  \file logchecker.h
+  \brief This file contains the definition of the LogChecker class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef LOGCHECKER_H
+#define LOGCHECKER_H
+
+#include <QAbstractListModel>
+#include <qhash.h>
+#include <qset.h>
+#include <qstring.h>
+#include <qvector.h>
+
+class DiveLog;
+class LogBook;
+class ChangeTracker;
+
+
+//*****************************************************************************
+/*!
+  \class LogChecker
+  \brief The LogChecker class checks the dive logs for problems, and is a
+  list model of the logs with problems.
+
+  A log is checked for a dive time shorter than the bottom time, a maximum
+  depth or temperature that can't be right, a location that isn't in the
+  location list, and a log number used by another log too. The description
+  is checked for a word typed twice in a row, and the buddy name for being
+  spelt differently, in case or spacing, in other logs. There is one row
+  per log with problems, telling what they are.
+
+  The logs are checked in the background, from the event loop, a slice of
+  at most #e_SliceMsecs milliseconds at a time, so a big log book is
+  checked without stalling the editing. The logs to check are kept in
+  a queue. All the logs are queued when a log book is set, and then only
+  the logs the change tracker reports as changed, and the logs at the
+  locations it reports as added, renamed or removed, as they may have
+  become linked or unlinked. Other changes don't touch the results.
+
+  The log number each log was last checked with is kept, so when a log
+  changes its number, the logs with its old and new numbers are checked
+  again, and start or stop being duplicates. In the same way, the buddy
+  name is kept, with the logs and spellings of each name, so when a new
+  spelling of a name appears, or the last log with one goes, only the logs
+  with that name are checked again.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class LogChecker : public QAbstractListModel {
+  Q_OBJECT
+public:
+  //! The problems a log can have, as bits in a mask.
+  enum Problem_e {
+    //! The dive time is shorter than the bottom time.
+    e_ShortDiveTime     = 1 << 0,
+    //! The maximum depth is negative, or deeper than anyone has dived.
+    e_BadDepth          = 1 << 1,
+    //! A temperature is far outside what is found on a dive.
+    e_BadTemperature    = 1 << 2,
+    //! The location isn't in the location list.
+    e_UnknownLocation   = 1 << 3,
+    //! Another log has the same log number.
+    e_DuplicateNumber   = 1 << 4,
+    //! The description has a word twice in a row.
+    e_RepeatedWord      = 1 << 5,
+    //! Other logs spell the buddy name differently.
+    e_BuddySpelling     = 1 << 6
+  };
+
+  //! The longest time spent checking logs before yielding, in milliseconds.
+  enum { e_SliceMsecs = 5 };
+
+  LogChecker(QObject* pcParent = 0);
+  virtual ~LogChecker();
+
+  void setLogBook(LogBook* pcLogBook);
+  DiveLog* log(const QModelIndex& cIndex) const;
+  int problems(const DiveLog* pcLog) const;
+  //! Returns `true' if there are logs waiting to be checked.
+  bool isChecking() const { return false == m_apcQueue.isEmpty(); }
+
+  virtual int rowCount(const QModelIndex& cParent = QModelIndex()) const;
+  virtual QVariant data(const QModelIndex& cIndex,
+                        int nRole = Qt::DisplayRole) const;
+
+private slots:
+  void logBookChanged();
+  void removingLog(DiveLog* pcLog);
+  void checkSlice();
+
+private:
+  //! Disabled copy constructor.
+  LogChecker(const LogChecker&);
+  //! Disabled assignment operator.
+  LogChecker& operator =(const LogChecker&);
+
+  //! What was found when a log was last checked.
+  struct Result {
+    //! The log number the log had.
+    int nLogNumber;
+    //! The problems found, as a mask of Problem_e.
+    int nProblems;
+    //! The row showing the log, or -1 if it has none.
+    int nRow;
+    //! The buddy name the log had, trimmed.
+    QString cBuddyName;
+  };
+
+  static int findProblems(const DiveLog& cLog, bool isDuplicate);
+  static QString repeatedWord(const QString& cText);
+  static QString buddyKey(const QString& cName);
+  void queueLog(DiveLog* pcLog);
+  void queueAllLogs();
+  void queueNumbered(int nLogNumber, const DiveLog* pcExcept);
+  void queueBuddy(const QString& cKey, const DiveLog* pcExcept);
+  void countBuddy(const QString& cName, DiveLog* pcLog);
+  void uncountBuddy(const QString& cName, DiveLog* pcLog);
+  void scheduleSlice();
+  void checkLog(DiveLog* pcLog);
+  void setProblems(DiveLog* pcLog, int nProblems);
+  void removeProblemRow(int nRow);
+
+  //! The log book, or 0.
+  LogBook*                       m_pcLogBook;
+  //! The change tracker of the log book, or 0.
+  ChangeTracker*                 m_pcTracker;
+  //! The logs waiting to be checked, first checked first.
+  QVector<DiveLog*>              m_apcQueue;
+  //! The position in #m_apcQueue of the next log to check.
+  int                            m_nQueueStart;
+  //! The logs in the queue.
+  QSet<DiveLog*>                 m_cQueued;
+  //! What was found for each log checked.
+  QHash<const DiveLog*, Result>  m_cResults;
+  //! The logs checked with each buddy name, by buddyKey().
+  QHash<QString, QSet<DiveLog*> > m_cBuddyLogs;
+  //! The number of logs checked with each spelling of a buddy name.
+  QHash<QString, int>            m_cBuddySpellings;
+  //! The number of spellings in use of each buddy name, by buddyKey().
+  QHash<QString, int>            m_cBuddyKeySpellings;
+  //! The logs with problems; the rows.
+  QVector<DiveLog*>              m_apcRows;
+  //! Set when checkSlice() has been scheduled.
+  bool                           m_isSlicePending;
+};
+
+#endif // LOGCHECKER_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -13,21 +13,70 @@
 
 #include "loglistview.h"
 #include "divelist.h"
+#include "divelistmodel.h"
+#include "divelogedit.h"
+#include "changetracker.h"
 #include "debug.h"
 
 #include <KLocalizedString>
 #include <qmessagebox.h>
 #include <qlayout.h>
+#include <qlabel.h>
+#include <qlineedit.h>
 #include <qpushbutton.h>
-#include <QTableWidget>
+#include <qundostack.h>
+#include <QInputDialog>
+#include <QItemSelectionModel>
+#include <QTableView>
 #include <QHeaderView>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QApplication>
 #include <new>
+#include <algorithm>
 #include <assert.h>
 
 
+/**
+ * The fields that can be set in many logs at once.
+ */
+
+static const DiveLogEdit::Field_e s_aeBatchFields[] = {
+  DiveLogEdit::e_DiveLocation,
+  DiveLogEdit::e_BuddyName,
+  DiveLogEdit::e_DiveType,
+  DiveLogEdit::e_GasType
+};
+
+
+/**
+ * The number of fields that can be set in many logs at once.
+ */
+
+static const int s_nNumBatchFields =
+  sizeof(s_aeBatchFields) / sizeof(s_aeBatchFields[0]);
+
+
+//*****************************************************************************
+/*!
+  \brief Orders logs on their position in a dive list.
+*/
+//*****************************************************************************
+
+struct ListIndexLess {
+  //! Create an ordering on the positions in \a cList.
+  explicit ListIndexLess(const DiveList& cList) : m_cList(cList) {}
+
+  //! Returns `true' if \a pcLog1 is before \a pcLog2 in the list.
+  bool operator ()(const DiveLog* pcLog1, const DiveLog* pcLog2) const {
+    return m_cList.indexOf(pcLog1) < m_cList.indexOf(pcLog2);
+  }
+
+  //! The list of the logs.
+  const DiveList& m_cList;
+};
+
+
 //*****************************************************************************
 /*!
   Create the log list view with \a pcParent as parent widget.
@@ -36,34 +85,53 @@
 
 LogListView::LogListView(QWidget* pcParent)
   : QWidget(pcParent),
-    m_pcDiveListWidget(0),
+    m_pcDiveListView(0),
+    m_pcModel(0),
+    m_pcFilter(0),
     m_pcNewLog(0),
     m_pcDeleteLog(0),
+    m_pcEditLogs(0),
+    m_pcExportLogs(0),
     m_pcViewLog(0),
-    m_pcDiveLogList(0)
+    m_pcDiveLogList(0),
+    m_pcHistory(0),
+    m_pcTracker(0),
+    m_pcResetLog(0)
 {
-  m_pcDiveListWidget = new QTableWidget(0, 4, this);
-  m_pcDiveListWidget->setSelectionMode(QTableWidget::SingleSelection);
-  m_pcDiveListWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
-  m_pcDiveListWidget->verticalHeader()->hide();
-  QTableWidgetItem* h;
-  h = new QTableWidgetItem(i18n("Dive"));
-  m_pcDiveListWidget->setHorizontalHeaderItem(0, h);
-  h = new QTableWidgetItem(i18n("Date"));
-  m_pcDiveListWidget->setHorizontalHeaderItem(1, h);
-  h = new QTableWidgetItem(i18n("Time"));
-  m_pcDiveListWidget->setHorizontalHeaderItem(2, h);
-  h = new QTableWidgetItem(i18n("Location"));
-  m_pcDiveListWidget->setHorizontalHeaderItem(3, h);
-
-  QHeaderView* header = m_pcDiveListWidget->horizontalHeader();
+  m_pcModel = new DiveListModel(this);
+  m_pcDiveListView = new QTableView(this);
+  m_pcDiveListView->setModel(m_pcModel);
+  m_pcDiveListView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+  m_pcDiveListView->setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_pcDiveListView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_pcDiveListView->verticalHeader()->hide();
+  // Fixed row heights; the rows are never measured
+  m_pcDiveListView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+  QHeaderView* header = m_pcDiveListView->horizontalHeader();
   header->setStretchLastSection(true);
-  //m_pcDiveListWidget->setSortingEnabled(true);
-  //m_pcDiveListWidget->sortByColumn(0, Qt::AscendingOrder);
-  connect(m_pcDiveListWidget, SIGNAL(cellDoubleClicked(int, int)),
-          SLOT(viewLog(int, int)));
-  connect(m_pcDiveListWidget, SIGNAL(cellActivated(int, int)),
-          SLOT(selectedLogChanged(int, int)));
+  // Start in list order; sorting is done on the first header click
+  header->setSortIndicator(-1, Qt::AscendingOrder);
+  m_pcDiveListView->setSortingEnabled(true);
+  connect(m_pcModel, SIGNAL(modelAboutToBeReset()),
+          SLOT(rememberCurrentLog()));
+  connect(m_pcModel, SIGNAL(modelReset()), SLOT(restoreCurrentLog()));
+  connect(m_pcDiveListView, SIGNAL(doubleClicked(const QModelIndex&)),
+          SLOT(viewLog(const QModelIndex&)));
+  connect(m_pcDiveListView->selectionModel(),
+          SIGNAL(currentRowChanged(const QModelIndex&, const QModelIndex&)),
+          SLOT(selectedLogChanged(const QModelIndex&)));
+  connect(m_pcDiveListView->selectionModel(),
+          SIGNAL(selectionChanged(const QItemSelection&,
+                                  const QItemSelection&)),
+          SLOT(selectionChanged()));
+
+  QLabel* pcFilterLabel = new QLabel(i18n("&Filter:"), this);
+  m_pcFilter = new QLineEdit(this);
+  m_pcFilter->setClearButtonEnabled(true);
+  pcFilterLabel->setBuddy(m_pcFilter);
+  connect(m_pcFilter, SIGNAL(textChanged(const QString&)),
+          m_pcModel, SLOT(setFilter(const QString&)));
 
   m_pcNewLog = new QPushButton(this);
   m_pcNewLog->setText(i18n("&New log entry"));
@@ -76,6 +144,18 @@ LogListView::LogListView(QWidget* pcParent)
   m_pcDeleteLog->setEnabled(false);
   connect(m_pcDeleteLog, SIGNAL(clicked()), SLOT(deleteLog()));
 
+  m_pcEditLogs = new QPushButton(this);
+  m_pcEditLogs->setText(i18n("&Edit logs..."));
+  m_pcEditLogs->setMinimumSize(m_pcEditLogs->sizeHint());
+  m_pcEditLogs->setEnabled(false);
+  connect(m_pcEditLogs, SIGNAL(clicked()), SLOT(editLogs()));
+
+  m_pcExportLogs = new QPushButton(this);
+  m_pcExportLogs->setText(i18n("E&xport logs..."));
+  m_pcExportLogs->setMinimumSize(m_pcExportLogs->sizeHint());
+  m_pcExportLogs->setEnabled(false);
+  connect(m_pcExportLogs, SIGNAL(clicked()), SLOT(exportLogs()));
+
   m_pcViewLog = new QPushButton(this);
   m_pcViewLog->setText(i18n("&View log"));
   m_pcViewLog->setMinimumSize(m_pcViewLog->sizeHint());
@@ -83,11 +163,17 @@ LogListView::LogListView(QWidget* pcParent)
   connect(m_pcViewLog, SIGNAL(clicked()), SLOT(viewLog()));
 
   QVBoxLayout* pcDLVTopLayout = new QVBoxLayout(this);
-  pcDLVTopLayout->addWidget(m_pcDiveListWidget, 10);
+  QHBoxLayout* pcDLVFilterLayout = new QHBoxLayout();
+  pcDLVTopLayout->addLayout(pcDLVFilterLayout);
+  pcDLVFilterLayout->addWidget(pcFilterLabel);
+  pcDLVFilterLayout->addWidget(m_pcFilter, 10);
+  pcDLVTopLayout->addWidget(m_pcDiveListView, 10);
   QHBoxLayout* pcDLVButtonLayout = new QHBoxLayout();
   pcDLVTopLayout->addLayout(pcDLVButtonLayout);
   pcDLVButtonLayout->addWidget(m_pcNewLog);
   pcDLVButtonLayout->addWidget(m_pcDeleteLog);
+  pcDLVButtonLayout->addWidget(m_pcEditLogs);
+  pcDLVButtonLayout->addWidget(m_pcExportLogs);
   pcDLVButtonLayout->addStretch(10);
   pcDLVButtonLayout->addWidget(m_pcViewLog);
   pcDLVTopLayout->activate();
@@ -105,39 +191,15 @@ LogListView::~LogListView()
 }
 
 
-/**
- * Insert the dive log \a log at \a row in the view.
- */
-
-void
-LogListView::insertLogAt(int row, const DiveLog* log)
-{
-  QTableWidgetItem* diveItem = new QTableWidgetItem();
-  diveItem->setData(Qt::DisplayRole, log->logNumber());
-  QTableWidgetItem* dateItem = new QTableWidgetItem();
-  dateItem->setData(Qt::DisplayRole, log->diveDate());
-  QTableWidgetItem* timeItem = new QTableWidgetItem();
-  timeItem->setData(Qt::DisplayRole, log->diveStart());
-  QTableWidgetItem* locationItem = new QTableWidgetItem();
-  locationItem->setData(Qt::DisplayRole, log->diveLocation());
-  if ( row >= m_pcDiveListWidget->rowCount() ) {
-    m_pcDiveListWidget->setRowCount(row+1);
-  }
-  m_pcDiveListWidget->setItem(row, 0, diveItem);
-  m_pcDiveListWidget->setItem(row, 1, dateItem);
-  m_pcDiveListWidget->setItem(row, 2, timeItem);
-  m_pcDiveListWidget->setItem(row, 3, locationItem);
-}
-
-
 //*****************************************************************************
 /*!
-  Use \a pcDiveList as the current dive log list.
+  Use \a pcDiveList as the current dive log list, and push the edits of
+  the selected logs on \a pcHistory.
   If a 0-pointer is passed, the view will be cleared, and no editing will
   be possible.
 
-  The log list view will be cleared, and all the logs from the new list
-  will be inserted in the view.
+  The view reads the logs from the list as they are shown, so unless the
+  list is sorted or filtered, this takes the same time whatever its size.
 
   Notice that this class does not take ownership of the list itself,
   but it can insert and delete logs from it.
@@ -145,21 +207,23 @@ LogListView::insertLogAt(int row, const DiveLog* log)
 //*****************************************************************************
 
 void
-LogListView::setLogList(DiveList* pcDiveList)
+LogListView::setLogList(DiveList* pcDiveList, QUndoStack* pcHistory)
 {
-  assert(m_pcDiveListWidget);
+  assert(m_pcModel);
 
-  m_pcDiveListWidget->clearContents();
+  if ( m_pcTracker )
+    disconnect(m_pcTracker, 0, this, 0);
   m_pcDiveLogList = pcDiveList;
-  if ( pcDiveList ) {
-    int row = 0;
-    QListIterator<DiveLog*> iLog(*pcDiveList);
-    while ( iLog.hasNext() ) {
-      DiveLog* pcLog = iLog.next();
-      insertLogAt(row, pcLog);
-      ++row;
-    }
-  }
+  m_pcHistory = pcHistory;
+  m_pcTracker = pcDiveList ? pcDiveList->changeTracker() : 0;
+  if ( m_pcTracker )
+    connect(m_pcTracker, SIGNAL(removingLog(DiveLog*)),
+            SLOT(removingLog(DiveLog*)));
+  m_pcModel->setDiveList(pcDiveList);
+  m_pcDeleteLog->setEnabled(false);
+  m_pcEditLogs->setEnabled(false);
+  m_pcExportLogs->setEnabled(false);
+  m_pcViewLog->setEnabled(false);
 }
 
 
@@ -167,8 +231,8 @@ LogListView::setLogList(DiveList* pcDiveList)
 /*!
   Create a new log entry. The log view will be displayed.
 
-  The log number will be the last logs number plus one, or 1 if this is the
-  first log.
+  The log number will be the highest number in use plus one, or 1 if this
+  is the first log.
 */
 //*****************************************************************************
 
@@ -177,24 +241,20 @@ LogListView::createNewLog()
 {
   assert(m_pcDiveLogList);
 
-  int nDiveNumber = 1;
-  const int rows = m_pcDiveListWidget->rowCount();
-  if ( rows ) {
-    QTableWidgetItem* pcLastItem = m_pcDiveListWidget->item(rows-1, 0);
-    nDiveNumber += pcLastItem->text().toInt();
-  }
+  const int nDiveNumber = m_pcDiveLogList->nextLogNumber();
 
   DiveLog* pcLog = 0;
   try {
-    pcLog = new DiveLog();
+    pcLog = m_pcDiveLogList->newLog();
     pcLog->setLogNumber(nDiveNumber);
-    m_pcDiveLogList->append(pcLog);
-    insertLogAt(rows, pcLog);
+    m_pcModel->appendLog(pcLog);
+    m_pcDiveListView->setCurrentIndex(m_pcModel->indexOf(pcLog));
     emit displayLog(pcLog);
   }
   catch ( std::bad_alloc& ) {
     // In case of OOM, delete the log to be sure...
-    delete pcLog;
+    if ( pcLog )
+      m_pcModel->deleteLog(pcLog);
     QMessageBox::warning(QApplication::topLevelWidgets().at(0),
                          i18n("[ScubaLog] New dive log"),
                          i18n("Out of memory when creating a new dive log!"));
@@ -202,31 +262,14 @@ LogListView::createNewLog()
 }
 
 
-/**
- * Get the dive with log number \a number from the dive log list.
- * Returns the dive log if found, else NULL.
- */
-
-DiveLog* LogListView::getDiveLogNumber(int number)
-{
-  assert(m_pcDiveLogList != 0);
-  for ( int i = 0; i < m_pcDiveLogList->size(); ++i ) {
-    DiveLog* log = m_pcDiveLogList->at(i);
-    if ( log->logNumber() == number ) {
-      return log;
-    }
-  }
-  return NULL;
-}
-
-
 //*****************************************************************************
 /*!
-  Delete the current log if one is selected.
-  Just before the log is deleted, the signal aboutToDeleteLog() will be
+  Delete the selected logs, if any, after asking once.
+  Just before the logs are deleted, the signal aboutToDeleteLogs() will be
   emitted.
 
-  The log wil be deleted from the log list.
+  The logs are deleted from the log list together, and the view is
+  updated once, however many logs are selected.
 */
 //*****************************************************************************
 
@@ -234,28 +277,119 @@ void
 LogListView::deleteLog()
 {
   assert(m_pcDiveLogList);
-  int row = m_pcDiveListWidget->currentRow();
-  const QTableWidgetItem* item = m_pcDiveListWidget->item(row, 0);
-  if ( item ) {
-    DiveLog* pcLog = getDiveLogNumber(item->data(Qt::DisplayRole).toInt());
-    DBG(("About to delete dive log #%d\n", pcLog->logNumber()));
-    QString cMessage =
+  const QVector<DiveLog*> apcLogs = selectedLogs();
+  if ( apcLogs.isEmpty() )
+    return;
+
+  QString cMessage;
+  if ( 1 == apcLogs.count() ) {
+    const DiveLog* pcLog = apcLogs.first();
+    cMessage =
       QString(i18n("Are you sure you want to delete log %1?\n"
                    "(location: '%2')"))
       .arg(pcLog->logNumber())
       .arg(QString(pcLog->diveLocation().data()));
-    int nResult = QMessageBox::information(QApplication::topLevelWidgets().at(0),
-                                           i18n("[ScubaLog] Delete log"),
-                                           cMessage,
-                                           i18n("&Yes"), i18n("&No"));
-    if ( 0 == nResult ) {
-      emit aboutToDeleteLog(pcLog);
-      m_pcDiveListWidget->removeRow(row);
-      m_pcDiveLogList->removeAll(pcLog);
-      delete pcLog;
-      DBG(("Deleted dive log...\n"));
+  }
+  else {
+    cMessage = i18n("Are you sure you want to delete the %1 selected logs?",
+                    apcLogs.count());
+  }
+  int nResult = QMessageBox::information(QApplication::topLevelWidgets().at(0),
+                                         i18n("[ScubaLog] Delete log"),
+                                         cMessage,
+                                         i18n("&Yes"), i18n("&No"));
+  if ( 0 == nResult ) {
+    DBG(("About to delete %d dive logs\n", apcLogs.count()));
+    emit aboutToDeleteLogs(apcLogs);
+    m_pcModel->deleteLogs(apcLogs);
+    DBG(("Deleted dive logs...\n"));
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Set one of the location, buddy, dive type or gas type to the same value
+  in all the selected logs. The field and the value are asked for; if the
+  logs already share a value, it is suggested.
+
+  All the changes are pushed as one edit, so they are undone as one step,
+  and the view is updated once from the change tracker.
+*/
+//*****************************************************************************
+
+void
+LogListView::editLogs()
+{
+  const QVector<DiveLog*> apcLogs = selectedLogs();
+  if ( apcLogs.isEmpty() || 0 == m_pcHistory )
+    return;
+
+  QStringList cFieldNames;
+  cFieldNames << i18n("Location") << i18n("Buddy")
+              << i18n("Dive type") << i18n("Gas type");
+  assert(s_nNumBatchFields == cFieldNames.count());
+  const QString cCaption(i18n("[ScubaLog] Edit logs"));
+  bool isOk = false;
+  const QString cFieldName =
+    QInputDialog::getItem(this, cCaption,
+                          i18np("Field to set in the selected log:",
+                                "Field to set in the %1 selected logs:",
+                                apcLogs.count()),
+                          cFieldNames, 0, false, &isOk);
+  const int nField = cFieldNames.indexOf(cFieldName);
+  if ( false == isOk || nField < 0 )
+    return;
+  const DiveLogEdit::Field_e eField = s_aeBatchFields[nField];
+
+  // Suggest the value if all the logs share it
+  QString cValue =
+    DiveLogEdit::fieldValue(*apcLogs.first(), eField).toString();
+  for ( int iLog = 1; iLog < apcLogs.count(); ++iLog ) {
+    if ( DiveLogEdit::fieldValue(*apcLogs.at(iLog), eField).toString() !=
+         cValue ) {
+      cValue.clear();
+      break;
     }
   }
+  cValue = QInputDialog::getText(this, cCaption, cFieldName,
+                                 QLineEdit::Normal, cValue, &isOk);
+  if ( false == isOk )
+    return;
+
+  // Text typed in the log view is written before the edit is made
+  emit aboutToEditLogs();
+  DiveLogEdit* pcEdit =
+    new DiveLogEdit(i18np("Edit 1 log", "Edit %1 logs", apcLogs.count()));
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog )
+    pcEdit->addChange(apcLogs.at(iLog), eField, cValue);
+  if ( 0 == pcEdit->numChanges() ) {
+    delete pcEdit;
+    return;
+  }
+  m_pcHistory->push(pcEdit);
+}
+
+
+//*****************************************************************************
+/*!
+  Export the selected logs, if any, by emitting exportSelection().
+*/
+//*****************************************************************************
+
+void
+LogListView::exportLogs()
+{
+  assert(m_pcDiveLogList);
+  const QVector<DiveLog*> apcLogs = selectedLogs();
+  if ( apcLogs.isEmpty() )
+    return;
+
+  QVector<int> anIndices;
+  anIndices.reserve(apcLogs.count());
+  for ( int iLog = 0; iLog < apcLogs.count(); ++iLog )
+    anIndices.append(m_pcDiveLogList->indexOf(apcLogs.at(iLog)));
+  emit exportSelection(DiveSelection(anIndices));
 }
 
 
@@ -269,29 +403,24 @@ void
 LogListView::viewLog()
 {
   assert(m_pcDiveLogList);
-  int row = m_pcDiveListWidget->currentRow();
-  const QTableWidgetItem* item = m_pcDiveListWidget->item(row, 0);
-  if ( item ) {
-    DiveLog* log = getDiveLogNumber(item->data(Qt::DisplayRole).toInt());
-    if ( log ) {
-      emit displayLog(log);
-    }
+  DiveLog* log = m_pcModel->log(m_pcDiveListView->currentIndex());
+  if ( log ) {
+    emit displayLog(log);
   }
 }
 
 
 //*****************************************************************************
 /*!
-  Display the log corresponding to \a pcItem.
+  Display the log at \a cIndex.
 */
 //*****************************************************************************
 
 void
-LogListView::viewLog(int row, int col)
+LogListView::viewLog(const QModelIndex& cIndex)
 {
-  int logs = m_pcDiveLogList->count();
-  if ( row < logs ) {
-    DiveLog* log = m_pcDiveLogList->at(row);
+  DiveLog* log = m_pcModel->log(cIndex);
+  if ( log ) {
     emit displayLog(log);
   }
 }
@@ -299,17 +428,113 @@ LogListView::viewLog(int row, int col)
 
 //*****************************************************************************
 /*!
-  The current selected log has changed to \a pcItem, update the GUI.
+  The current selected log has changed to the one at \a cIndex,
+  update the GUI.
 */
 //*****************************************************************************
 
 void
-LogListView::selectedLogChanged(int row, int col)
+LogListView::selectedLogChanged(const QModelIndex& cIndex)
 {
-  assert(m_pcDeleteLog);
   assert(m_pcViewLog);
-  m_pcDeleteLog->setEnabled(true);
-  m_pcViewLog->setEnabled(true);
+  m_pcViewLog->setEnabled(0 != m_pcModel->log(cIndex));
+}
+
+
+//*****************************************************************************
+/*!
+  The selected logs have changed; enable the buttons acting on them if
+  any are selected.
+*/
+//*****************************************************************************
+
+void
+LogListView::selectionChanged()
+{
+  const bool isSelected =
+    m_pcDiveListView->selectionModel()->hasSelection();
+  m_pcDeleteLog->setEnabled(isSelected);
+  m_pcEditLogs->setEnabled(isSelected && 0 != m_pcHistory);
+  m_pcExportLogs->setEnabled(isSelected);
+}
+
+
+//*****************************************************************************
+/*!
+  Get the selected logs, in list order.
+*/
+//*****************************************************************************
+
+QVector<DiveLog*>
+LogListView::selectedLogs() const
+{
+  QVector<DiveLog*> apcLogs;
+  if ( 0 == m_pcDiveLogList )
+    return apcLogs;
+  const QModelIndexList cRows =
+    m_pcDiveListView->selectionModel()->selectedRows();
+  apcLogs.reserve(cRows.count());
+  for ( int iRow = 0; iRow < cRows.count(); ++iRow ) {
+    DiveLog* pcLog = m_pcModel->log(cRows.at(iRow));
+    if ( pcLog )
+      apcLogs.append(pcLog);
+  }
+  std::sort(apcLogs.begin(), apcLogs.end(), ListIndexLess(*m_pcDiveLogList));
+  return apcLogs;
+}
+
+
+//*****************************************************************************
+/*!
+  The model is about to be reset; remember the current log.
+*/
+//*****************************************************************************
+
+void
+LogListView::rememberCurrentLog()
+{
+  m_pcResetLog = m_pcModel->log(m_pcDiveListView->currentIndex());
+}
+
+
+//*****************************************************************************
+/*!
+  The model has been reset; make the log that was current before the
+  reset current again, if it is still in the list and shown.
+
+  If the log was deleted, removingLog() has forgotten it, so the log is
+  only looked up, not searched for.
+*/
+//*****************************************************************************
+
+void
+LogListView::restoreCurrentLog()
+{
+  DiveLog* pcLog = m_pcResetLog;
+  m_pcResetLog = 0;
+  const QModelIndex cIndex = m_pcModel->indexOf(pcLog);
+  if ( cIndex.isValid() ) {
+    m_pcDiveListView->setCurrentIndex(cIndex);
+    m_pcDiveListView->scrollTo(cIndex);
+    return;
+  }
+  selectedLogChanged(QModelIndex());
+  selectionChanged();
+}
+
+
+//*****************************************************************************
+/*!
+  The log \a pcLog is about to be removed from the list. Forget it if it
+  was current when the model was reset.
+*/
+//*****************************************************************************
+
+void
+LogListView::removingLog(DiveLog* pcLog)
+{
+  if ( pcLog == m_pcResetLog )
+    m_pcResetLog = 0;
 }
 
 
@@ -15,12 +15,18 @@
 #define LOGLISTVIEW_H
 
 #include <qwidget.h>
+#include <qvector.h>
+#include "diveselection.h"
 
-class QTableWidget;
-class QTableWidgetItem;
+class QTableView;
+class QModelIndex;
+class QLineEdit;
 class QPushButton;
+class QUndoStack;
 class DiveList;
 class DiveLog;
+class DiveListModel;
+class ChangeTracker;
 
 
 //*****************************************************************************
@@ -28,14 +34,26 @@ class DiveLog;
   \class LogListView
   \brief The LogListView class is used to display all the dive logs.
 
-  A table widget is used to view the logs. This widget is the main part of the
-  view. Four parts of a dive log is shown in the view:
+  A table view is used to view the logs. This widget is the main part of the
+  view. The table is a DiveListModel, which reads the cells from the logs
+  as they are shown, so a big log book is shown as fast as a small one.
+  Seven parts of a dive log is shown in the view:
   \arg Dive number
   \arg Dive date
   \arg Dive start time
-  \arg Location.
+  \arg Location
+  \arg Maximum depth
+  \arg Buddy
+  \arg Dive type.
 
-  The log list can be sorted on any of these parts.
+  The log list can be sorted on any of these parts by clicking the column
+  headers, and filtered on text in any of them with the filter box.
+  The current log is kept current when the rows are sorted or filtered,
+  as long as it is still shown.
+
+  Several logs can be selected. The selected logs can be deleted together,
+  with one question and one update of the view, have the location, buddy,
+  dive type or gas type set in one undoable edit, or be exported.
 
   \author André Hübert Johansen
 */
@@ -47,36 +65,61 @@ public:
   LogListView(QWidget* pcParent);
   virtual ~LogListView();
 
-  void setLogList(DiveList* pcDiveList);
+  void setLogList(DiveList* pcDiveList, QUndoStack* pcHistory);
 
 public slots:
   void createNewLog();
   void deleteLog();
+  void editLogs();
+  void exportLogs();
   void viewLog();
-  void viewLog(int row, int col);
-  void selectedLogChanged(int row, int col);
+  void viewLog(const QModelIndex& cIndex);
+  void selectedLogChanged(const QModelIndex& cIndex);
 
-private:
-  void insertLogAt(int row, const DiveLog* item);
-  DiveLog* getDiveLogNumber(int number);
+private slots:
+  void selectionChanged();
+  void rememberCurrentLog();
+  void restoreCurrentLog();
+  void removingLog(DiveLog* pcLog);
 
 private:
+  QVector<DiveLog*> selectedLogs() const;
+
   //! The dive list widget.
-  QTableWidget* m_pcDiveListWidget;
+  QTableView*    m_pcDiveListView;
+  //! The model of the dive list.
+  DiveListModel* m_pcModel;
+  //! The filter text box.
+  QLineEdit*    m_pcFilter;
   //! The button used to create a new log.
   QPushButton*  m_pcNewLog;
   //! The button used to delete a log.
   QPushButton*  m_pcDeleteLog;
+  //! The button used to edit the selected logs.
+  QPushButton*  m_pcEditLogs;
+  //! The button used to export the selected logs.
+  QPushButton*  m_pcExportLogs;
   //! The button used to view a selected log.
   QPushButton*  m_pcViewLog;
   //! The current dive log list.
   DiveList*     m_pcDiveLogList;
+  //! The undo history the edits are pushed on, or 0.
+  QUndoStack*   m_pcHistory;
+  //! The change tracker of the dive log list, or 0.
+  ChangeTracker* m_pcTracker;
+  //! The log that was current when the model was reset, or 0.
+  DiveLog*      m_pcResetLog;
 
 signals:
   //! This signal is emitted when the log \a pcLog should be displayed.
   void displayLog(DiveLog* pcLog);
-  //! This signal is emitted just before the log \a pcLog will be deleted.
-  void aboutToDeleteLog(const DiveLog* pcLog);
+  //! This signal is emitted just before the logs \a apcLogs will be deleted.
+  void aboutToDeleteLogs(const QVector<DiveLog*>& apcLogs);
+  //! This signal is emitted just before the selected logs are edited.
+  void aboutToEditLogs();
+  //! This signal is emitted when the logs in \a cSelection should be
+  //! exported.
+  void exportSelection(const DiveSelection& cSelection);
 };
 
 
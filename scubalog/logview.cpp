@@ -12,9 +12,10 @@
 //*****************************************************************************
 
 #include "logview.h"
+#include "completionmodel.h"
 #include "logbook.h"
 #include "divelist.h"
-#include "logbook.h"
+#include "edithistory.h"
 #include "ktimeedit.h"
 #include "kdateedit.h"
 #include "kintegeredit.h"
@@ -26,9 +27,13 @@
 #include <qtextedit.h>
 #include <qtextdocument.h>
 #include <qcombobox.h>
+#include <qcompleter.h>
 #include <qlayout.h>
 #include <qpushbutton.h>
 #include <qlabel.h>
+#include <qtimer.h>
+#include <qevent.h>
+#include <qset.h>
 #include <QHBoxLayout>
 #include <QGridLayout>
 #include <QVBoxLayout>
@@ -39,6 +44,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+
+/**
+ * The time in milliseconds typing must pause before the text fields
+ * are written to the log.
+ */
+
+static const int s_nCommitDelay = 400;
+
+
 //*****************************************************************************
 /*!
   Initialise the log view with \a pcParent as the parent widget
@@ -50,6 +64,14 @@ LogView::LogView(QWidget* pcParent)
   : QWidget(pcParent),
     m_pcLogBook(0),
     m_pcCurrentLog(0),
+    m_isEditing(false),
+    m_isLoading(false),
+    m_pcCommitTimer(0),
+    m_nPendingFields(0),
+    m_pcGasTypes(0),
+    m_pcLocations(0),
+    m_pcBuddies(0),
+    m_pcDiveTypes(0),
     m_pcDiveNumber(0),
     m_pcDiveDate(0),
     m_pcDiveStart(0),
@@ -68,6 +90,16 @@ LogView::LogView(QWidget* pcParent)
     m_pcPreviousLog(0),
     m_pcNextLog(0)
 {
+  m_pcCommitTimer = new QTimer(this);
+  m_pcCommitTimer->setSingleShot(true);
+  m_pcCommitTimer->setInterval(s_nCommitDelay);
+  connect(m_pcCommitTimer, SIGNAL(timeout()), SLOT(commitEdits()));
+
+  m_pcGasTypes = new CompletionModel(DiveLogEdit::e_GasType, this);
+  m_pcLocations = new CompletionModel(DiveLogEdit::e_DiveLocation, this);
+  m_pcBuddies = new CompletionModel(DiveLogEdit::e_BuddyName, this);
+  m_pcDiveTypes = new CompletionModel(DiveLogEdit::e_DiveType, this);
+
   QLabel* pcDiveNumLabel = new QLabel(this);
   pcDiveNumLabel->setText(i18n("Dive &number:"));
   pcDiveNumLabel->setMinimumSize(pcDiveNumLabel->sizeHint());
@@ -116,8 +148,10 @@ LogView::LogView(QWidget* pcParent)
   m_pcGasType = new QLineEdit(this);
   m_pcGasType->setMinimumSize(m_pcGasType->sizeHint());
   pcGasLabel->setBuddy(m_pcGasType);
+  m_pcGasType->installEventFilter(this);
+  m_pcGasType->setCompleter(createCompleter(m_pcGasTypes, m_pcGasType));
   connect(m_pcGasType, SIGNAL(textChanged(const QString&)),
-          SLOT(gasTypeChanged(const QString&)));
+          SLOT(gasTypeChanged()));
 
   QLabel* pcAirTempLabel = new QLabel(this);
   pcAirTempLabel->setText(i18n("&Air temperature:"));
@@ -156,8 +190,9 @@ LogView::LogView(QWidget* pcParent)
   m_pcMaxDepth = new QLineEdit(this);
   m_pcMaxDepth->setMinimumSize(m_pcMaxDepth->sizeHint());
   pcMaxDepthLabel->setBuddy(m_pcMaxDepth);
+  m_pcMaxDepth->installEventFilter(this);
   connect(m_pcMaxDepth, SIGNAL(textChanged(const QString&)),
-          SLOT(maxDepthChanged(const QString&)));
+          SLOT(maxDepthChanged()));
 
   QLabel* pcBuddyLabel = new QLabel(this);
   pcBuddyLabel->setText(i18n("B&uddy:"));
@@ -166,8 +201,10 @@ LogView::LogView(QWidget* pcParent)
   m_pcBuddy = new QLineEdit(this);
   m_pcBuddy->setMinimumSize(m_pcBuddy->sizeHint());
   pcBuddyLabel->setBuddy(m_pcBuddy);
+  m_pcBuddy->installEventFilter(this);
+  m_pcBuddy->setCompleter(createCompleter(m_pcBuddies, m_pcBuddy));
   connect(m_pcBuddy, SIGNAL(textChanged(const QString&)),
-          SLOT(buddyChanged(const QString&)));
+          SLOT(buddyChanged()));
 
   QLabel* pcDiveTypeLabel = new QLabel(this);
   pcDiveTypeLabel->setText(i18n("Dive t&ype:"));
@@ -188,6 +225,11 @@ LogView::LogView(QWidget* pcParent)
   m_pcDiveTypeSelector->setMinimumSize(m_pcDiveTypeSelector->sizeHint());
   connect(m_pcDiveTypeSelector, SIGNAL(activated(const QString&)),
           SLOT(diveTypeChanged(const QString&)));
+  QCompleter* pcDiveTypeCompleter =
+    createCompleter(m_pcDiveTypes, m_pcDiveTypeSelector->lineEdit());
+  m_pcDiveTypeSelector->setCompleter(pcDiveTypeCompleter);
+  connect(pcDiveTypeCompleter, SIGNAL(activated(const QString&)),
+          SLOT(diveTypeChanged(const QString&)));
   pcDiveTypeLabel->setBuddy(m_pcDiveTypeSelector);
 
   QLabel* pcWaterTempLabel = new QLabel(this);
@@ -203,8 +245,10 @@ LogView::LogView(QWidget* pcParent)
   m_pcLocation = new QLineEdit(pcLocationLine);
   m_pcLocation->setMinimumSize(m_pcLocation->sizeHint());
   pcLocationLabel->setBuddy(m_pcLocation);
+  m_pcLocation->installEventFilter(this);
+  m_pcLocation->setCompleter(createCompleter(m_pcLocations, m_pcLocation));
   connect(m_pcLocation, SIGNAL(textChanged(const QString&)),
-          SLOT(locationChanged(const QString&)));
+          SLOT(locationChanged()));
 
   m_pcEditLocation = new QPushButton(pcLocationLine);
   m_pcEditLocation->setText(i18n("Edit"));
@@ -223,6 +267,7 @@ LogView::LogView(QWidget* pcParent)
   pcDescriptionLabel->setMinimumSize(pcDescriptionLabel->sizeHint());
 
   m_pcDescription = new QTextEdit(this);
+  m_pcDescription->installEventFilter(this);
   connect(m_pcDescription,  SIGNAL(textChanged()),
           SLOT(diveDescriptionChanged()));
   pcDescriptionLabel->setBuddy(m_pcDescription);
@@ -322,7 +367,17 @@ LogView::~LogView()
 void
 LogView::setLogBook(LogBook* pcLogBook)
 {
+  commitEdits();
+  if ( m_pcLogBook )
+    disconnect(&m_pcLogBook->editHistory(), 0, this, 0);
   m_pcLogBook = pcLogBook;
+  m_pcGasTypes->setLogBook(pcLogBook);
+  m_pcLocations->setLogBook(pcLogBook);
+  m_pcBuddies->setLogBook(pcLogBook);
+  m_pcDiveTypes->setLogBook(pcLogBook);
+  if ( m_pcLogBook )
+    connect(&m_pcLogBook->editHistory(), SIGNAL(indexChanged(int)),
+            SLOT(historyChanged()));
   viewLog(0);
 }
 
@@ -342,10 +397,8 @@ LogView::newLog()
 
   try {
     DiveList& cDiveList = m_pcLogBook->diveList();
-    DiveLog* pcLog = new DiveLog();
-    DiveLog* pcLast = cDiveList.last();
-    int nNumber = ( pcLast ? pcLast->logNumber() + 1 : 1 );
-    pcLog->setLogNumber(nNumber);
+    DiveLog* pcLog = cDiveList.newLog();
+    pcLog->setLogNumber(cDiveList.nextLogNumber());
     cDiveList.append(pcLog);
     viewLog(pcLog);
     emit newLog(pcLog);
@@ -362,6 +415,10 @@ LogView::newLog()
 /*!
   Show the log \a pcLog. If a null-pointer is passed, the view is cleared.
 
+  Any text typed in the log shown before is written to it first. While
+  the widgets are filled in, the changes they report are not edits, and
+  are ignored by editField() and textEdited().
+
   Notice that this function will not make the view visible if it is not,
   that should be done after this function is called.
 */
@@ -370,7 +427,9 @@ LogView::newLog()
 void
 LogView::viewLog(DiveLog* pcLog)
 {
+  commitEdits();
   m_pcCurrentLog = pcLog;
+  m_isLoading = true;
 
   if ( pcLog ) {
     const QString cDepth = QString::asprintf("%.2f", pcLog->maxDepth());
@@ -416,18 +475,9 @@ LogView::viewLog(DiveLog* pcLog)
     bool isPreviousAvailable = false;
     bool isNextAvailable = false;
     if ( m_pcLogBook ) {
-      DiveList& cDiveList = m_pcLogBook->diveList();
-      QListIterator<DiveLog*> iLog(cDiveList);
-      while ( iLog.hasNext() ) {
-        DiveLog* pcCurrent = iLog.next();
-        if ( pcCurrent == m_pcCurrentLog ) {
-          if ( iLog.hasPrevious() )
-            isPreviousAvailable = true;
-          if ( iLog.hasNext() )
-            isNextAvailable = true;
-          break;
-        }
-      }
+      const DiveList& cDiveList = m_pcLogBook->diveList();
+      isPreviousAvailable = ( 0 != cDiveList.previousLog(m_pcCurrentLog) );
+      isNextAvailable = ( 0 != cDiveList.nextLog(m_pcCurrentLog) );
     }
     m_pcPreviousLog->setEnabled(isPreviousAvailable);
     m_pcNextLog->setEnabled(isNextAvailable);
@@ -467,6 +517,11 @@ LogView::viewLog(DiveLog* pcLog)
     m_pcPreviousLog->setEnabled(false);
     m_pcNextLog->setEnabled(false);
   }
+
+  // The text fields now hold what is in the log
+  m_pcCommitTimer->stop();
+  m_nPendingFields = 0;
+  m_isLoading = false;
 }
 
 
@@ -480,7 +535,7 @@ void
 LogView::diveNumberChanged(int nNumber)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setLogNumber(nNumber);
+    editField(DiveLogEdit::e_LogNumber, nNumber);
 }
 
 
@@ -494,7 +549,7 @@ void
 LogView::diveDateChanged(QDate cDate)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setDiveDate(cDate);
+    editField(DiveLogEdit::e_DiveDate, cDate);
 }
 
 
@@ -508,7 +563,7 @@ void
 LogView::diveStartChanged(QTime cStart)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setDiveStart(cStart);
+    editField(DiveLogEdit::e_DiveStart, cStart);
 }
 
 
@@ -522,21 +577,20 @@ void
 LogView::diveTimeChanged(QTime cTime)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setDiveTime(cTime);
+    editField(DiveLogEdit::e_DiveTime, cTime);
 }
 
 
 //*****************************************************************************
 /*!
-  The gas type changed to \a cGasType. Update the log.
+  The gas type has been edited.
 */
 //*****************************************************************************
 
 void
-LogView::gasTypeChanged(const QString& cGasType)
+LogView::gasTypeChanged()
 {
-  if ( m_pcCurrentLog )
-    m_pcCurrentLog->setGasType(cGasType);
+  textEdited(DiveLogEdit::e_GasType);
 }
 
 
@@ -550,7 +604,7 @@ void
 LogView::bottomTimeChanged(QTime cTime)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setBottomTime(cTime);
+    editField(DiveLogEdit::e_BottomTime, cTime);
 }
 
 
@@ -564,7 +618,7 @@ void
 LogView::airTemperatureChanged(int nTemp)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setAirTemperature((float)nTemp);
+    editField(DiveLogEdit::e_AirTemperature, (float)nTemp);
 }
 
 
@@ -578,50 +632,46 @@ void
 LogView::waterTemperatureChanged(int nTemp)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setWaterTemperature((float)nTemp);
+    editField(DiveLogEdit::e_WaterTemperature, (float)nTemp);
 }
 
 
 //*****************************************************************************
 /*!
-  The location changed to \a cLocation. Update the log.
+  The location has been edited.
 */
 //*****************************************************************************
 
 void
-LogView::locationChanged(const QString& cLocation)
+LogView::locationChanged()
 {
-  if ( m_pcCurrentLog )
-    m_pcCurrentLog->setDiveLocation(cLocation);
+  textEdited(DiveLogEdit::e_DiveLocation);
 }
 
 
 //*****************************************************************************
 /*!
-  The maximum depth changed to \a cDepth. Update the log.
+  The maximum depth has been edited.
 */
 //*****************************************************************************
 
 void
-LogView::maxDepthChanged(const QString& cDepth)
+LogView::maxDepthChanged()
 {
-  float vDepth = (float)atof(cDepth.toUtf8().constData());
-  if ( m_pcCurrentLog )
-    m_pcCurrentLog->setMaxDepth(vDepth);
+  textEdited(DiveLogEdit::e_MaxDepth);
 }
 
 
 //*****************************************************************************
 /*!
-  The buddy changed to \a cBuddy. Update the log.
+  The buddy has been edited.
 */
 //*****************************************************************************
 
 void
-LogView::buddyChanged(const QString& cBuddy)
+LogView::buddyChanged()
 {
-  if ( m_pcCurrentLog )
-    m_pcCurrentLog->setBuddyName(cBuddy);
+  textEdited(DiveLogEdit::e_BuddyName);
 }
 
 
@@ -635,26 +685,207 @@ void
 LogView::diveTypeChanged(const QString& cDiveType)
 {
   if ( m_pcCurrentLog )
-    m_pcCurrentLog->setDiveType(cDiveType);
+    editField(DiveLogEdit::e_DiveType, cDiveType);
 }
 
 
 //*****************************************************************************
 /*!
-  The dive description changed. Update the log.
+  The dive description has been edited. The text isn't read until it is
+  written to the log, as that takes time in proportion to its length.
 */
 //*****************************************************************************
 
 void
 LogView::diveDescriptionChanged()
 {
-  if ( m_pcCurrentLog ) {
-    QString cDescription(m_pcDescription->document()->toPlainText());
-    m_pcCurrentLog->setDiveDescription(cDescription);
+  textEdited(DiveLogEdit::e_DiveDescription);
+}
+
+
+//*****************************************************************************
+/*!
+  Set the field \a eField of the current log to \a cValue through
+  the edit history, so the change can be undone.
+
+  Nothing is done while viewLog() fills in the widgets, as some widgets
+  round the value they are given, like the temperatures to whole degrees,
+  and the rounded value must not be written back to the log. Nothing is
+  recorded either if the log already has the value. Text typed but not
+  yet written to the log is written first, so the edits are undone in
+  the order they were made.
+*/
+//*****************************************************************************
+
+void
+LogView::editField(DiveLogEdit::Field_e eField, const QVariant& cValue)
+{
+  if ( m_isLoading )
+    return;
+  assert(m_pcLogBook && m_pcCurrentLog);
+
+  commitEdits();
+  DiveLogEdit* pcEdit = new DiveLogEdit(m_pcCurrentLog, eField, cValue);
+  if ( 0 == pcEdit->numChanges() ) {
+    delete pcEdit;
+    return;
+  }
+  m_isEditing = true;
+  m_pcLogBook->editHistory().push(pcEdit);
+  m_isEditing = false;
+}
+
+
+//*****************************************************************************
+/*!
+  The text field \a eField has been edited. Remember it, and write it to
+  the log when typing pauses.
+
+  Each key typed just restarts the timer, so typing in a long description
+  doesn't copy the text for every key. Text set by viewLog() is ignored.
+*/
+//*****************************************************************************
+
+void
+LogView::textEdited(DiveLogEdit::Field_e eField)
+{
+  if ( m_isLoading || 0 == m_pcCurrentLog )
+    return;
+  m_nPendingFields |= 1 << eField;
+  m_pcCommitTimer->start();
+}
+
+
+//*****************************************************************************
+/*!
+  Write the text fields edited since the last time to the current log,
+  as one edit in the edit history.
+
+  This is done when typing pauses, when a text field loses focus, before
+  another log is shown, and before an edit of another field. Call it
+  before the log book is read or its history is used, so no typing is
+  left out.
+*/
+//*****************************************************************************
+
+void
+LogView::commitEdits()
+{
+  m_pcCommitTimer->stop();
+  const int nFields = m_nPendingFields;
+  m_nPendingFields = 0;
+  if ( 0 == nFields || 0 == m_pcCurrentLog || 0 == m_pcLogBook )
+    return;
+
+  DiveLogEdit* pcEdit = 0;
+  int nNumFields = 0;
+  for ( int iField = 0; iField <= DiveLogEdit::e_DiveDescription; ++iField ) {
+    if ( nFields & (1 << iField) )
+      ++nNumFields;
+  }
+  for ( int iField = 0; iField <= DiveLogEdit::e_DiveDescription; ++iField ) {
+    if ( 0 == (nFields & (1 << iField)) )
+      continue;
+    const DiveLogEdit::Field_e eField = DiveLogEdit::Field_e(iField);
+    // A single field gets the edit that merges with the next of its kind
+    if ( 1 == nNumFields ) {
+      pcEdit = new DiveLogEdit(m_pcCurrentLog, eField, textValue(eField));
+    }
+    else {
+      if ( 0 == pcEdit )
+        pcEdit = new DiveLogEdit(i18n("Edit dive log"));
+      pcEdit->addChange(m_pcCurrentLog, eField, textValue(eField));
+    }
+  }
+  if ( 0 == pcEdit->numChanges() ) {
+    delete pcEdit;
+    return;
+  }
+  m_isEditing = true;
+  m_pcLogBook->editHistory().push(pcEdit);
+  m_isEditing = false;
+}
+
+
+//*****************************************************************************
+/*!
+  Get the value of the text field \a eField as typed.
+*/
+//*****************************************************************************
+
+QVariant
+LogView::textValue(DiveLogEdit::Field_e eField) const
+{
+  switch ( eField ) {
+  case DiveLogEdit::e_GasType:
+    return m_pcGasType->text();
+  case DiveLogEdit::e_DiveLocation:
+    return m_pcLocation->text();
+  case DiveLogEdit::e_MaxDepth:
+    return (float)atof(m_pcMaxDepth->text().toUtf8().constData());
+  case DiveLogEdit::e_BuddyName:
+    return m_pcBuddy->text();
+  case DiveLogEdit::e_DiveDescription:
+    return m_pcDescription->document()->toPlainText();
+  default:
+    assert(false);
+    return QVariant();
   }
 }
 
 
+//*****************************************************************************
+/*!
+  Create a completer for the editor \a pcEdit showing the completions of
+  \a pcModel. The model is given the text as it is typed, and the popup
+  shows the values it ranks best, without filtering them again.
+*/
+//*****************************************************************************
+
+QCompleter*
+LogView::createCompleter(CompletionModel* pcModel, QLineEdit* pcEdit)
+{
+  QCompleter* pcCompleter = new QCompleter(pcModel, pcEdit);
+  pcCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  connect(pcEdit, SIGNAL(textEdited(const QString&)),
+          pcModel, SLOT(setPrefix(const QString&)));
+  return pcCompleter;
+}
+
+
+//*****************************************************************************
+/*!
+  Write the edited text to the log when one of the text fields being
+  watched as \a pcObject loses focus, for \a pcEvent. This includes
+  opening a menu, so a menu command sees the log as typed.
+*/
+//*****************************************************************************
+
+bool
+LogView::eventFilter(QObject* pcObject, QEvent* pcEvent)
+{
+  if ( QEvent::FocusOut == pcEvent->type() )
+    commitEdits();
+  return QWidget::eventFilter(pcObject, pcEvent);
+}
+
+
+//*****************************************************************************
+/*!
+  The edit history has been undone or redone, or an edit has been added.
+  Unless the edit was made here, show the current log again, as it may
+  have changed.
+*/
+//*****************************************************************************
+
+void
+LogView::historyChanged()
+{
+  if ( false == m_isEditing && m_pcCurrentLog )
+    viewLog(m_pcCurrentLog);
+}
+
+
 //*****************************************************************************
 /*!
   Goto the previous log in the log book.
@@ -666,16 +897,7 @@ LogView::gotoPreviousLog()
 {
   assert(m_pcLogBook);
 
-  DiveLog* pcPrevious = 0;
-  const DiveList& cDiveList = m_pcLogBook->diveList();
-  QListIterator<DiveLog*> iLog(cDiveList);
-  while ( iLog.hasNext() ) {
-    DiveLog* pcCurrent = iLog.next();
-    if ( pcCurrent == m_pcCurrentLog )
-      break;
-    pcPrevious = pcCurrent;
-  }
-
+  DiveLog* pcPrevious = m_pcLogBook->diveList().previousLog(m_pcCurrentLog);
   if ( pcPrevious )
     viewLog(pcPrevious);
 }
@@ -692,19 +914,7 @@ LogView::gotoNextLog()
 {
   assert(m_pcLogBook);
 
-  DiveLog* pcNext = 0;
-  const DiveList& cDiveList = m_pcLogBook->diveList();
-  QListIterator<DiveLog*> iLog(cDiveList);
-  while ( iLog.hasNext() ) {
-    DiveLog* pcCurrent = iLog.next();
-    if ( pcCurrent == m_pcCurrentLog ) {
-      if ( iLog.hasNext() ) {
-        pcNext = iLog.next();
-      }
-      break;
-    }
-  }
-
+  DiveLog* pcNext = m_pcLogBook->diveList().nextLog(m_pcCurrentLog);
   if ( pcNext )
     viewLog(pcNext);
 }
@@ -712,32 +922,38 @@ LogView::gotoNextLog()
 
 //*****************************************************************************
 /*!
-  The log \a pcLog is about to be deleted, make sure it is not used anymore.
+  The logs \a apcLogs are about to be deleted, make sure they are not used
+  anymore. If the current log is one of them, the first log after it that
+  is kept is shown, or if there is none, the last one before it.
 */
 //*****************************************************************************
 
 void
-LogView::deletingLog(const DiveLog* pcLog)
+LogView::deletingLogs(const QVector<DiveLog*>& apcLogs)
 {
-  if ( m_pcCurrentLog && pcLog == m_pcCurrentLog ) {
-    DiveLog* pcNewLog = 0;
-    if ( m_pcLogBook ) {
-      const DiveList& cDiveList = m_pcLogBook->diveList();
-      QListIterator<DiveLog*> iLog(cDiveList);
-      while ( iLog.hasNext() ) {
-        DiveLog* pcCurrentLog = iLog.next();
-        if ( pcCurrentLog == pcLog ) {
-          if ( iLog.hasNext() )
-            pcNewLog = iLog.next();
-          else if ( iLog.hasPrevious() ) {
-            pcNewLog = iLog.previous();
-          }
-          break;
-        }
-      }
+  if ( 0 == m_pcCurrentLog || false == apcLogs.contains(m_pcCurrentLog) )
+    return;
+
+  // Text typed in the log going away is not written to it
+  m_pcCommitTimer->stop();
+  m_nPendingFields = 0;
+  DiveLog* pcNewLog = 0;
+  if ( m_pcLogBook ) {
+    QSet<const DiveLog*> cDeleted;
+    cDeleted.reserve(apcLogs.count());
+    for ( int iLog = 0; iLog < apcLogs.count(); ++iLog )
+      cDeleted.insert(apcLogs.at(iLog));
+    const DiveList& cDiveList = m_pcLogBook->diveList();
+    pcNewLog = cDiveList.nextLog(m_pcCurrentLog);
+    while ( pcNewLog && cDeleted.contains(pcNewLog) )
+      pcNewLog = cDiveList.nextLog(pcNewLog);
+    if ( 0 == pcNewLog ) {
+      pcNewLog = cDiveList.previousLog(m_pcCurrentLog);
+      while ( pcNewLog && cDeleted.contains(pcNewLog) )
+        pcNewLog = cDiveList.previousLog(pcNewLog);
     }
-    viewLog(pcNewLog);
   }
+  viewLog(pcNewLog);
 }
 
 
@@ -16,13 +16,18 @@
 
 #include <qwidget.h>
 #include <qdatetime.h>
+#include <qvector.h>
+#include "divelogedit.h"
 
 class DiveLog;
 class LogBook;
+class CompletionModel;
 class QComboBox;
+class QCompleter;
 class QLineEdit;
 class QTextEdit;
 class QPushButton;
+class QTimer;
 class KIntegerEdit;
 class KDateEdit;
 class KTimeEdit;
@@ -35,6 +40,16 @@ class KTimeEdit;
 
   This class is the one viewed when editing a log.
 
+  Fields set by picking a value, like the date, are written to the log
+  as soon as they change. The text fields are written when typing pauses,
+  or when the field loses focus, with all the fields typed in since the
+  last write as one edit; see commitEdits(). Until then the log, and the
+  views of the log book, still have the text from before.
+
+  The gas type, location, buddy and dive type fields complete what is
+  typed from the values already in the log book, most used first; see
+  CompletionModel.
+
   \author André Johansen
 */
 //*****************************************************************************
@@ -50,31 +65,57 @@ public:
 public slots:
   void viewLog(DiveLog* pcLog);
   void newLog();
-  void deletingLog(const DiveLog* pcLog);
+  void deletingLogs(const QVector<DiveLog*>& apcLogs);
+  void commitEdits();
 
 private slots:
   void diveNumberChanged(int nNumber);
   void diveDateChanged(QDate cDate);
   void diveStartChanged(QTime cStart);
   void diveTimeChanged(QTime cTime);
-  void gasTypeChanged(const QString& cGasType);
+  void gasTypeChanged();
   void bottomTimeChanged(QTime cTime);
   void airTemperatureChanged(int nTemperature);
   void waterTemperatureChanged(int nTemperature);
-  void locationChanged(const QString& cLocation);
-  void maxDepthChanged(const QString& cDepth);
-  void buddyChanged(const QString& cDepth);
+  void locationChanged();
+  void maxDepthChanged();
+  void buddyChanged();
   void diveTypeChanged(const QString& cDiveType);
   void diveDescriptionChanged();
   void gotoPreviousLog();
   void gotoNextLog();
   void editLocation();
+  void historyChanged();
+
+protected:
+  virtual bool eventFilter(QObject* pcObject, QEvent* pcEvent);
 
 private:
+  void editField(DiveLogEdit::Field_e eField, const QVariant& cValue);
+  void textEdited(DiveLogEdit::Field_e eField);
+  QVariant textValue(DiveLogEdit::Field_e eField) const;
+  QCompleter* createCompleter(CompletionModel* pcModel, QLineEdit* pcEdit);
+
   //! The current log book.
   LogBook*      m_pcLogBook;
   //! The current dive log.
   DiveLog*      m_pcCurrentLog;
+  //! Set while an edit made in this view is pushed to the history.
+  bool          m_isEditing;
+  //! Set while viewLog() fills in the widgets.
+  bool          m_isLoading;
+  //! Started when a text field is edited, to write it when typing pauses.
+  QTimer*       m_pcCommitTimer;
+  //! The text fields edited but not yet written, one bit per field.
+  int           m_nPendingFields;
+  //! The completions of the gas type.
+  CompletionModel* m_pcGasTypes;
+  //! The completions of the location.
+  CompletionModel* m_pcLocations;
+  //! The completions of the buddy.
+  CompletionModel* m_pcBuddies;
+  //! The completions of the dive type.
+  CompletionModel* m_pcDiveTypes;
 
   //! The current dive number.
   KIntegerEdit* m_pcDiveNumber;
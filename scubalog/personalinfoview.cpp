@@ -14,11 +14,13 @@
 #include "personalinfoview.h"
 #include "logbook.h"
 #include "divelist.h"
+#include "changetracker.h"
 #include <KLocalizedString>
 #include <qlayout.h>
 #include <QTextEdit>
 #include <qlineedit.h>
 #include <qlabel.h>
+#include <qevent.h>
 #include <QGridLayout>
 #include <QVBoxLayout>
 
@@ -35,8 +37,10 @@ PersonalInfoView::PersonalInfoView(QWidget* pcParent)
     m_pcEmailAddress(0),
     m_pcWwwUrl(0),
     m_pcLoggedDiveTime(0),
+    m_pcStatistics(0),
     m_pcComments(0),
-    m_pcLogBook(0)
+    m_pcLogBook(0),
+    m_pcTracker(0)
 {
   //
   // Create GUI elements
@@ -76,6 +80,8 @@ PersonalInfoView::PersonalInfoView(QWidget* pcParent)
   m_pcLoggedDiveTime->setText(i18n("Total logged dive time: 000h 00min"));
   m_pcLoggedDiveTime->setMinimumSize(m_pcLoggedDiveTime->sizeHint());
 
+  m_pcStatistics = new QLabel(this);
+
   QLabel* pcCommentsLabel = new QLabel(this);
   pcCommentsLabel->setText(i18n("&Comments:"));
   pcCommentsLabel->setMinimumSize(pcCommentsLabel->sizeHint());
@@ -104,6 +110,7 @@ PersonalInfoView::PersonalInfoView(QWidget* pcParent)
   pcUpperLayout->addWidget(pcWwwUrlLabel,     1, 2);
   pcUpperLayout->addWidget(m_pcWwwUrl,        1, 3);
   pcUpperLayout->addWidget(m_pcLoggedDiveTime, 2, 0, 1, 2);
+  pcUpperLayout->addWidget(m_pcStatistics,     2, 2, 1, 2);
   pcDVTopLayout->addWidget(pcCommentsLabel);
   pcDVTopLayout->addWidget(m_pcComments, 10);
   pcDVTopLayout->activate();
@@ -123,15 +130,21 @@ PersonalInfoView::~PersonalInfoView()
 
 //*****************************************************************************
 /*!
-  Set the log book to \a pcLogBook. The view will be updated.
-  If a null-pointer is passed, the view will be cleared.
+  Set the log book to \a pcLogBook. The view will be updated, though the
+  dive totals are left until it is shown. If a null-pointer is passed,
+  the view will be cleared.
 */
 //*****************************************************************************
 
 void
 PersonalInfoView::setLogBook(LogBook* pcLogBook)
 {
+  if ( m_pcTracker )
+    disconnect(m_pcTracker, 0, this, 0);
   m_pcLogBook = pcLogBook;
+  m_pcTracker = pcLogBook ? &pcLogBook->changeTracker() : 0;
+  if ( m_pcTracker )
+    connect(m_pcTracker, SIGNAL(changed()), SLOT(logBookChanged()));
 
   if ( pcLogBook ) {
     m_pcName->setText(pcLogBook->diverName());
@@ -140,7 +153,8 @@ PersonalInfoView::setLogBook(LogBook* pcLogBook)
     m_pcEmailAddress->setEnabled(true);
     m_pcWwwUrl->setText(pcLogBook->wwwUrl());
     m_pcWwwUrl->setEnabled(true);
-    updateLoggedDiveTime();
+    if ( isVisible() )
+      updateLoggedDiveTime();
     m_pcComments->setText(pcLogBook->comments());
     m_pcComments->setEnabled(true);
   }
@@ -157,6 +171,21 @@ PersonalInfoView::setLogBook(LogBook* pcLogBook)
 }
 
 
+//*****************************************************************************
+/*!
+  The view is about to be shown. Update the dive totals, as they aren't
+  updated while the view is hidden.
+*/
+//*****************************************************************************
+
+void
+PersonalInfoView::showEvent(QShowEvent* pcEvent)
+{
+  updateLoggedDiveTime();
+  QWidget::showEvent(pcEvent);
+}
+
+
 //*****************************************************************************
 /*!
   The diver name was changed to \a cName.
@@ -204,10 +233,11 @@ PersonalInfoView::wwwUrlChanged(const QString& cWwwUrl)
 
 //*****************************************************************************
 /*!
-  Update the logged dive time.
+  Update the logged dive time, and the number of dives, the deepest dive
+  and the gas used.
 
-  This is done by going through all the logged dives in the current logbook,
-  summing the dive time.
+  The totals are kept by the dive list as the logs change, so this takes
+  the same time whatever the size of the log book.
 */
 //*****************************************************************************
 
@@ -215,20 +245,39 @@ void
 PersonalInfoView::updateLoggedDiveTime()
 {
   QString cLoggedTimeText(i18n("0h 0min"));
+  QString cStatisticsText;
   if ( m_pcLogBook ) {
-    unsigned int nNumMins = 0;
-    DiveList& cDiveList = m_pcLogBook->diveList();
-    QListIterator<DiveLog*> iLog(cDiveList);
-    while ( iLog.hasNext() ) {
-      DiveLog* pcLog = iLog.next();
-      nNumMins += pcLog->diveTime().hour() * 60 + pcLog->diveTime().minute();
-    }
+    const DiveList& cDiveList = m_pcLogBook->diveList();
+    const qint64 nNumMins = cDiveList.totalDiveTime() / 60;
     cLoggedTimeText =
       QString(i18n("Total logged dive time: %1h %2min"))
       .arg(nNumMins/60)
       .arg(nNumMins%60);
+    const DiveLog* pcDeepest = cDiveList.deepestLog();
+    cStatisticsText =
+      i18n("Dives: %1, deepest: %2 m, gas used: %3 l",
+           cDiveList.count(),
+           QString::asprintf("%.1f", pcDeepest ? pcDeepest->maxDepth() : 0.0),
+           cDiveList.totalGasUsed());
   }
   m_pcLoggedDiveTime->setText(cLoggedTimeText);
+  m_pcStatistics->setText(cStatisticsText);
+}
+
+
+//*****************************************************************************
+/*!
+  The log book has changed. Update the dive totals if the view is shown,
+  as logs can be changed from other windows, or by undo and redo, while
+  it is.
+*/
+//*****************************************************************************
+
+void
+PersonalInfoView::logBookChanged()
+{
+  if ( isVisible() )
+    updateLoggedDiveTime();
 }
 
 
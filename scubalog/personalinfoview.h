@@ -19,7 +19,9 @@
 class QLabel;
 class QLineEdit;
 class QTextEdit;
+class QShowEvent;
 class LogBook;
+class ChangeTracker;
 
 
 //*****************************************************************************
@@ -30,6 +32,10 @@ class LogBook;
   A log book contains some personal information about the diver,
   like name and email address.
 
+  The view also shows the dive totals of the log book. They are updated
+  when the view is shown, and when the log book changes while it is
+  shown.
+
   This class does not take ownership of the log book.
 
   \author André Johansen
@@ -47,11 +53,15 @@ public:
 public slots:
   void updateLoggedDiveTime();
 
+protected:
+  virtual void showEvent(QShowEvent* pcEvent);
+
 private slots:
   void diverNameChanged(const QString& cName);
   void emailAddressChanged(const QString& cEmailAddress);
   void wwwUrlChanged(const QString& cWwwUrl);
   void commentsChanged();
+  void logBookChanged();
 
 private:
   //! Disabled copy constructor.
@@ -67,10 +77,14 @@ private:
   QLineEdit*      m_pcWwwUrl;
   //! The logged dive time label.
   QLabel*         m_pcLoggedDiveTime;
+  //! The label with the number of dives, deepest dive and gas used.
+  QLabel*         m_pcStatistics;
   //! The comments editor.
   QTextEdit*      m_pcComments;
   //! The log book being edited.
   LogBook*        m_pcLogBook;
+  //! The change tracker of the log book, or 0.
+  ChangeTracker*  m_pcTracker;
 };
 
 
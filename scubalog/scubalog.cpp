@@ -21,8 +21,12 @@
 #include "locationview.h"
 #include "logview.h"
 #include "loglistview.h"
+#include "logchecker.h"
 #include "logbook.h"
 #include "divelist.h"
+#include "changetracker.h"
+#include "edithistory.h"
+#include "divelogedit.h"
 #include "integerdialog.h"
 #include "debug.h"
 #include "config.h"
@@ -40,6 +44,8 @@
 #include <QDropEvent>
 #include <QUrl>
 #include <qtabwidget.h>
+#include <qdockwidget.h>
+#include <qlistview.h>
 #include <qpainter.h>
 #include <qprintdialog.h>
 #include <QMimeData>
@@ -52,6 +58,7 @@
 #include <qtextstream.h>
 #include <qnamespace.h>
 #include <qmenu.h>
+#include <qundogroup.h>
 #include <qmenubar.h>
 #include <qpushbutton.h>
 #include <qcolor.h>
@@ -74,11 +81,14 @@ ScubaLog::ScubaLog(const char* pzLogBook)
     m_pcProjectName(0),
     m_pcLogBook(0),
     m_pcRecentMenu(0),
+    m_pcUndoGroup(0),
     m_pcViews(0),
     m_pcLogListView(0),
     m_pcLocationView(0),
     m_pcPersonalInfoView(0),
     m_pcEquipmentView(0),
+    m_pcLogChecker(0),
+    m_pcProblemDock(0),
     m_bReadLastUsedProject(true)
 {
   connect(qApp, SIGNAL(saveStateRequest(QSessionManager&)), SLOT(saveConfig()));
@@ -132,6 +142,8 @@ ScubaLog::ScubaLog(const char* pzLogBook)
   QMenu* pcExportMenu = pcMenuBar->addMenu(i18n("&Export"));
   pcExportMenu->addAction(i18n("Export &HTML..."), this,
                           SLOT(exportLogBook()));
+  pcExportMenu->addAction(i18n("Export HTML &archive..."), this,
+                          SLOT(exportLogBookArchive()));
   pcExportMenu->addAction(i18n("Export &UDCF..."), this,
                           SLOT(exportLogBookUDCF()));
   pcProjMenu->addAction(i18n("&Print..."), this, SLOT(print()),
@@ -140,9 +152,26 @@ ScubaLog::ScubaLog(const char* pzLogBook)
   pcProjMenu->addAction(i18n("&Quit"), qApp, SLOT(quit()),
                         QKeySequence::Quit);
 
+  m_pcUndoGroup = new QUndoGroup(this);
+  QMenu* pcEditMenu = pcMenuBar->addMenu(i18n("&Edit"));
+  // The actions follow the group, but undo through this, so typing not
+  // yet written to the log is written first
+  QAction* pcUndo = m_pcUndoGroup->createUndoAction(this, i18n("&Undo"));
+  pcUndo->setShortcut(QKeySequence::Undo);
+  disconnect(pcUndo, 0, m_pcUndoGroup, 0);
+  connect(pcUndo, SIGNAL(triggered()), SLOT(undo()));
+  pcEditMenu->addAction(pcUndo);
+  QAction* pcRedo = m_pcUndoGroup->createRedoAction(this, i18n("&Redo"));
+  pcRedo->setShortcut(QKeySequence::Redo);
+  disconnect(pcRedo, 0, m_pcUndoGroup, 0);
+  connect(pcRedo, SIGNAL(triggered()), SLOT(redo()));
+  pcEditMenu->addAction(pcRedo);
+
   QMenu* pcLogMenu = pcMenuBar->addMenu(i18n("Log"));
   pcLogMenu->addAction(i18n("&Goto log..."), this, SLOT(gotoLog()),
                        Qt::CTRL + Qt::Key_G);
+  pcLogMenu->addAction(i18n("&Renumber logs..."), this,
+                       SLOT(renumberLogs()));
 
   QString cAboutText;
   QTextStream s(&cAboutText);
@@ -200,12 +229,16 @@ ScubaLog::ScubaLog(const char* pzLogBook)
   // Create the log view
   m_pcLogView = new LogView(m_pcViews);
   m_pcLogView->connect(m_pcLogListView,
-                       SIGNAL(aboutToDeleteLog(const DiveLog*)),
-                       SLOT(deletingLog(const DiveLog*)));
+                       SIGNAL(aboutToDeleteLogs(const QVector<DiveLog*>&)),
+                       SLOT(deletingLogs(const QVector<DiveLog*>&)));
+  m_pcLogView->connect(m_pcLogListView, SIGNAL(aboutToEditLogs()),
+                       SLOT(commitEdits()));
   m_pcViews->addTab(m_pcLogView, i18n("Log &view"));
 
   connect(m_pcLogListView, SIGNAL(displayLog(DiveLog*)),
           SLOT(viewLog(DiveLog*)));
+  connect(m_pcLogListView, SIGNAL(exportSelection(const DiveSelection&)),
+          SLOT(exportLogs(const DiveSelection&)));
 
   // Create the location view
   m_pcLocationView = new LocationView(m_pcViews);
@@ -216,13 +249,26 @@ ScubaLog::ScubaLog(const char* pzLogBook)
   // Create the personal info view
   m_pcPersonalInfoView = new PersonalInfoView(m_pcViews);
   m_pcViews->addTab(m_pcPersonalInfoView, i18n("Personal &info"));
-  m_pcPersonalInfoView->connect(m_pcViews, SIGNAL(currentChanged(int)),
-                                SLOT(updateLoggedDiveTime()));
 
   // Create the equipment view
   m_pcEquipmentView = new EquipmentView(m_pcViews);
   m_pcViews->addTab(m_pcEquipmentView, i18n("&Equipment"));
 
+  // Create the problem panel, showing what the log checker finds
+  m_pcLogChecker = new LogChecker(this);
+  m_pcProblemDock = new QDockWidget(i18n("Problems"), this);
+  m_pcProblemDock->setObjectName("ProblemDock");
+  QListView* pcProblemView = new QListView(m_pcProblemDock);
+  pcProblemView->setModel(m_pcLogChecker);
+  pcProblemView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  pcProblemView->setUniformItemSizes(true);
+  connect(pcProblemView, SIGNAL(activated(const QModelIndex&)),
+          SLOT(viewProblemLog(const QModelIndex&)));
+  m_pcProblemDock->setWidget(pcProblemView);
+  addDockWidget(Qt::BottomDockWidgetArea, m_pcProblemDock);
+  pcLogMenu->addSeparator();
+  pcLogMenu->addAction(m_pcProblemDock->toggleViewAction());
+
   statusBar();
   setCentralWidget(m_pcViews);
   setAutoSaveSettings();
@@ -249,14 +295,18 @@ ScubaLog::ScubaLog(const char* pzLogBook)
     }
   }
   // Create a log book if none loaded
-  if ( 0 == m_pcLogBook )
+  if ( 0 == m_pcLogBook ) {
     m_pcLogBook = new LogBook();
+    watchLogBook();
+  }
   // Update editors
-  m_pcLogListView->setLogList(&m_pcLogBook->diveList());
+  m_pcLogListView->setLogList(&m_pcLogBook->diveList(),
+                              &m_pcLogBook->editHistory());
   m_pcLogView->setLogBook(m_pcLogBook);
   m_pcLocationView->setLogBook(m_pcLogBook);
   m_pcPersonalInfoView->setLogBook(m_pcLogBook);
   m_pcEquipmentView->setLogBook(m_pcLogBook);
+  m_pcLogChecker->setLogBook(m_pcLogBook);
 
   statusBar()->showMessage(i18n("Welcome to ScubaLog"));
 }
@@ -356,13 +406,16 @@ ScubaLog::newProject()
 {
   try {
     LogBook* pcLogBook = new LogBook();
-    m_pcLogListView->setLogList(&pcLogBook->diveList());
+    m_pcLogListView->setLogList(&pcLogBook->diveList(),
+                                &pcLogBook->editHistory());
     m_pcLogView->setLogBook(pcLogBook);
     m_pcLocationView->setLogBook(pcLogBook);
     m_pcPersonalInfoView->setLogBook(pcLogBook);
     m_pcEquipmentView->setLogBook(pcLogBook);
+    m_pcLogChecker->setLogBook(pcLogBook);
     delete m_pcLogBook;
     m_pcLogBook = pcLogBook;
+    watchLogBook();
     setCaption(i18n("Untitled"));
     *m_pcProjectName = "";
   }
@@ -405,6 +458,7 @@ ScubaLog::openProject()
 void
 ScubaLog::saveProject()
 {
+  m_pcLogView->commitEdits();
   if ( m_pcProjectName->isEmpty() ) {
     saveProjectAs();
   }
@@ -421,7 +475,8 @@ ScubaLog::saveProject()
     const bool isOk = exporter->exportLogBook(*m_pcLogBook, *m_pcProjectName);
     delete exporter;
     if ( isOk ) {
-      //setUnsavedData(false);
+      m_pcLogBook->changeTracker().markSaved();
+      m_pcLogBook->editHistory().setClean();
       statusBar()->showMessage(i18n("Writing log book...Done"), 3000);
     }
     else {
@@ -443,6 +498,7 @@ ScubaLog::saveProject()
 void
 ScubaLog::saveProjectAs()
 {
+  m_pcLogView->commitEdits();
   const QString filters(i18n("UDCF files (*.xml);;ScubaLog projects (*.slb)"));
 
   statusBar()->showMessage(i18n("Writing log book..."));
@@ -466,7 +522,8 @@ ScubaLog::saveProjectAs()
     const bool isOk = exporter->exportLogBook(*m_pcLogBook, *m_pcProjectName);
     delete exporter;
     if ( isOk ) {
-      //setUnsavedData(false);
+      m_pcLogBook->changeTracker().markSaved();
+      m_pcLogBook->editHistory().setClean();
       updateRecentProjects(cProjectName);
 
       setCaption(cProjectName);
@@ -482,6 +539,68 @@ ScubaLog::saveProjectAs()
 }
 
 
+//*****************************************************************************
+/*!
+  Undo the last edit of the current log book, after writing any text
+  typed in the log view.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::undo()
+{
+  m_pcLogView->commitEdits();
+  m_pcUndoGroup->undo();
+}
+
+
+//*****************************************************************************
+/*!
+  Redo the last edit undone in the current log book, after writing any
+  text typed in the log view.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::redo()
+{
+  m_pcLogView->commitEdits();
+  m_pcUndoGroup->redo();
+}
+
+
+//*****************************************************************************
+/*!
+  Start following the changes and edit history of the current log book.
+  The edit history becomes the one undone by the Edit menu.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::watchLogBook()
+{
+  connect(&m_pcLogBook->changeTracker(), SIGNAL(modifiedChanged(bool)),
+          SLOT(logBookModified(bool)));
+  m_pcUndoGroup->addStack(&m_pcLogBook->editHistory());
+  m_pcUndoGroup->setActiveStack(&m_pcLogBook->editHistory());
+}
+
+
+//*****************************************************************************
+/*!
+  Show in the caption whether the log book has unsaved changes, as told
+  by \a isModified.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::logBookModified(bool isModified)
+{
+  setCaption(m_pcProjectName->isEmpty() ? i18n("Untitled") : *m_pcProjectName,
+             isModified);
+}
+
+
 //*****************************************************************************
 /*!
   Try to read a project from the local file \a cFileName.
@@ -501,30 +620,42 @@ ScubaLog::readLogBook(const QString& cFileName)
   LogBook* pcLogBook = 0;
   try {
     Importer* importer;
+    UDCFImporter* pcUDCFImporter = 0;
     if ( cFileName.endsWith(".xml") ) {
-      importer = new UDCFImporter();
+      pcUDCFImporter = new UDCFImporter();
+      importer = pcUDCFImporter;
     }
     else {
       importer = new ScubaLogProject();
     }
     pcLogBook = importer->importLogBook(cFileName);
+    const bool hasDuplicates = pcUDCFImporter &&
+      false == pcUDCFImporter->duplicateNumbers().isEmpty();
     delete importer;
     if ( pcLogBook ) {
       // Insert the new logbook
-      m_pcLogListView->setLogList(&pcLogBook->diveList());
+      m_pcLogListView->setLogList(&pcLogBook->diveList(),
+                                  &pcLogBook->editHistory());
       m_pcLogView->setLogBook(pcLogBook);
       m_pcLocationView->setLogBook(pcLogBook);
       m_pcPersonalInfoView->setLogBook(pcLogBook);
       m_pcEquipmentView->setLogBook(pcLogBook);
+      m_pcLogChecker->setLogBook(pcLogBook);
       delete m_pcLogBook;
       m_pcLogBook = pcLogBook;
 
-      //setUnsavedData(false);
+      // Building the log book is not an edit
+      m_pcLogBook->changeTracker().reset();
+      watchLogBook();
       *m_pcProjectName = cFileName;
       updateRecentProjects(cFileName);
       setCaption(cFileName);
 
       statusBar()->showMessage(i18n("Reading log book...Done"), 3000);
+
+      // The problem panel lists the logs with a duplicate number
+      if ( hasDuplicates )
+        m_pcProblemDock->show();
     }
     else {
       delete pcLogBook;
@@ -598,14 +729,30 @@ ScubaLog::updateRecentProjectsMenu()
 
   Currently, a file dialog will be opened asking for an output directory.
   When more export formats are added, a dialog will be added.
+
+  The exporter is set up by setupHTMLExporter().
 */
 //*****************************************************************************
 
 void
 ScubaLog::exportLogBook()
+{
+  exportLogs(DiveSelection());
+}
+
+
+//*****************************************************************************
+/*!
+  Export the logs in \a cSelection as HTML pages, like exportLogBook().
+*/
+//*****************************************************************************
+
+void
+ScubaLog::exportLogs(const DiveSelection& cSelection)
 {
   if ( 0 == m_pcLogBook )
     return;
+  m_pcLogView->commitEdits();
 
   statusBar()->showMessage(i18n("Exporting log book..."));
 
@@ -614,7 +761,49 @@ ScubaLog::exportLogBook()
     QFileDialog::getExistingDirectory(this, caption);
   if ( false == cDirName.isEmpty() ) {
     HTMLExporter cExporter;
-    cExporter.exportLogBook(*m_pcLogBook, cDirName);
+    setupHTMLExporter(cExporter);
+    cExporter.exportLogs(*m_pcLogBook, cSelection, cDirName);
+    statusBar()->showMessage(i18n("Exporting log book...Done"), 3000);
+  }
+  else {
+    statusBar()->showMessage(i18n("Exporting log book...Aborted"), 3000);
+  }
+}
+
+//*****************************************************************************
+/*!
+  Export the logbook as HTML pages in a single zip archive.
+
+  A file dialog will be opened asking for the archive name. The pages are
+  compressed unless the `ArchiveCompression' entry in the `HTMLExport'
+  group of the configuration is false.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::exportLogBookArchive()
+{
+  if ( 0 == m_pcLogBook )
+    return;
+  m_pcLogView->commitEdits();
+
+  statusBar()->showMessage(i18n("Exporting log book..."));
+
+  const QString filters(i18n("Zip archives (*.zip)"));
+  const QString caption(i18n("Save HTML archive"));
+  QString cArchiveName =
+    QFileDialog::getSaveFileName(this, caption, QString(), filters);
+  if ( false == cArchiveName.isEmpty() ) {
+    if ( !cArchiveName.endsWith(".zip") ) {
+      cArchiveName += ".zip";
+    }
+
+    KSharedConfig::Ptr config = KSharedConfig::openConfig();
+    KConfigGroup exportGroup = config->group("HTMLExport");
+    HTMLExporter cExporter;
+    setupHTMLExporter(cExporter);
+    cExporter.exportArchive(*m_pcLogBook, DiveSelection(), cArchiveName,
+                            exportGroup.readEntry("ArchiveCompression", true));
     statusBar()->showMessage(i18n("Exporting log book...Done"), 3000);
   }
   else {
@@ -622,6 +811,34 @@ ScubaLog::exportLogBook()
   }
 }
 
+
+//*****************************************************************************
+/*!
+  Set up the HTML exporter \a cExporter from the configuration.
+
+  The index pagination is read from the `Pagination' entry in the
+  `HTMLExport' group, which is one of `none', `count' or `year',
+  and the `LogsPerPage' entry.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::setupHTMLExporter(HTMLExporter& cExporter) const
+{
+  KSharedConfig::Ptr config = KSharedConfig::openConfig();
+  KConfigGroup exportGroup = config->group("HTMLExport");
+  const QString cPagination =
+    exportGroup.readEntry("Pagination", QString("count"));
+  HTMLExporter::Pagination_e ePagination = HTMLExporter::e_PageByCount;
+  if ( cPagination == "none" )
+    ePagination = HTMLExporter::e_NoPagination;
+  else if ( cPagination == "year" )
+    ePagination = HTMLExporter::e_PageByYear;
+  cExporter.setPagination(ePagination,
+                          exportGroup.readEntry("LogsPerPage", 500));
+}
+
+
 //*****************************************************************************
 /*!
   Export the logbook.
@@ -636,6 +853,7 @@ ScubaLog::exportLogBookUDCF()
 {
   if ( 0 == m_pcLogBook )
     return;
+  m_pcLogView->commitEdits();
 
 
   statusBar()->showMessage(i18n("Exporting log book..."));
@@ -674,6 +892,22 @@ ScubaLog::viewLog(DiveLog* pcLog)
 }
 
 
+//*****************************************************************************
+/*!
+  Switch to the log view, displaying the log with the problem at \a cIndex
+  in the problem panel.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::viewProblemLog(const QModelIndex& cIndex)
+{
+  DiveLog* pcLog = m_pcLogChecker->log(cIndex);
+  if ( pcLog )
+    viewLog(pcLog);
+}
+
+
 //*****************************************************************************
 /*!
   Edit the location with the name \a cLocationName.
@@ -745,15 +979,7 @@ ScubaLog::gotoLog()
   if ( cDialog.exec() ) {
     cDialog.hide();
     const int nLogNumber = cDialog.getValue();
-    DiveLog* pcLog = NULL;
-    i = dives.begin();
-    for ( ; i != dives.end(); ++i ) {
-      DiveLog& dive = *(*i);
-      if ( dive.logNumber() == nLogNumber ) {
-        pcLog = &dive;
-        break;
-      }
-    }
+    DiveLog* pcLog = dives.findLog(nLogNumber);
     if ( 0 == pcLog ) {
       QString cText =
         QString(i18n("Couldn't find log %1"))
@@ -767,6 +993,66 @@ ScubaLog::gotoLog()
 }
 
 
+//*****************************************************************************
+/*!
+  Renumber the logs in the order they were dived, on date and start time.
+  Logs dived at the same time keep their order. The numbering starts at
+  the lowest number in use, so a log book continuing an older one keeps
+  its first number.
+
+  The gaps and duplicates found are shown, and the user is asked before
+  the logs are renumbered. The renumbering is one undo step.
+*/
+//*****************************************************************************
+
+void
+ScubaLog::renumberLogs()
+{
+  if ( 0 == m_pcLogBook )
+    return;
+  m_pcLogView->commitEdits();
+
+  DiveList& cDiveList = m_pcLogBook->diveList();
+  const QVector<DiveLog*>& apcByDate =
+    cDiveList.sortedLogs(DiveList::e_ByDate);
+  int nFirstNumber = INT_MAX;
+  for ( int iLog = 0; iLog < apcByDate.count(); ++iLog )
+    nFirstNumber = qMin(nFirstNumber, apcByDate.at(iLog)->logNumber());
+  nFirstNumber = qMax(nFirstNumber, 1);
+
+  DiveLogEdit* pcEdit = new DiveLogEdit(i18n("Renumber logs"));
+  for ( int iLog = 0; iLog < apcByDate.count(); ++iLog )
+    pcEdit->addChange(apcByDate.at(iLog), DiveLogEdit::e_LogNumber,
+                      nFirstNumber + iLog);
+  if ( 0 == pcEdit->numChanges() ) {
+    delete pcEdit;
+    QMessageBox::information(this, i18n("[ScubaLog] Renumber logs"),
+                             i18n("The logs are already numbered in the "
+                                  "order they were dived."));
+    return;
+  }
+
+  int nGaps = 0;
+  int nDuplicates = 0;
+  cDiveList.checkNumbering(nGaps, nDuplicates);
+  const QString cText =
+    i18n("%1 logs will be renumbered in the order they were dived, "
+         "starting at %2.\n"
+         "There are %3 unused numbers, and %4 logs repeat a number "
+         "used by another log.\n\n"
+         "Renumber the logs?",
+         pcEdit->numChanges(), nFirstNumber, nGaps, nDuplicates);
+  if ( QMessageBox::Yes !=
+       QMessageBox::question(this, i18n("[ScubaLog] Renumber logs"), cText,
+                             QMessageBox::Yes | QMessageBox::No) ) {
+    delete pcEdit;
+    return;
+  }
+
+  m_pcLogBook->editHistory().push(pcEdit);
+}
+
+
 //*****************************************************************************
 /*!
   Print logbook.
@@ -787,6 +1073,7 @@ ScubaLog::print()
   assert(m_pcProjectName);
   if ( m_pcProjectName->isEmpty() || 0 == m_pcLogBook )
     return;
+  m_pcLogView->commitEdits();
 
   statusBar()->showMessage(i18n("Print log book..."));
 
@@ -855,7 +1142,16 @@ ScubaLog::print()
     cPainter.drawText(330,  80, cGasUsage);
     cPainter.drawLine( 30,  90, 390,  90);
     cPainter.setFont(cFontDescription);
-    cPainter.drawText( 15, 110, 390, 400, Qt::TextWordWrap, cDiveDescription);
+    const DiveProfile& cProfile = cCurrentLog.profile();
+    if ( cProfile.isEmpty() ) {
+      cPainter.drawText( 15, 110, 390, 400, Qt::TextWordWrap, cDiveDescription);
+    }
+    else {
+      cPainter.drawText( 15, 110, 390, 380, Qt::TextWordWrap, cDiveDescription);
+      const QRectF cProfileArea(30, 500, 360, 70);
+      cPainter.drawRect(cProfileArea);
+      cPainter.drawPolyline(cProfile.chartPoints(cProfileArea, 0.25));
+    }
     cPainter.setFont(cFontFooter);
     cPainter.drawText( 10, 580, *m_pcProjectName);
     bool bPrintingOk = true;
@@ -22,7 +22,9 @@
 class QAction;
 class QTabWidget;
 class QMenu;
+class QUndoGroup;
 class QSessionManager;
+class QDockWidget;
 class DiveLog;
 class LogBook;
 class LogListView;
@@ -30,6 +32,10 @@ class LogView;
 class LocationView;
 class PersonalInfoView;
 class EquipmentView;
+class LogChecker;
+class QModelIndex;
+class HTMLExporter;
+class DiveSelection;
 
 
 //*****************************************************************************
@@ -52,6 +58,7 @@ public:
 
 public slots:
   void gotoLog();
+  void renumberLogs();
   void saveConfig();
 
 protected:
@@ -66,17 +73,25 @@ private slots:
   void print();
   void viewLogList();
   void viewLog(DiveLog* pcLog);
+  void viewProblemLog(const QModelIndex& cIndex);
   void editLocation(const QString& cLocationName);
   void exportLogBook();
+  void exportLogs(const DiveSelection& cSelection);
+  void exportLogBookArchive();
   void exportLogBookUDCF();
+  void logBookModified(bool isModified);
+  void undo();
+  void redo();
 
 private:
   void dragEnterEvent(QDragEnterEvent* pcEvent);
   void dropEvent(QDropEvent* pcEvent);
   bool readLogBook(const QString& cFileName);
+  void watchLogBook();
 
   void updateRecentProjects(const QString& cProjectName);
   void updateRecentProjectsMenu();
+  void setupHTMLExporter(HTMLExporter& cExporter) const;
 
   //! The name of the current project, or none if not saved yet.
   QString*          m_pcProjectName;
@@ -84,6 +99,8 @@ private:
   LogBook*          m_pcLogBook;
   //! The recent menu.
   QMenu*            m_pcRecentMenu;
+  //! The edit histories, of which the current log book's is active.
+  QUndoGroup*       m_pcUndoGroup;
   //! The tab view.
   QTabWidget*       m_pcViews;
   //! The log list view.
@@ -96,6 +113,10 @@ private:
   PersonalInfoView* m_pcPersonalInfoView;
   //! The equipment view.
   EquipmentView*    m_pcEquipmentView;
+  //! The checker of the dive logs, shown in the problem panel.
+  LogChecker*       m_pcLogChecker;
+  //! The problem panel.
+  QDockWidget*      m_pcProblemDock;
 
   //
   // Configuration settings
@@ -13,6 +13,7 @@
 #include "equipmentlog.h"
 #include "locationlog.h"
 #include "divelist.h"
+#include "stringpool.h"
 #include "chunkio.h"
 #include "debug.h"
 
@@ -83,6 +84,8 @@ ScubaLogProject::importLogBook(const QString& cFileName) const
   }
 
   LogBook* pcLogBook = new LogBook();
+  DiveLog* pcLastLog = 0;
+  int nNumDuplicates = 0;
 
   // Read all chunks
   while ( !cStream.atEnd() ) {
@@ -103,9 +106,10 @@ ScubaLogProject::importLogBook(const QString& cFileName) const
     // Read a dive log
     else if ( MAKE_CHUNK_ID('S', 'L', 'D', 'L') == nChunkId ) {
       int nPos = cFile.pos();
-      DiveLog* pcLog = new DiveLog();
+      DiveList& cDiveList = pcLogBook->diveList();
+      DiveLog* pcLog = cDiveList.newLog();
       try {
-        readDiveLog(cStream, *pcLog);
+        readDiveLog(cStream, *pcLog, pcLogBook->stringPool());
       }
       catch ( IOException& cException ) {
         QString cText;
@@ -117,14 +121,36 @@ ScubaLogProject::importLogBook(const QString& cFileName) const
         cStream >> nChunkSize >> nChunkVersion;
         cFile.seek(nPos + nChunkSize - sizeof(unsigned int));
         DBG(("Position of next chunk=%d\n", cFile.pos()));
-        delete pcLog;
+        cDiveList.deleteLog(pcLog);
+        pcLastLog = 0;
         continue;
       }
       DBG(("Read log %d (%s)\n",
            pcLog->logNumber(),
            pcLog->diveLocation().toUtf8().constData()));
-      DiveList& cDiveList = pcLogBook->diveList();
-      cDiveList.append(pcLog);
+      if ( false == cDiveList.append(pcLog) )
+        ++nNumDuplicates;
+      pcLastLog = pcLog;
+    }
+
+    // Read the profile of the previous dive log
+    else if ( MAKE_CHUNK_ID('S', 'L', 'D', 'P') == nChunkId ) {
+      int nPos = cFile.pos();
+      try {
+        readDiveProfile(cStream, pcLastLog);
+      }
+      catch ( IOException& cException ) {
+        QString cText;
+        cText = QString(i18n("Error while reading log book from"))
+          + "\n`" + cFileName + "':\n" + cException.explanation();
+        QMessageBox::warning(QApplication::topLevelWidgets().at(0),
+                             i18n("[ScubaLog] Read log book"), cText);
+        cFile.seek(nPos);
+        cStream >> nChunkSize >> nChunkVersion;
+        cFile.seek(nPos + nChunkSize - sizeof(unsigned int));
+        DBG(("Position of next chunk=%d\n", cFile.pos()));
+        continue;
+      }
     }
 
     // Read a location log
@@ -203,12 +229,23 @@ ScubaLogProject::importLogBook(const QString& cFileName) const
     delete pcLogBook;
     pcLogBook = 0;
   }
+  else if ( nNumDuplicates ) {
+    QString cMessage;
+    cMessage = QString(i18n("The log book in"))
+      + "\n`" + cFileName + "'\n"
+      + QString(i18n("has %1 logs with a log number already in use."))
+      .arg(nNumDuplicates);
+    QMessageBox::warning(QApplication::topLevelWidgets().at(0),
+                         i18n("[ScubaLog] Read log book"),
+                         cMessage);
+  }
 
   // Sort the lists.
   DiveList& cDiveList = pcLogBook->diveList();
   cDiveList.sort();
   QList<LocationLog*>& cLocationList = pcLogBook->locationList();
   std::sort(cLocationList.begin(), cLocationList.end(), CompareLocations);
+  cDiveList.setLocations(cLocationList);
 
   return pcLogBook;
 }
@@ -216,7 +253,9 @@ ScubaLogProject::importLogBook(const QString& cFileName) const
 
 //*****************************************************************************
 /*!
-  Save the log book \a cLogBook to the file \a cFileName.
+  Save the logs in \a cSelection from the log book \a cLogBook to the file
+  \a cFileName. The personal information, location logs and equipment
+  are always saved.
 
   Returns `true' if ok, else `false'. Only I/O errors like permission denied
   and out of space should result in errors.
@@ -224,8 +263,9 @@ ScubaLogProject::importLogBook(const QString& cFileName) const
 //*****************************************************************************
 
 bool
-ScubaLogProject::exportLogBook(const LogBook& cLogBook,
-                               const QString& cFileName) const
+ScubaLogProject::exportLogs(const LogBook&       cLogBook,
+                            const DiveSelection& cSelection,
+                            const QString&       cFileName) const
 {
   QFile cFile(cFileName);
   if ( false == cFile.open(QIODevice::WriteOnly) ) {
@@ -257,10 +297,13 @@ ScubaLogProject::exportLogBook(const LogBook& cLogBook,
 
     // Write all the dive logs
     const DiveList& cDiveList = cLogBook.diveList();
-    QListIterator<DiveLog*> iDiveLog(cDiveList);
+    const QVector<int> anLogs = cSelection.indices(cDiveList);
+    QVectorIterator<int> iDiveLog(anLogs);
     while ( iDiveLog.hasNext() ) {
-      const DiveLog* pcLog = iDiveLog.next();
+      const DiveLog* pcLog = cDiveList.at(iDiveLog.next());
       writeDiveLog(cStream, *pcLog);
+      if ( false == pcLog->profile().isEmpty() )
+        writeDiveProfile(cStream, *pcLog);
     }
 
     // Write all the location logs
@@ -384,6 +427,7 @@ ScubaLogProject::writePersonalInformation(QDataStream&   cStream,
 //*****************************************************************************
 /*!
   Read a dive log from the stream \a cStream to \a cLog.
+  The strings repeated across logs are shared through \a cStrings.
 
   \exception IOException is thrown on input errors.
 */
@@ -391,7 +435,8 @@ ScubaLogProject::writePersonalInformation(QDataStream&   cStream,
 
 void
 ScubaLogProject::readDiveLog(QDataStream& cStream,
-                             DiveLog&     cLog) const
+                             DiveLog&     cLog,
+                             StringPool&  cStrings) const
 {
   // Save current IO position for checking at end
   const QIODevice& cDevice = *cStream.device();
@@ -445,18 +490,18 @@ ScubaLogProject::readDiveLog(QDataStream& cStream,
   cLog.setLogNumber(nLogNumber);
   cLog.setDiveDate(cDiveDate);
   cLog.setDiveStart(cDiveStart);
-  cLog.setDiveLocation(cLocation);
-  cLog.setBuddyName(cBuddyName);
+  cLog.setDiveLocation(cStrings.intern(cLocation));
+  cLog.setBuddyName(cStrings.intern(cBuddyName));
   cLog.setMaxDepth(vMaxDepth);
   cLog.setDiveTime(cDiveTime);
   cLog.setBottomTime(cBottomTime);
-  cLog.setGasType(cGasType);
+  cLog.setGasType(cStrings.intern(cGasType));
   cLog.setSurfaceAirConsumption(nNumLitresUsed);
   cLog.setAirTemperature(vAirTemperature);
   cLog.setWaterSurfaceTemperature(vSurfaceTemperature);
   cLog.setWaterTemperature(vWaterTemperature);
   cLog.setPlanType((DiveLog::PlanType_e)nPlanType);
-  cLog.setDiveType(cDiveType);
+  cLog.setDiveType(cStrings.intern(cDiveType));
   cLog.setDiveDescription(cDescription);
 
   // Ensure we're at the correct position in the stream
@@ -538,6 +583,139 @@ ScubaLogProject::writeDiveLog(QDataStream&   cStream,
 }
 
 
+//*****************************************************************************
+/*!
+  Read a dive profile from the stream \a cStream to the log \a pcLog,
+  which should be the log read from the preceding chunk.
+
+  \exception IOException is thrown on input errors, or if the profile
+  doesn't belong to \a pcLog.
+*/
+//*****************************************************************************
+
+void
+ScubaLogProject::readDiveProfile(QDataStream& cStream,
+                                 DiveLog*     pcLog) const
+{
+  // Save current IO position for checking at end
+  const QIODevice& cDevice = *cStream.device();
+  const qint64 nPos = cDevice.pos();
+
+  // Read rest of header
+  unsigned int nChunkSize;
+  unsigned int nChunkVersion;
+  cStream >> nChunkSize
+          >> nChunkVersion;
+  if ( 1 != nChunkVersion ) {
+    const QString cText =
+      QString::asprintf(i18n("Unknown dive profile chunk version %d!").toLatin1(),
+                        nChunkVersion);
+    throw IOException(cText);
+  }
+
+  // The chunk must hold its header (the id, the size, the version, the log
+  // number and the number of samples), and must end within the file
+  const unsigned int nHeaderSize = 5 * sizeof(unsigned int);
+  const qint64 nNextChunkPos =
+    nPos + qint64(nChunkSize) - qint64(sizeof(unsigned int));
+  if ( nChunkSize < nHeaderSize || nNextChunkPos > cDevice.size() ) {
+    const QString cText =
+      QString::asprintf(i18n("Invalid dive profile chunk size (%u)!")
+                        .toLatin1(),
+                        nChunkSize);
+    throw IOException(cText);
+  }
+
+  int          nLogNumber;
+  unsigned int nNumSamples;
+  cStream >> nLogNumber
+          >> nNumSamples;
+  if ( 0 == pcLog || pcLog->logNumber() != nLogNumber ) {
+    const QString cText =
+      QString::asprintf(i18n("Found dive profile for log %d without "
+                             "the dive log!").toLatin1(),
+                        nLogNumber);
+    throw IOException(cText);
+  }
+  const qint64 nSampleSize = sizeof(unsigned int) + sizeof(float);
+  const qint64 nSampleBytes = nNextChunkPos - cDevice.pos();
+  if ( nSampleBytes < 0 || nNumSamples > nSampleBytes / nSampleSize ) {
+    const QString cText =
+      QString::asprintf(i18n("Invalid number of samples (%d) in dive profile!")
+                        .toLatin1(),
+                        nNumSamples);
+    throw IOException(cText);
+  }
+
+  DiveProfile cProfile;
+  for ( unsigned int iSample = 0; iSample < nNumSamples; ++iSample ) {
+    int   nTime;
+    float vDepth;
+    cStream >> nTime
+            >> vDepth;
+    if ( QDataStream::Ok != cStream.status() )
+      throw IOException(i18n("Unexpected end of file in dive profile!"));
+    cProfile.addSample(nTime, vDepth);
+  }
+
+  // Ensure we're at the correct position in the stream
+  if ( nNextChunkPos != cDevice.pos() ) {
+    const QString cText =
+      QString::asprintf(i18n("Unexpected position after reading dive profile!\n"
+                             "Current position is %d; expected %d...").toLatin1(),
+                        int(cDevice.pos()), int(nNextChunkPos));
+    throw IOException(cText);
+  }
+
+  pcLog->setProfile(cProfile);
+}
+
+
+//*****************************************************************************
+/*!
+  Write the profile of the dive log \a cLog to the stream \a cStream.
+  On error, the exception IOException is thrown.
+*/
+//*****************************************************************************
+
+void
+ScubaLogProject::writeDiveProfile(QDataStream&   cStream,
+                                  const DiveLog& cLog) const
+{
+  // Save current IO position for checking at end
+  const QIODevice& cDevice = *cStream.device();
+  const int nPos = cDevice.pos();
+
+  const DiveProfile& cProfile = cLog.profile();
+  const unsigned int nNumSamples = cProfile.numSamples();
+  const unsigned int nChunkVersion = 1;
+  const unsigned int nChunkSize =
+    3 * sizeof(unsigned int)
+    + sizeof(unsigned int)
+    + sizeof(unsigned int)
+    + nNumSamples * (sizeof(unsigned int) + sizeof(float));
+  cStream << MAKE_CHUNK_ID('S', 'L', 'D', 'P')
+          << nChunkSize
+          << nChunkVersion
+          << cLog.logNumber()
+          << nNumSamples;
+  for ( unsigned int iSample = 0; iSample < nNumSamples; ++iSample ) {
+    cStream << cProfile.sampleTime(iSample)
+            << cProfile.sampleDepth(iSample);
+  }
+
+  // Ensure we're at the correct position in the stream
+  const unsigned int nNextChunkPos = nPos + nChunkSize;
+  if ( nNextChunkPos != cDevice.pos() ) {
+    const QString cText =
+      QString::asprintf(i18n("Unexpected position after writing dive profile!\n"
+                             "Current position is %d; expected %d...").toLatin1(),
+                        cDevice.pos(), nNextChunkPos);
+    throw IOException(cText);
+  }
+}
+
+
 //*****************************************************************************
 /*!
   Read a location log from the stream \a cStream into \a cLog.
@@ -675,15 +853,10 @@ ScubaLogProject::readEquipmentLog(QDataStream&  cStream,
   unsigned int nNumEntries;
   cStream >> nNumEntries;
   for ( unsigned int iEntry = 0; iEntry < nNumEntries; iEntry++ ) {
-    EquipmentHistoryEntry* pcEntry = new EquipmentHistoryEntry();
-    try {
-      readEquipmentHistoryEntry(cStream, *pcEntry);
-    }
-    catch ( ... ) {
-      delete pcEntry;
-      throw;
-    }
-    cLog.history().append(pcEntry);
+    QDate cDate;
+    QString cComment;
+    readEquipmentHistoryEntry(cStream, cDate, cComment);
+    cLog.addHistoryEntry(cDate, cComment);
   }
 
   // Ensure we're at the correct position in the stream
@@ -714,8 +887,6 @@ ScubaLogProject::writeEquipmentLog(QDataStream&        cStream,
   const QIODevice& cDevice = *cStream.device();
   const int nPos = cDevice.pos();
 
-  QListIterator<EquipmentHistoryEntry*> iHistoryEntry(cLog.history());
-
   // Calculate the chunk size
   unsigned int nChunkSize =
     3 * sizeof(unsigned int)
@@ -724,9 +895,9 @@ ScubaLogProject::writeEquipmentLog(QDataStream&        cStream,
     + sizeof(unsigned int) + cLog.serialNumber().length()
     + sizeof(unsigned int) + cLog.serviceRequirements().length()
     + sizeof(unsigned int);
-  for ( ; iHistoryEntry.hasNext(); ) {
-    const EquipmentHistoryEntry* pcEntry = iHistoryEntry.next();
-    nChunkSize += 2 * sizeof(unsigned int) + pcEntry->comment().length();
+  for ( int iEntry = 0; iEntry < cLog.historyCount(); ++iEntry ) {
+    nChunkSize +=
+      2 * sizeof(unsigned int) + cLog.historyComment(iEntry).length();
   }
 
   // Write the header
@@ -740,13 +911,12 @@ ScubaLogProject::writeEquipmentLog(QDataStream&        cStream,
           << cLog.name()
           << cLog.serialNumber()
           << cLog.serviceRequirements()
-          << cLog.history().count();
+          << cLog.historyCount();
 
   // Write the history entries
-  iHistoryEntry = cLog.history();
-  for ( ; iHistoryEntry.hasNext(); ) {
-    const EquipmentHistoryEntry* pcEntry = iHistoryEntry.next();
-    writeEquipmentHistoryEntry(cStream, *pcEntry);
+  for ( int iEntry = 0; iEntry < cLog.historyCount(); ++iEntry ) {
+    writeEquipmentHistoryEntry(cStream, cLog.historyDate(iEntry),
+                               cLog.historyComment(iEntry));
   }
 
   // Ensure we're at the correct position in the stream
@@ -763,7 +933,8 @@ ScubaLogProject::writeEquipmentLog(QDataStream&        cStream,
 
 //*****************************************************************************
 /*!
-  Read an equipment history entry from the stream \a cStream into \a cEntry.
+  Read an equipment history entry from the stream \a cStream into
+  \a cDate and \a cComment.
 
   This function needs better error-handling. Use exceptions!
 */
@@ -771,29 +942,28 @@ ScubaLogProject::writeEquipmentLog(QDataStream&        cStream,
 
 void
 ScubaLogProject::readEquipmentHistoryEntry(QDataStream& cStream,
-                                           EquipmentHistoryEntry& cEntry) const
+                                           QDate&       cDate,
+                                           QString&     cComment) const
 {
-  QDate cDate;
-  QString cComment;
   cStream >> cDate
           >> cComment;
-  cEntry.setDate(cDate);
-  cEntry.setComment(cComment);
 }
 
 
 //*****************************************************************************
 /*!
-  Write the equipment history entry \a cEntry to the stream \a cStream.
+  Write the equipment history entry with the date \a cDate and the comment
+  \a cComment to the stream \a cStream.
 */
 //*****************************************************************************
 
 void
-ScubaLogProject::writeEquipmentHistoryEntry(QDataStream& cStream,
-                                            const EquipmentHistoryEntry& cEntry) const
+ScubaLogProject::writeEquipmentHistoryEntry(QDataStream&   cStream,
+                                            const QDate&   cDate,
+                                            const QString& cComment) const
 {
-  cStream << cEntry.date()
-          << cEntry.comment();
+  cStream << cDate
+          << cComment;
 }
 
 
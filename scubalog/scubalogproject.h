@@ -16,11 +16,12 @@
 #include "chunkio.h"
 
 class QDataStream;
+class QDate;
 class LogBook;
 class DiveLog;
 class LocationLog;
 class EquipmentLog;
-class EquipmentHistoryEntry;
+class StringPool;
 
 //*****************************************************************************
 /*!
@@ -71,6 +72,16 @@ class EquipmentHistoryEntry;
   \arg U8[]  Dive type (zero-terminated)
   \arg U8[]  Dive description (zero-terminated)
 
+  The dive profile chunk, which follows the dive log chunk it belongs to
+  if the dive has a profile:
+  \arg U32   An identifier containing the characters "SLDP"
+  \arg U32   The size of the chunk including the header
+  \arg U32   The chunk format version (current version is 1)
+  \arg U32   The dive number
+  \arg U32   The number of samples
+  \arg U32   The time of the sample (in seconds from the start of the dive)
+  \arg Float The depth of the sample (meters)
+
   The equipment chunk:
   \arg U32   An identifier containing the characters "SLEL"
   \arg U32   The size of the chunk including the header
@@ -105,8 +116,9 @@ public:
   //! This function is not implemented, and will always return false.
   virtual bool exportLog(const DiveLog& /*cLog*/,
                          const QString& /*cName*/) const { return false; }
-  virtual bool exportLogBook(const LogBook& cLogBook,
-                             const QString& cName) const;
+  virtual bool exportLogs(const LogBook&       cLogBook,
+                          const DiveSelection& cSelection,
+                          const QString&       cName) const;
 
 private:
   void readPersonalInformation(QDataStream& cStream,
@@ -115,9 +127,14 @@ private:
                                 const LogBook& cLogBook) const;
 
   void readDiveLog(QDataStream& cStream,
-                   DiveLog&     cLog) const;
+                   DiveLog&     cLog,
+                   StringPool&  cStrings) const;
   void writeDiveLog(QDataStream&   cStream,
                     const DiveLog& cLog) const;
+  void readDiveProfile(QDataStream& cStream,
+                       DiveLog*     pcLog) const;
+  void writeDiveProfile(QDataStream&   cStream,
+                        const DiveLog& cLog) const;
 
   void readLocationLog(QDataStream& cStream,
                        LocationLog& cLog) const;
@@ -129,10 +146,12 @@ private:
   void writeEquipmentLog(QDataStream&        cStream,
                          const EquipmentLog& cLog) const;
 
-  void readEquipmentHistoryEntry(QDataStream&           cStream,
-                                 EquipmentHistoryEntry& cEntry) const;
-  void writeEquipmentHistoryEntry(QDataStream& cStream,
-                                  const EquipmentHistoryEntry& cEntry) const;
+  void readEquipmentHistoryEntry(QDataStream& cStream,
+                                 QDate&       cDate,
+                                 QString&     cComment) const;
+  void writeEquipmentHistoryEntry(QDataStream&   cStream,
+                                  const QDate&   cDate,
+                                  const QString& cComment) const;
 };
 
 #endif // SCUBALOGPROJECT_H
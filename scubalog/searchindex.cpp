@@ -0,0 +1,240 @@
+//*****************************************************************************
+/*!
+  \file searchindex.cpp
+  \brief This file contains the implementation of the SearchIndex class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "searchindex.h"
+#include "divelog.h"
+#include <qregexp.h>
+#include <qstringlist.h>
+#include <qtextstream.h>
+
+
+/**
+ * The characters words are made of, as ranges of code points, after the
+ * text is put in lower case. Everything else separates words. The same
+ * ranges are used for the log text and, in the search page, for the
+ * query, so a query is split just like the text it should find.
+ */
+
+static const struct {
+  ushort nFirst;
+  ushort nLast;
+} s_asWordRanges[] = {
+  { '0', '9' },
+  { '_', '_' },
+  { 'a', 'z' },
+  { 0x00c0, 0x00d6 },   // Latin-1 letters, without the multiplication sign
+  { 0x00d8, 0x00f6 },   // and the division sign
+  { 0x00f8, 0x02af },   // Latin extended letters and IPA
+  { 0x0370, 0x03ff },   // Greek
+  { 0x0400, 0x052f },   // Cyrillic
+  { 0x3040, 0x30ff },   // Hiragana and katakana
+  { 0x4e00, 0x9fff },   // CJK ideographs
+  { 0xac00, 0xd7a3 }    // Hangul syllables
+};
+
+
+/**
+ * Quote \a cText as a JavaScript string literal.
+ */
+
+static QString
+quoteJavaScript(const QString& cText)
+{
+  QString cQuoted("\"");
+  for ( int i = 0; i < cText.length(); ++i ) {
+    const QChar c = cText.at(i);
+    if ( c == '"' || c == '\\' )
+      cQuoted += QString("\\") + c;
+    else if ( c == '\n' )
+      cQuoted += "\\n";
+    else if ( c == '<' )
+      cQuoted += "\\x3c";
+    else if ( c.unicode() < 0x20 )
+      cQuoted += " ";
+    else
+      cQuoted += c;
+  }
+  cQuoted += "\"";
+  return cQuoted;
+}
+
+
+/**
+ * Get the code point \a nCode for a character class, escaped unless it is
+ * ASCII, in JavaScript syntax if \a isJavaScript is `true', else in QRegExp
+ * syntax.
+ */
+
+static QString
+patternCharacter(ushort nCode, bool isJavaScript)
+{
+  if ( nCode < 0x80 )
+    return QString(QChar(nCode));
+  return QString(isJavaScript ? "\\u%1" : "\\x%1")
+    .arg(nCode, 4, 16, QChar('0'));
+}
+
+
+//*****************************************************************************
+/*!
+  Create an empty index.
+*/
+//*****************************************************************************
+
+SearchIndex::SearchIndex()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the index.
+*/
+//*****************************************************************************
+
+SearchIndex::~SearchIndex()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Add the log \a cLog as the next document in the index.
+*/
+//*****************************************************************************
+
+void
+SearchIndex::addLog(const DiveLog& cLog)
+{
+  const int nDocument = m_anLogNumbers.count();
+  m_anLogNumbers.append(cLog.logNumber());
+  m_acDates.append(cLog.diveDate().toString(Qt::ISODate));
+  m_acLocations.append(cLog.diveLocation());
+
+  addText(cLog.diveLocation(), nDocument);
+  addText(cLog.buddyName(), nDocument);
+  addText(cLog.diveType(), nDocument);
+  addText(cLog.diveDescription(), nDocument);
+}
+
+
+//*****************************************************************************
+/*!
+  Get a regular expression matching a run of characters that separate
+  words, in JavaScript syntax if \a isJavaScript is `true', else in
+  QRegExp syntax. The text must be in lower case.
+*/
+//*****************************************************************************
+
+QString
+SearchIndex::separatorPattern(bool isJavaScript)
+{
+  QString cPattern("[^");
+  const int nNumRanges = sizeof(s_asWordRanges) / sizeof(s_asWordRanges[0]);
+  for ( int iRange = 0; iRange < nNumRanges; ++iRange ) {
+    const ushort nFirst = s_asWordRanges[iRange].nFirst;
+    const ushort nLast = s_asWordRanges[iRange].nLast;
+    cPattern += patternCharacter(nFirst, isJavaScript);
+    if ( nLast != nFirst )
+      cPattern += "-" + patternCharacter(nLast, isJavaScript);
+  }
+  cPattern += "]+";
+  return cPattern;
+}
+
+
+//*****************************************************************************
+/*!
+  Split \a cText into words, and add \a nDocument to the document list
+  of each of them.
+
+  Documents are always added in ascending order, so a word already seen
+  in this document is recognised by the last entry in its list. The words
+  are split with separatorPattern(), as the search page splits queries.
+*/
+//*****************************************************************************
+
+void
+SearchIndex::addText(const QString& cText, int nDocument)
+{
+  static const QRegExp cSeparator(separatorPattern());
+  const QStringList cWords =
+    cText.toLower().split(cSeparator, QString::SkipEmptyParts);
+  QStringList::const_iterator i = cWords.begin();
+  for ( ; i != cWords.end(); ++i ) {
+    if ( (*i).length() < 2 )
+      continue;
+    QVector<int>& cDocuments = m_cPostings[*i];
+    if ( cDocuments.isEmpty() || cDocuments.last() != nDocument )
+      cDocuments.append(nDocument);
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Write the index to \a cStream as JavaScript.
+
+  A script file is used instead of plain JSON, as browsers will not load
+  JSON from local files; the page just includes it with a SCRIPT tag.
+  The variable `scubalogIndex' gets two members; `docs' with the log number,
+  date and location of each document, and `words' with the delta-encoded
+  document list of each word.
+*/
+//*****************************************************************************
+
+void
+SearchIndex::write(QTextStream& cStream) const
+{
+  cStream << "var scubalogIndex = {\n"
+          << "\"docs\":[";
+  for ( int iDocument = 0; iDocument < m_anLogNumbers.count(); ++iDocument ) {
+    if ( iDocument )
+      cStream << ",";
+    cStream << "\n[" << m_anLogNumbers.at(iDocument)
+            << "," << quoteJavaScript(m_acDates.at(iDocument))
+            << "," << quoteJavaScript(m_acLocations.at(iDocument))
+            << "]";
+  }
+  cStream << "],\n"
+          << "\"words\":{";
+
+  QStringList cWords = m_cPostings.keys();
+  cWords.sort();
+  QStringList::const_iterator i = cWords.begin();
+  for ( ; i != cWords.end(); ++i ) {
+    if ( i != cWords.begin() )
+      cStream << ",";
+    cStream << "\n" << quoteJavaScript(*i) << ":[";
+    const QVector<int>& cDocuments = m_cPostings[*i];
+    int nPrevious = 0;
+    for ( int iPosting = 0; iPosting < cDocuments.count(); ++iPosting ) {
+      if ( iPosting )
+        cStream << ",";
+      cStream << cDocuments.at(iPosting) - nPrevious;
+      nPrevious = cDocuments.at(iPosting);
+    }
+    cStream << "]";
+  }
+  cStream << "}\n"
+          << "};\n";
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,83 @@
+//*****************************************************************************
+/*!
+  \file searchindex.h
+  \brief This file contains the definition of the SearchIndex class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <qhash.h>
+#include <qstring.h>
+#include <qvector.h>
+
+class DiveLog;
+class QTextStream;
+
+
+//*****************************************************************************
+/*!
+  \class SearchIndex
+  \brief The SearchIndex class is an inverted index over exported dive logs.
+
+  The index is built one log at a time while the HTML pages are generated,
+  and is written as a JavaScript file that a static search page can load
+  without a web server.
+
+  Each log added becomes a document, numbered in the order it was added.
+  The location, buddy, dive type and description are split into lower case
+  words, and each word maps to the ascending list of documents it occurs in.
+  The lists are written delta-encoded to keep the output compact.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class SearchIndex
+{
+public:
+  SearchIndex();
+  ~SearchIndex();
+
+  void addLog(const DiveLog& cLog);
+  //! Get the number of documents in the index.
+  int numDocuments() const { return m_anLogNumbers.count(); }
+
+  void write(QTextStream& cStream) const;
+
+  static QString separatorPattern(bool isJavaScript = false);
+
+private:
+  //! Disabled copy constructor.
+  SearchIndex(const SearchIndex&);
+  //! Disabled assignment operator.
+  SearchIndex& operator =(const SearchIndex&);
+
+  void addText(const QString& cText, int nDocument);
+
+  //! The log number of each document.
+  QVector<int>                  m_anLogNumbers;
+  //! The date of each document, in ISO format.
+  QVector<QString>              m_acDates;
+  //! The location of each document.
+  QVector<QString>              m_acLocations;
+  //! The ascending document lists, indexed by word.
+  QHash<QString, QVector<int> > m_cPostings;
+};
+
+#endif // SEARCHINDEX_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,181 @@
+//*****************************************************************************
+/*!
+  \file serviceindex.cpp
+  \brief This file contains the implementation of the ServiceIndex class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "serviceindex.h"
+#include "equipmentlog.h"
+#include <algorithm>
+
+
+/**
+ * Orders positions in an array of dates on the dates they refer to.
+ */
+
+struct EventDateLess {
+  //! Create an ordering on the dates in \a acDates.
+  explicit EventDateLess(const QVector<QDate>& acDates) : m_acDates(acDates) {}
+
+  //! Returns `true' if the date at \a nPos1 is before the one at \a nPos2.
+  bool operator ()(int nPos1, int nPos2) const {
+    return m_acDates.at(nPos1) < m_acDates.at(nPos2);
+  }
+
+  //! The dates.
+  const QVector<QDate>& m_acDates;
+};
+
+
+/**
+ * Sort the positions \a anOrder on the dates they refer to in \a acDates.
+ * Positions with the same date keep their order.
+ */
+
+static void
+sortOnDate(QVector<int>& anOrder, const QVector<QDate>& acDates)
+{
+  std::stable_sort(anOrder.begin(), anOrder.end(), EventDateLess(acDates));
+}
+
+
+//*****************************************************************************
+/*!
+  Create an empty index.
+*/
+//*****************************************************************************
+
+ServiceIndex::ServiceIndex()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the index.
+*/
+//*****************************************************************************
+
+ServiceIndex::~ServiceIndex()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Build the index of the history of the items in \a cEquipment.
+  Anything indexed before is forgotten.
+
+  The histories are already sorted, so the events are gathered and sorted
+  once; that takes time in proportion to n log n for n events.
+*/
+//*****************************************************************************
+
+void
+ServiceIndex::build(const QList<EquipmentLog*>& cEquipment)
+{
+  QVector<QDate> acDates;
+  QVector<EquipmentLog*> apcItems;
+  QVector<int> anEntries;
+  QVector<QDate> acLastDates;
+  QVector<EquipmentLog*> apcLastItems;
+
+  QListIterator<EquipmentLog*> iItem(cEquipment);
+  while ( iItem.hasNext() ) {
+    EquipmentLog* pcItem = iItem.next();
+    const QVector<QDate>& acHistory = pcItem->historyDates();
+    for ( int iEntry = 0; iEntry < acHistory.count(); ++iEntry ) {
+      acDates.append(acHistory.at(iEntry));
+      apcItems.append(pcItem);
+      anEntries.append(iEntry);
+    }
+    if ( false == acHistory.isEmpty() ) {
+      acLastDates.append(acHistory.last());
+      apcLastItems.append(pcItem);
+    }
+  }
+
+  QVector<int> anOrder(acDates.count());
+  for ( int iEvent = 0; iEvent < anOrder.count(); ++iEvent )
+    anOrder[iEvent] = iEvent;
+  sortOnDate(anOrder, acDates);
+  m_acDates.resize(anOrder.count());
+  m_apcItems.resize(anOrder.count());
+  m_anEntries.resize(anOrder.count());
+  for ( int iEvent = 0; iEvent < anOrder.count(); ++iEvent ) {
+    m_acDates[iEvent] = acDates.at(anOrder.at(iEvent));
+    m_apcItems[iEvent] = apcItems.at(anOrder.at(iEvent));
+    m_anEntries[iEvent] = anEntries.at(anOrder.at(iEvent));
+  }
+
+  QVector<int> anLastOrder(acLastDates.count());
+  for ( int iItem = 0; iItem < anLastOrder.count(); ++iItem )
+    anLastOrder[iItem] = iItem;
+  sortOnDate(anLastOrder, acLastDates);
+  m_acLastDates.resize(anLastOrder.count());
+  m_apcLastItems.resize(anLastOrder.count());
+  for ( int iItem = 0; iItem < anLastOrder.count(); ++iItem ) {
+    m_acLastDates[iItem] = acLastDates.at(anLastOrder.at(iItem));
+    m_apcLastItems[iItem] = apcLastItems.at(anLastOrder.at(iItem));
+  }
+}
+
+
+//*****************************************************************************
+/*!
+  Get the index of the first event on or after \a cDate, or count() if
+  there is none. The events in a period are those from findEvent() of
+  the first day up to findEvent() of the day after the last.
+*/
+//*****************************************************************************
+
+int
+ServiceIndex::findEvent(const QDate& cDate) const
+{
+  return std::lower_bound(m_acDates.constBegin(), m_acDates.constEnd(), cDate)
+    - m_acDates.constBegin();
+}
+
+
+//*****************************************************************************
+/*!
+  Get the items that are due for service by \a cDate, if they are to be
+  serviced every \a nIntervalDays days. An item is due if its last history
+  event is \a nIntervalDays or more days before \a cDate. The items are
+  returned with the longest overdue first.
+
+  Items without a history are not returned, as there is nothing to count
+  from. For example, the items due within a month with yearly service are
+  found with dueForService(QDate::currentDate().addDays(30), 365).
+*/
+//*****************************************************************************
+
+QList<EquipmentLog*>
+ServiceIndex::dueForService(const QDate& cDate, int nIntervalDays) const
+{
+  const QDate cLastAllowed = cDate.addDays(-nIntervalDays);
+  const int nDue =
+    std::upper_bound(m_acLastDates.constBegin(), m_acLastDates.constEnd(),
+                     cLastAllowed) - m_acLastDates.constBegin();
+  QList<EquipmentLog*> cDue;
+  cDue.reserve(nDue);
+  for ( int iItem = 0; iItem < nDue; ++iItem )
+    cDue.append(m_apcLastItems.at(iItem));
+  return cDue;
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,90 @@
+//*****************************************************************************
+/*!
+  \file serviceindex.h
+  \brief This file contains the definition of the ServiceIndex class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef SERVICEINDEX_H
+#define SERVICEINDEX_H
+
+#include <qdatetime.h>
+#include <qlist.h>
+#include <qvector.h>
+
+class EquipmentLog;
+
+
+//*****************************************************************************
+/*!
+  \class ServiceIndex
+  \brief The ServiceIndex class indexes the equipment history of a log book
+  on date.
+
+  The index holds every history entry of every item, sorted on date, so
+  the events in a period are found by binary search rather than by
+  walking each item's history. It also holds the last event of each item,
+  sorted on date, which answers which items are due for service.
+
+  Like the history itself, the index is kept as parallel arrays. It is
+  a snapshot; see LogBook::serviceIndex(), which builds it again when the
+  log book has changed.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class ServiceIndex
+{
+public:
+  ServiceIndex();
+  ~ServiceIndex();
+
+  void build(const QList<EquipmentLog*>& cEquipment);
+
+  //! Get the number of events.
+  int count() const { return m_acDates.count(); }
+  //! Get the date of the event \a nEvent.
+  QDate date(int nEvent) const { return m_acDates.at(nEvent); }
+  //! Get the item of the event \a nEvent.
+  EquipmentLog* item(int nEvent) const { return m_apcItems.at(nEvent); }
+  //! Get the history entry index in item() of the event \a nEvent.
+  int entry(int nEvent) const { return m_anEntries.at(nEvent); }
+
+  int findEvent(const QDate& cDate) const;
+  QList<EquipmentLog*> dueForService(const QDate& cDate,
+                                     int nIntervalDays) const;
+
+private:
+  //! Disabled copy constructor.
+  ServiceIndex(const ServiceIndex&);
+  //! Disabled assignment operator.
+  ServiceIndex& operator =(const ServiceIndex&);
+
+  //! The date of each event, in ascending order.
+  QVector<QDate>         m_acDates;
+  //! The item of each event.
+  QVector<EquipmentLog*> m_apcItems;
+  //! The history entry of each event.
+  QVector<int>           m_anEntries;
+  //! The date of the last event of each item with a history, ascending.
+  QVector<QDate>         m_acLastDates;
+  //! The item of each last event.
+  QVector<EquipmentLog*> m_apcLastItems;
+};
+
+#endif // SERVICEINDEX_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
@@ -0,0 +1,67 @@
+//*****************************************************************************
+/*!
+  \file stringpool.cpp
+  \brief This file contains the implementation of the StringPool class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#include "stringpool.h"
+
+
+//*****************************************************************************
+/*!
+  Create an empty pool.
+*/
+//*****************************************************************************
+
+StringPool::StringPool()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Destroy the pool. Strings returned by intern() are still valid.
+*/
+//*****************************************************************************
+
+StringPool::~StringPool()
+{
+}
+
+
+//*****************************************************************************
+/*!
+  Get the shared copy of \a cText, adding it to the pool if it isn't
+  there already. Null and empty strings are returned as they are.
+*/
+//*****************************************************************************
+
+QString
+StringPool::intern(const QString& cText)
+{
+  if ( cText.isEmpty() )
+    return cText;
+
+  QSet<QString>::const_iterator i = m_cStrings.constFind(cText);
+  if ( i != m_cStrings.constEnd() )
+    return *i;
+
+  m_cStrings.insert(cText);
+  return cText;
+}
+
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
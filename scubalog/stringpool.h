@@ -0,0 +1,68 @@
+//*****************************************************************************
+/*!
+  \file stringpool.h
+  \brief This file contains the definition of the StringPool class.
+
+  This file is part of ScubaLog, a dive logging application for KDE.
+  ScubaLog is free software licensed under the GPL.
+
+  \par Copyright:
+  André Hübert Johansen
+*/
+//*****************************************************************************
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <qset.h>
+#include <qstring.h>
+
+
+//*****************************************************************************
+/*!
+  \class StringPool
+  \brief The StringPool class holds one shared copy of each string.
+
+  A log book repeats the same few hundred locations, buddies, gas types
+  and dive types over thousands of dive logs. When a log is loaded, each
+  of these strings is passed through intern(), which returns the copy
+  already in the pool if there is one. QString is implicitly shared, so
+  all the logs then use the same string data instead of one copy each.
+
+  The pool only saves memory; the strings are still compared as strings.
+
+  Null and empty strings are not put in the pool.
+
+  \author André Hübert Johansen
+*/
+//*****************************************************************************
+
+class StringPool
+{
+public:
+  StringPool();
+  ~StringPool();
+
+  QString intern(const QString& cText);
+  //! Get the number of strings in the pool.
+  int count() const { return m_cStrings.count(); }
+
+private:
+  //! Disabled copy constructor.
+  StringPool(const StringPool&);
+  //! Disabled assignment operator.
+  StringPool& operator =(const StringPool&);
+
+  //! The strings.
+  QSet<QString> m_cStrings;
+};
+
+#endif // STRINGPOOL_H
+
+// Local Variables:
+// mode: c++
+// tab-width: 8
+// c-basic-offset: 2
+// indent-tabs-mode: nil
+// coding: utf-8
+// End:
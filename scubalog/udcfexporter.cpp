@@ -69,14 +69,16 @@ return false; // not implemented, then false
 
 //*****************************************************************************
 /*!
-  Export the logbook \a cLogBook to the file \a cFileName.
+  Export the logs in \a cSelection from the logbook \a cLogBook to the
+  file \a cFileName. The personal information, locations and equipment
+  are always exported. The dives are written in the order they were dived.
   Returns `true' on success, `false' on failure.
-  \warning NOT INPLEMENTED YET
 */
 //*****************************************************************************
 
 bool
-UDCFExporter::exportLogBook(const LogBook& cLogBook,
+UDCFExporter::exportLogs(const LogBook& cLogBook,
+              const DiveSelection& cSelection,
               const QString& cFileName) const
  {
  QDomDocument doc( "mydocument" );
@@ -94,7 +96,7 @@ UDCFExporter::exportLogBook(const LogBook& cLogBook,
  //add the program tag to the document
  doc.documentElement().appendChild(extraprogram);
  // dive logs
- buildDiveLogs(doc,cLogBook);
+ buildDiveLogs(doc,cLogBook,cSelection);
  QFile cFile(cFileName);
  bool isOpen = cFile.open(QIODevice::WriteOnly);
  if ( false == isOpen ) {
@@ -280,27 +282,26 @@ UDCFExporter::buildEquipmentLogs(QDomDocument& doc,QDomElement& docElem,const Lo
       auxelem.appendChild(textnode);
       piece.appendChild(auxelem);
 
-      const QList<EquipmentHistoryEntry*>& history = pcEquipmentLog->history();
-      QListIterator<EquipmentHistoryEntry*> iH(history);
-      while ( iH.hasNext() ) {
-        const EquipmentHistoryEntry* pcEquipmentHistoryEntry = iH.next();
+      for ( int iEntry = 0; iEntry < pcEquipmentLog->historyCount();
+            ++iEntry ) {
+        const QDate cEntryDate = pcEquipmentLog->historyDate(iEntry);
           auxelem = doc.createElement( "SERVICE" );
           date= doc.createElement( "DATE" );
           dateelem= doc.createElement( "YEAR" );
-          textnode = doc.createTextNode ( QString::number(pcEquipmentHistoryEntry->date().year()) );
+          textnode = doc.createTextNode ( QString::number(cEntryDate.year()) );
           dateelem.appendChild(textnode);
           date.appendChild(dateelem);
           dateelem= doc.createElement( "MONTH" );
-          textnode = doc.createTextNode ( QString::number(pcEquipmentHistoryEntry->date().month()) );
+          textnode = doc.createTextNode ( QString::number(cEntryDate.month()) );
           dateelem.appendChild(textnode);
           date.appendChild(dateelem);
           dateelem= doc.createElement( "DAY" );
-          textnode = doc.createTextNode ( QString::number(pcEquipmentHistoryEntry->date().day()) );
+          textnode = doc.createTextNode ( QString::number(cEntryDate.day()) );
           dateelem.appendChild(textnode);
           date.appendChild(dateelem);
           auxelem.appendChild(date);
           date= doc.createElement( "COMMENT" );
-          textnode = doc.createTextNode ( pcEquipmentHistoryEntry->comment() );
+          textnode = doc.createTextNode ( pcEquipmentLog->historyComment(iEntry) );
           date.appendChild(textnode);
           auxelem.appendChild(date);
           piece.appendChild(auxelem);
@@ -321,7 +322,8 @@ UDCFExporter::buildEquipmentLogs(QDomDocument& doc,QDomElement& docElem,const Lo
 //*****************************************************************************
 
 void
-UDCFExporter::buildDiveLogs(QDomDocument& doc,const LogBook& cLogBook) const
+UDCFExporter::buildDiveLogs(QDomDocument& doc,const LogBook& cLogBook,
+                            const DiveSelection& cSelection) const
 {
  QDomElement docElem = doc.documentElement();
  QDomComment coment = doc.createComment( "Dive Logs" );
@@ -329,11 +331,13 @@ UDCFExporter::buildDiveLogs(QDomDocument& doc,const LogBook& cLogBook) const
  QDomElement repgroup,dive,auxelem,auxelem2,auxelem3;
  QDomText textnode;
  double bottomtime,divetime;
- // Write all the dive entries
+ // Write the selected dive entries in the order they were dived; only
+ // the selected logs are sorted, unless all are selected
  const DiveList& diveList = cLogBook.diveList();
- QListIterator<DiveLog*> iD(diveList);
- while ( iD.hasNext() ) {
-   DiveLog* pcdiveLog = iD.next();
+ const QVector<DiveLog*> byDate =
+   diveList.sortedLogs(DiveList::e_ByDate, cSelection.indices(diveList));
+ for ( int iD = 0; iD < byDate.count(); ++iD ) {
+   const DiveLog* pcdiveLog = byDate.at(iD);
       repgroup= doc.createElement( "REPGROUP" );
       dive = doc.createElement( "DIVE" );
       auxelem = doc.createElement( "PLACE" );
@@ -456,7 +460,8 @@ UDCFExporter::buildDiveLogs(QDomDocument& doc,const LogBook& cLogBook) const
       auxelem2.appendChild(auxelem3);
       auxelem.appendChild(auxelem2);
       dive.appendChild(auxelem);
-      //samples section, define an square profile for the dive
+      //samples section, use the recorded profile if there is one,
+      //else define an square profile for the dive
       // start at 0 directly to bottom depth
       // botton time at bottom depth
       // go up to 3m and keep there divetime-bottomtime
@@ -468,60 +473,76 @@ UDCFExporter::buildDiveLogs(QDomDocument& doc,const LogBook& cLogBook) const
       textnode = doc.createTextNode ( pcdiveLog->gasType() );
       auxelem2.appendChild(textnode);
       auxelem.appendChild(auxelem2);
-      // first point 0,0
-      auxelem2 = doc.createElement( "T" );
-      textnode = doc.createTextNode ( "0" );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      auxelem2 = doc.createElement( "D" );
-      textnode = doc.createTextNode ( "0" );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      //second point 0,bottomdepth
-      auxelem2 = doc.createElement( "T" );
-      textnode = doc.createTextNode ( "0" );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      auxelem2 = doc.createElement( "D" );
-      textnode = doc.createTextNode (QString::number( pcdiveLog->maxDepth()) );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      //third point bottomtime,bottomdepth
-      auxelem2 = doc.createElement( "T" );
-      textnode = doc.createTextNode ( QString::number(bottomtime ) );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      auxelem2 = doc.createElement( "D" );
-      textnode = doc.createTextNode (QString::number( pcdiveLog->maxDepth()) );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      //fourth point bottontime,3 m
-      auxelem2 = doc.createElement( "T" );
-      textnode = doc.createTextNode ( QString::number(bottomtime ) );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      auxelem2 = doc.createElement( "D" );
-      textnode = doc.createTextNode ( "3" );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      //fith point divetime,3m
-      auxelem2 = doc.createElement( "T" );
-      textnode = doc.createTextNode ( QString::number(divetime ) );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      auxelem2 = doc.createElement( "D" );
-      textnode = doc.createTextNode ( "3" );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      //last point ..,surface
-      auxelem2 = doc.createElement( "T" );
-      textnode = doc.createTextNode ( " " );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
-      auxelem2 = doc.createElement( "D" );
-      textnode = doc.createTextNode ( "0" );
-      auxelem2.appendChild(textnode);
-      auxelem.appendChild(auxelem2);
+      const DiveProfile& profile = pcdiveLog->profile();
+      if ( false == profile.isEmpty() ) {
+        // the recorded profile, with the time in minutes
+        for ( int i = 0; i < profile.numSamples(); ++i ) {
+          auxelem2 = doc.createElement( "T" );
+          textnode = doc.createTextNode ( QString::number(profile.sampleTime(i) / 60.0) );
+          auxelem2.appendChild(textnode);
+          auxelem.appendChild(auxelem2);
+          auxelem2 = doc.createElement( "D" );
+          textnode = doc.createTextNode ( QString::number(profile.sampleDepth(i)) );
+          auxelem2.appendChild(textnode);
+          auxelem.appendChild(auxelem2);
+        }
+      }
+      else {
+        // first point 0,0
+        auxelem2 = doc.createElement( "T" );
+        textnode = doc.createTextNode ( "0" );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        auxelem2 = doc.createElement( "D" );
+        textnode = doc.createTextNode ( "0" );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        //second point 0,bottomdepth
+        auxelem2 = doc.createElement( "T" );
+        textnode = doc.createTextNode ( "0" );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        auxelem2 = doc.createElement( "D" );
+        textnode = doc.createTextNode (QString::number( pcdiveLog->maxDepth()) );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        //third point bottomtime,bottomdepth
+        auxelem2 = doc.createElement( "T" );
+        textnode = doc.createTextNode ( QString::number(bottomtime ) );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        auxelem2 = doc.createElement( "D" );
+        textnode = doc.createTextNode (QString::number( pcdiveLog->maxDepth()) );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        //fourth point bottontime,3 m
+        auxelem2 = doc.createElement( "T" );
+        textnode = doc.createTextNode ( QString::number(bottomtime ) );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        auxelem2 = doc.createElement( "D" );
+        textnode = doc.createTextNode ( "3" );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        //fith point divetime,3m
+        auxelem2 = doc.createElement( "T" );
+        textnode = doc.createTextNode ( QString::number(divetime ) );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        auxelem2 = doc.createElement( "D" );
+        textnode = doc.createTextNode ( "3" );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        //last point ..,surface
+        auxelem2 = doc.createElement( "T" );
+        textnode = doc.createTextNode ( " " );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+        auxelem2 = doc.createElement( "D" );
+        textnode = doc.createTextNode ( "0" );
+        auxelem2.appendChild(textnode);
+        auxelem.appendChild(auxelem2);
+      }
       dive.appendChild(auxelem);
       repgroup.appendChild(dive);
       docElem.appendChild(repgroup);
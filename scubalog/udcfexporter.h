@@ -55,9 +55,10 @@ public:
    //! Export the log \a cLog to the file \a cFileName.
   virtual bool exportLog(const DiveLog& cLog,
                          const QString& cFileName) const;
-  //! Export the logbook \a cLogBook to the file \a cFileName.
-  virtual bool exportLogBook(const LogBook& cLogBook,
-                             const QString& cFileName) const;
+  //! Export the logs in \a cSelection from \a cLogBook to the file \a cFileName.
+  virtual bool exportLogs(const LogBook&       cLogBook,
+                          const DiveSelection& cSelection,
+                          const QString&       cFileName) const;
 private:
   //!displays an error message
   void errorMessage(const QString& cMessage) const;
@@ -70,7 +71,8 @@ private:
   //!build the equipment log
   void buildEquipmentLogs(QDomDocument& doc,QDomElement& ,const LogBook& cLogBook) const;
   //!build the profiles
-  void buildDiveLogs(QDomDocument& doc,const LogBook& cLogBook) const;
+  void buildDiveLogs(QDomDocument& doc,const LogBook& cLogBook,
+                     const DiveSelection& cSelection) const;
 
 
 };
@@ -7,12 +7,14 @@
 #include "equipmentlog.h"
 #include "divelist.h"
 #include "divelog.h"
+#include "stringpool.h"
 
 #include <KLocalizedString>
 #include <QMessageBox>
 #include <QApplication>
 #include <QXmlStreamReader>
 #include <QFile>
+#include <QStringList>
 
 namespace
 {
@@ -42,6 +44,7 @@ UDCFImporter::importLogBook(const QString& filename) const
   }
 
 
+  m_duplicates.clear();
   LogBook* logbook = new LogBook();
 
   // Parse the XML
@@ -69,6 +72,28 @@ UDCFImporter::importLogBook(const QString& filename) const
   }
   file.close();
 
+  if ( false == m_duplicates.isEmpty() ) {
+    QStringList numbers;
+    for ( int i = 0; i < m_duplicates.count(); ++i )
+      numbers << QString::number(m_duplicates.at(i));
+    QString message;
+    message = QString(i18n("The log book in"))
+      + "\n`" + filename + "'\n"
+      + QString(i18n("has %1 logs with a log number already in use."))
+      .arg(m_duplicates.count())
+      + "\n" + QString(i18n("Log numbers: %1")).arg(numbers.join(", "));
+    QMessageBox::warning(QApplication::topLevelWidgets().at(0),
+                         i18n("[ScubaLog] Read log book"),
+                         message);
+  }
+
+  // The dives are written in the order they were dived; keep the list
+  // in log number order, as when read from a project file
+  logbook->diveList().sort();
+
+  // Link the dive logs to their locations
+  logbook->diveList().setLocations(logbook->locationList());
+
   return logbook;
 }
 
@@ -286,26 +311,26 @@ UDCFImporter::readEquipmentHistory(EquipmentLog*     equipment,
   Q_ASSERT(xml.isStartElement() &&
            xml.name().toString().toLower() == "service");
 
-  EquipmentHistoryEntry* history = new EquipmentHistoryEntry();
+  QDate date;
+  QString comment;
+  bool valid = true;
   while ( xml.readNextStartElement() ) {
     QString element_name = getXmlNameLower(xml);
     if ( element_name == "date" ) {
-      QDate date = readDate(xml);
-      history->setDate(date);
+      date = readDate(xml);
     }
     else if ( element_name == "comment" ) {
-      history->setComment(xml.readElementText());
+      comment = xml.readElementText();
     }
     else {
       xml.raiseError("Unsupported element.");
-      delete history;
-      history = nullptr;
+      valid = false;
     }
   }
 
-  if ( history ) {
+  if ( valid ) {
     DBG(("---- Found equipment history\n"));
-    equipment->history().append(history);
+    equipment->addHistoryEntry(date, comment);
   }
 }
 
@@ -391,13 +416,17 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
     element_name = getXmlNameLower(xml);
 
     if ( element_name == "dive" ) {
-      DiveLog* divelog = new DiveLog();
+      StringPool& strings = logbook->stringPool();
+      DiveLog* divelog = logbook->diveList().newLog();
+      // Set when the program section gives the times
+      bool has_divetime = false;
+      bool has_bottomtime = false;
       // Read dive log data
       while ( xml.readNextStartElement() ) {
         element_name = getXmlNameLower(xml);
         if ( element_name == "place" ) {
           const QString text = xml.readElementText();
-          divelog->setDiveLocation(text);
+          divelog->setDiveLocation(strings.intern(text));
         }
         else if ( element_name == "date" ) {
           QDate date = readDate(xml);
@@ -425,7 +454,7 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
           DBG(("---- Altitude: %s\n", element_text.toUtf8().data()));
         }
         else if ( element_name == "gases" ) {
-          readGas(divelog, xml);
+          readGas(divelog, strings, xml);
         }
         else if ( element_name == "program" ) {
           while ( xml.readNextStartElement() ) {
@@ -441,11 +470,13 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
                   element_text = xml.readElementText();
                   QTime time(0, element_text.toInt());
                   divelog->setDiveTime(time);
+                  has_divetime = true;
                 }
                 else if ( element_name == "bottomtime" ) {
                   element_text = xml.readElementText();
                   QTime time(0, element_text.toInt());
                   divelog->setBottomTime(time);
+                  has_bottomtime = true;
                 }
                 else if ( element_name == "airtemp" ) {
                   element_text = xml.readElementText();
@@ -461,11 +492,11 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
                 }
                 else if ( element_name == "buddy" ) {
                   element_text = xml.readElementText();
-                  divelog->setBuddyName(element_text);
+                  divelog->setBuddyName(strings.intern(element_text));
                 }
                 else if ( element_name == "type" ) {
                   element_text = xml.readElementText();
-                  divelog->setDiveType(element_text);
+                  divelog->setDiveType(strings.intern(element_text));
                 }
                 else if ( element_name == "description" ) {
                   element_text = xml.readElementText();
@@ -482,16 +513,23 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
           xml.skipCurrentElement();
         }
         else if ( element_name == "samples" ) {
-          // Read the five samples (T=time, D=depth)
+          // ScubaLog writes six samples (T=time in minutes, D=depth)
+          // for a square profile when there is no recorded profile:
           // - 1: T=0 D=0m
           // - 2: T=0 D=max
           // - 3: T=bottom-time D=max
-          // - 4: T=divetime - bottom-time D=3m
-          // - 5: T=divetime D=0m
-          // Store max-depth from D2, bottom-time from T3, dive-time from T5
-          int sample = 1;
-          int time;
-          float depth;
+          // - 4: T=bottom-time D=3m
+          // - 5: T=divetime D=3m
+          // - 6: T=(none) D=0m
+          // Store max-depth from D2, and bottom-time from T3 and
+          // dive-time from T5 unless the program section had them.
+          //
+          // Files with more samples hold a real profile from a dive
+          // computer, with the time in fractional minutes, which is
+          // kept as the dive profile. Only the max-depth is taken
+          // from it, and the dive-time if no other was given.
+          float minutes = 0.0F;
+          DiveProfile profile;
           while ( xml.readNextStartElement() ) {
             element_name = getXmlNameLower(xml);
             if ( element_name == "switch" ) {
@@ -499,27 +537,29 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
             }
             else if ( element_name == "t" ) {
               element_text = xml.readElementText();
-              time = element_text.toInt();
+              minutes = element_text.toFloat();
             }
             else if ( element_name == "d" ) {
               element_text = xml.readElementText();
-              depth = element_text.toFloat();
-              if ( sample == 2 ) {
-                divelog->setMaxDepth(depth);
-              }
-              else if ( sample == 3 ) {
-                int h = time / 60;
-                int m = time - (h * 60);
-                divelog->setBottomTime(QTime(h, m));
-              }
-              else if ( sample == 5 ) {
-                int h = time / 60;
-                int m = time - (h * 60);
-                divelog->setDiveTime(QTime(h, m));
-              }
-              ++sample;
+              profile.addSample(qRound(minutes * 60.0F),
+                                element_text.toFloat());
             }
           }
+          const QTime start(0, 0);
+          if ( profile.numSamples() > 6 ) {
+            divelog->setProfile(profile);
+            divelog->setMaxDepth(profile.maxDepth());
+            if ( false == has_divetime )
+              divelog->setDiveTime(start.addSecs(profile.duration()));
+          }
+          else {
+            if ( profile.numSamples() >= 2 )
+              divelog->setMaxDepth(profile.sampleDepth(1));
+            if ( profile.numSamples() >= 3 && false == has_bottomtime )
+              divelog->setBottomTime(start.addSecs(profile.sampleTime(2)));
+            if ( profile.numSamples() >= 5 && false == has_divetime )
+              divelog->setDiveTime(start.addSecs(profile.sampleTime(4)));
+          }
         }
         else {
           xml.raiseError("Unsupported element.");
@@ -529,7 +569,11 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
       DBG(("--- Found dive log #%d at '%s'\n",
            divelog->logNumber(),
            divelog->diveLocation().toUtf8().data()));
-      logbook->diveList().append(divelog);
+      if ( false == logbook->diveList().append(divelog) ) {
+        DBG(("--- Log number %d is already in use\n",
+             divelog->logNumber()));
+        m_duplicates.append(divelog->logNumber());
+      }
     }
     else {
       xml.raiseError("Unsupported element.");
@@ -541,7 +585,9 @@ void UDCFImporter::readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const
 }
 
 
-void UDCFImporter::readGas(DiveLog* divelog, QXmlStreamReader& xml) const
+void UDCFImporter::readGas(DiveLog*          divelog,
+                           StringPool&       strings,
+                           QXmlStreamReader& xml) const
 {
   Q_ASSERT(xml.isStartElement() &&
            xml.name().toString().toLower() == "gases");
@@ -556,7 +602,7 @@ void UDCFImporter::readGas(DiveLog* divelog, QXmlStreamReader& xml) const
         QString mix_element_name;
         mix_element_name = getXmlNameLower(xml);
         if ( mix_element_name == "mixname" ) {
-          divelog->setGasType(xml.readElementText());
+          divelog->setGasType(strings.intern(xml.readElementText()));
         }
         else if ( mix_element_name == "o2" ||
                   mix_element_name == "n2" ||
@@ -12,10 +12,12 @@
 #include "importer.h"
 #include <QDate>
 #include <QTime>
+#include <QVector>
 
 
 class EquipmentLog;
 class DiveLog;
+class StringPool;
 class QXmlStreamReader;
 
 
@@ -32,7 +34,9 @@ public:
   //! depending on the importer.
   //! Returns 0 on failure.
   virtual LogBook* importLogBook(const QString& cDirName) const;
-
+  //! Get the log numbers that were already in use when the logs of the
+  //! last log book imported were added, one entry per extra log.
+  const QVector<int>& duplicateNumbers() const { return m_duplicates; }
 
 private:
   void readUDCF(LogBook* logbook, QXmlStreamReader& xml) const;
@@ -41,10 +45,14 @@ private:
   void readEquipment(LogBook* logbook, QXmlStreamReader& xml) const;
   void readEquipmentHistory(EquipmentLog* equipment, QXmlStreamReader& xml) const;
   void readDiveLogs(LogBook* logbook, QXmlStreamReader& xml) const;
-  void readGas(DiveLog* divelog, QXmlStreamReader& xml) const;
+  void readGas(DiveLog* divelog, StringPool& strings,
+               QXmlStreamReader& xml) const;
 
   QDate readDate(QXmlStreamReader& xml) const;
   QTime readTime(QXmlStreamReader& xml) const;
+
+  //! The duplicate log numbers found by the last import.
+  mutable QVector<int> m_duplicates;
 };
 
 #endif // UDCFIMPORTER_H